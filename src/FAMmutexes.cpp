@@ -192,7 +192,7 @@ std::tuple<std::vector<int>,std::vector<int>,std::map<int,int>> compute_local_ty
 		for (int elem : domain.sorts[s1].members){
 			bool in_sub_sort = false;
 			for (int s2 : directsubset[s1]){
-				if (domain.sorts[s2].members.count(elem)){
+				if (domain.sorts[s2].contains(elem)){
 					in_sub_sort = true;
 					break;
 				}
@@ -305,6 +305,7 @@ std::tuple<pddl_lifted_mgroups_t,pddl_t*,std::vector<int>> cpddl_compute_FAM_mut
 			Sort _cpddl_object;
 			_cpddl_object.name = "_cpddl_object";
 			for (size_t i = 0; i < domain.constants.size(); i++) _cpddl_object.members.insert(i);
+			_cpddl_object.buildMemberBits(domain.constants.size());
 			const_cast<Domain &>(domain).sorts.push_back(_cpddl_object);
 			break;
 		} else if (domain.sorts[s].members.size() == domain.constants.size()) break; // domain has object type;
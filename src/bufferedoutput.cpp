@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <cerrno>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "bufferedoutput.h"
+
+OutputBuffer::OutputBuffer (int fd) : fd (fd)
+{
+#ifdef __linux__
+	struct stat status;
+	splice = fstat (fd, &status) == 0 && S_ISFIFO (status.st_mode);
+#endif
+	allocate ();
+}
+
+OutputBuffer::OutputBuffer (void) : fd (-1), memory (1 << 16)
+{
+	setp (memory.data (), memory.data () + memory.size ());
+}
+
+OutputBuffer::~OutputBuffer ()
+{
+	if (fd < 0)
+		return;
+	writeOut ();
+	release ();
+	if (fd != STDOUT_FILENO && fd != STDERR_FILENO)
+		close (fd);
+}
+
+void OutputBuffer::allocate (void)
+{
+	// page aligned, so that whole pages can be spliced into a pipe
+	void * memory = mmap (nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+		throw std::bad_alloc ();
+	buffer = static_cast<char *> (memory);
+	setp (buffer, buffer + capacity);
+}
+
+void OutputBuffer::release (void)
+{
+	munmap (buffer, capacity);
+	buffer = nullptr;
+}
+
+bool OutputBuffer::writeOut (void)
+{
+	const char * data = pbase ();
+	size_t size = pptr () - pbase ();
+	writtenOut += size;
+	if (size == 0 || failed)
+	{
+		setp (buffer, buffer + capacity);
+		return !failed;
+	}
+
+#ifdef __linux__
+	while (splice && size > 0)
+	{
+		iovec vector = {const_cast<char *> (data), size};
+		ssize_t spliced = vmsplice (fd, &vector, 1, 0);
+		if (spliced < 0 && errno == EINTR)
+			continue;
+		if (spliced < 0)
+		{
+			// e.g. not supported for this pipe, write the rest instead
+			splice = false;
+			break;
+		}
+		data += spliced;
+		size -= spliced;
+	}
+
+	if (data != pbase ())
+	{
+		// the pipe still refers to the pages of the old buffer, which must not be changed anymore
+		char * old = buffer;
+		allocate ();
+		if (size == 0)
+		{
+			munmap (old, capacity);
+			return true;
+		}
+		// the unspliced rest is written from the old buffer before it is released
+		while (size > 0)
+		{
+			ssize_t written = write (fd, data, size);
+			if (written < 0 && errno == EINTR)
+				continue;
+			if (written < 0)
+			{
+				failed = true;
+				break;
+			}
+			data += written;
+			size -= written;
+		}
+		munmap (old, capacity);
+		return !failed;
+	}
+#endif
+
+	while (size > 0)
+	{
+		ssize_t written = write (fd, data, size);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written < 0)
+		{
+			failed = true;
+			break;
+		}
+		data += written;
+		size -= written;
+	}
+	setp (buffer, buffer + capacity);
+	return !failed;
+}
+
+bool OutputBuffer::makeRoom (size_t size)
+{
+	if (fd >= 0)
+		return writeOut ();
+
+	size_t used = pptr () - pbase ();
+	memory.resize (std::max (2 * memory.size (), used + size));
+	setp (memory.data (), memory.data () + memory.size ());
+	// pbump only takes an int
+	while (used > 0)
+	{
+		size_t step = std::min (used, size_t (1) << 30);
+		pbump (int (step));
+		used -= step;
+	}
+	return true;
+}
+
+OutputBuffer::int_type OutputBuffer::overflow (int_type c)
+{
+	if (!makeRoom (1))
+		return traits_type::eof ();
+	if (!traits_type::eq_int_type (c, traits_type::eof ()))
+		sputc (traits_type::to_char_type (c));
+	return traits_type::not_eof (c);
+}
+
+std::streamsize OutputBuffer::xsputn (const char * data, std::streamsize size)
+{
+	std::streamsize remaining = size;
+	while (remaining > 0)
+	{
+		std::streamsize free = epptr () - pptr ();
+		if (free == 0)
+		{
+			if (!makeRoom (remaining))
+				return size - remaining;
+			continue;
+		}
+		std::streamsize chunk = std::min (free, remaining);
+		traits_type::copy (pptr (), data, chunk);
+		pbump (int (chunk));
+		data += chunk;
+		remaining -= chunk;
+	}
+	return size;
+}
+
+int OutputBuffer::sync (void)
+{
+	if (fd < 0)
+		return 0;
+	return writeOut () ? 0 : -1;
+}
+
+BufferedOutput * BufferedOutput::open (const std::string & filename)
+{
+	int fd = filename == "-" ? STDOUT_FILENO : ::open (filename.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0)
+		return nullptr;
+	return new BufferedOutput (fd);
+}
+
+NameTable::NameTable (const Domain & domain, size_t size) : domain (domain), begins (size, size_t (-1)), lengths (size)
+{
+}
+
+std::string_view NameTable::name (int index, const std::string & base, const std::vector<int> & arguments, size_t numberOfArguments)
+{
+	if (begins[index] == size_t (-1))
+	{
+		begins[index] = characters.size ();
+		append (characters, domain, base, arguments, numberOfArguments);
+		lengths[index] = characters.size () - begins[index];
+	}
+	return std::string_view (characters.data () + begins[index], lengths[index]);
+}
+
+void NameTable::append (std::string & text, const Domain & domain, const std::string & base, const std::vector<int> & arguments, size_t numberOfArguments)
+{
+	text += base;
+	text += '[';
+	for (size_t i = 0; i < numberOfArguments; i++)
+	{
+		if (i)
+			text += ',';
+		text += domain.constants[arguments[i]];
+	}
+	text += ']';
+}
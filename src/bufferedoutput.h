@@ -0,0 +1,275 @@
+#ifndef BUFFEREDOUTPUT_H_INCLUDED
+#define BUFFEREDOUTPUT_H_INCLUDED
+
+/**
+ * @defgroup bufferedoutput Buffered Output
+ * @brief An output stream for the large files written by the grounder, with a big user-space buffer and fast integer formatting.
+ *
+ * @{
+ */
+
+#include <charconv>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "model.h"
+
+/**
+ * @brief A stream buffer that writes to a file descriptor in large blocks.
+ *
+ * The buffer is only written when it is full, on sync() and on destruction, each time with a single write(2). If the file
+ * descriptor is a pipe, the pages of the buffer are handed to the pipe with vmsplice(2) instead of being copied, and a fresh
+ * buffer is used afterwards, since the pipe still refers to the old one.
+ *
+ * Without a file descriptor, the buffer grows instead and keeps everything written to it in memory, see contents().
+ */
+class OutputBuffer : public std::streambuf
+{
+public:
+	/// The size of the buffer in bytes
+	static const size_t capacity = 1 << 24;
+
+	/**
+	 * @brief Writes to the given file descriptor, which is closed on destruction unless it is standard output or standard error.
+	 */
+	explicit OutputBuffer (int fd);
+
+	/**
+	 * @brief Keeps the output in memory.
+	 */
+	OutputBuffer (void);
+
+	~OutputBuffer ();
+
+	OutputBuffer (const OutputBuffer &) = delete;
+	OutputBuffer & operator= (const OutputBuffer &) = delete;
+
+	/**
+	 * @brief Returns a pointer to at least size free bytes of the buffer, which are used by calling commit() afterwards.
+	 */
+	char * reserve (size_t size)
+	{
+		if (size_t (epptr () - pptr ()) < size)
+			makeRoom (size);
+		return pptr ();
+	}
+
+	/**
+	 * @brief Marks the bytes up to end, which was obtained from reserve(), as written.
+	 */
+	void commit (char * end)
+	{
+		pbump (int (end - pptr ()));
+	}
+
+	/**
+	 * @brief Returns the number of bytes written to the buffer so far, including the ones that have already been written out.
+	 */
+	uint64_t size (void) const
+	{
+		return writtenOut + (pptr () - pbase ());
+	}
+
+	/**
+	 * @brief Returns everything written to a buffer that keeps its output in memory.
+	 */
+	std::string_view contents (void) const
+	{
+		return std::string_view (pbase (), pptr () - pbase ());
+	}
+
+protected:
+	int_type overflow (int_type c) override;
+	std::streamsize xsputn (const char * data, std::streamsize size) override;
+	int sync () override;
+
+private:
+	/// The file descriptor written to, or -1 if the output is kept in memory
+	int fd;
+	/// Whether fd is a pipe and the buffer is spliced into it
+	bool splice = false;
+	/// Whether writing failed, after which the output is discarded
+	bool failed = false;
+	char * buffer = nullptr;
+	/// The number of bytes written out before the current contents of the buffer
+	uint64_t writtenOut = 0;
+	/// The buffer if the output is kept in memory
+	std::vector<char> memory;
+
+	/**
+	 * @brief Writes the contents of the buffer and empties it. Returns false if writing failed, now or before.
+	 */
+	bool writeOut (void);
+
+	/**
+	 * @brief Makes room for at least size more bytes, by writing the buffer out or, in memory, by enlarging it.
+	 */
+	bool makeRoom (size_t size);
+
+	void allocate (void);
+	void release (void);
+};
+
+/**
+ * @brief An output stream writing to an OutputBuffer.
+ *
+ * Since it is a std::ostream, every writer can target it. Writers that know the stream is a BufferedOutput use the overloads below,
+ * which format integers with std::to_chars and copy strings directly into the buffer. std::endl only ends the line here and does not
+ * write anything; call flush() before leaving the process with _exit().
+ *
+ * Messages the grounder prints to standard output itself are not ordered with respect to a BufferedOutput on standard output.
+ */
+class BufferedOutput : public std::ostream
+{
+public:
+	explicit BufferedOutput (int fd) : std::ostream (nullptr), buffer (fd)
+	{
+		rdbuf (&buffer);
+	}
+
+	/**
+	 * @brief Keeps everything written in memory, e.g. to format a part of a file in another thread.
+	 */
+	BufferedOutput (void) : std::ostream (nullptr)
+	{
+		rdbuf (&buffer);
+	}
+
+	/**
+	 * @brief Opens the given file for writing, or standard output for "-". Returns nullptr and leaves errno set if it cannot be opened.
+	 */
+	static BufferedOutput * open (const std::string & filename);
+
+	using std::ostream::operator<<;
+
+	BufferedOutput & operator<< (int value) { return integer (value); }
+	BufferedOutput & operator<< (unsigned int value) { return integer (value); }
+	BufferedOutput & operator<< (long value) { return integer (value); }
+	BufferedOutput & operator<< (unsigned long value) { return integer (value); }
+	BufferedOutput & operator<< (long long value) { return integer (value); }
+	BufferedOutput & operator<< (unsigned long long value) { return integer (value); }
+
+	BufferedOutput & operator<< (char c)
+	{
+		buffer.sputc (c);
+		return *this;
+	}
+
+	BufferedOutput & operator<< (std::string_view text)
+	{
+		buffer.sputn (text.data (), text.size ());
+		return *this;
+	}
+
+	BufferedOutput & operator<< (const std::string & text) { return *this << std::string_view (text); }
+	BufferedOutput & operator<< (const char * text) { return *this << std::string_view (text); }
+
+	/**
+	 * @brief Applies a manipulator, except that std::endl does not flush.
+	 */
+	BufferedOutput & operator<< (std::ostream & (* manipulator) (std::ostream &))
+	{
+		if (manipulator == static_cast<std::ostream & (*) (std::ostream &)> (std::endl))
+			return *this << '\n';
+		manipulator (*this);
+		return *this;
+	}
+
+	/// Returns the number of bytes written so far
+	uint64_t size (void) const
+	{
+		return buffer.size ();
+	}
+
+	/// Returns everything written, if the output is kept in memory
+	std::string_view contents (void) const
+	{
+		return buffer.contents ();
+	}
+
+private:
+	OutputBuffer buffer;
+
+	template <typename T>
+	BufferedOutput & integer (T value)
+	{
+		char * begin = buffer.reserve (24);
+		buffer.commit (std::to_chars (begin, begin + 24, value).ptr);
+		return *this;
+	}
+};
+
+/**
+ * @brief The names of grounded facts or tasks, e.g. "at[truck1,city2]", built on first use and stored one after another in a single
+ * string, so that writing a name again neither allocates nor concatenates anything.
+ *
+ * The returned views are valid until the next name is built.
+ */
+class NameTable
+{
+public:
+	/**
+	 * @brief Creates an empty table for the given number of facts or tasks, indexed by their groundedNo.
+	 */
+	NameTable (const Domain & domain, size_t size);
+
+	/**
+	 * @brief Returns the name of a grounded fact with all its arguments.
+	 */
+	std::string_view fact (const Fact & fact)
+	{
+		return name (fact.groundedNo, domain.predicates[fact.predicateNo].name, fact.arguments, fact.arguments.size ());
+	}
+
+	/**
+	 * @brief Returns the name of a grounded task with its original arguments.
+	 */
+	std::string_view task (const GroundedTask & task)
+	{
+		return name (task.groundedNo, domain.tasks[task.taskNo].name, task.arguments, domain.tasks[task.taskNo].number_of_original_variables);
+	}
+
+	/**
+	 * @brief Replaces text by the name of a grounded fact, without storing it in a table. Can be called from several threads.
+	 */
+	static void buildFact (std::string & text, const Domain & domain, const Fact & fact)
+	{
+		build (text, domain, domain.predicates[fact.predicateNo].name, fact.arguments, fact.arguments.size ());
+	}
+
+	/**
+	 * @brief Replaces text by the name of a grounded task, without storing it in a table. Can be called from several threads.
+	 */
+	static void buildTask (std::string & text, const Domain & domain, const GroundedTask & task)
+	{
+		build (text, domain, domain.tasks[task.taskNo].name, task.arguments, domain.tasks[task.taskNo].number_of_original_variables);
+	}
+
+private:
+	const Domain & domain;
+	std::string characters;
+	/// Position of every name in characters, or -1 if it has not been built yet
+	std::vector<size_t> begins;
+	std::vector<size_t> lengths;
+
+	std::string_view name (int index, const std::string & base, const std::vector<int> & arguments, size_t numberOfArguments);
+
+	/// Appends base[argument,...] to text
+	static void append (std::string & text, const Domain & domain, const std::string & base, const std::vector<int> & arguments, size_t numberOfArguments);
+
+	static void build (std::string & text, const Domain & domain, const std::string & base, const std::vector<int> & arguments, size_t numberOfArguments)
+	{
+		text.clear ();
+		append (text, domain, base, arguments, numberOfArguments);
+	}
+};
+
+/**
+ * @}
+ */
+
+#endif
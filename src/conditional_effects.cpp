@@ -75,6 +75,8 @@ void expand_conditional_effects_into_artificial_tasks(Domain & domain, Problem &
 			// get id of the guard and add it to the predicates
 			int guard_predicate_number = domain.predicates.size();
 			domain.predicates.push_back(guard);
+			// the guard is added by the main task
+			domain.staticPredicates.push_back(false);
 			
 			// build variable list of ceTask
 			for (size_t i = 0; i < ceVarsToMain.size(); i++)
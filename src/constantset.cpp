@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cassert>
+
+#include "constantset.h"
+
+ConstantSet ConstantSet::fromBits (const std::vector<uint64_t> & bits)
+{
+	ConstantSet set;
+	set.words = bits;
+	set.trim ();
+	return set;
+}
+
+void ConstantSet::trim (void)
+{
+	auto last = std::find_if (words.rbegin (), words.rend (), [] (uint64_t word) { return word != 0; });
+	words.erase (last.base (), words.end ());
+
+	auto first = std::find_if (words.begin (), words.end (), [] (uint64_t word) { return word != 0; });
+	firstWord += first - words.begin ();
+	words.erase (words.begin (), first);
+
+	if (words.empty ())
+		firstWord = 0;
+}
+
+size_t ConstantSet::size (void) const
+{
+	size_t count = 0;
+	for (uint64_t word : words)
+		count += std::popcount (word);
+	return count;
+}
+
+void ConstantSet::insert (int constant)
+{
+	assert (constant >= 0);
+	size_t word = size_t (constant) >> 6;
+	if (words.empty ())
+		firstWord = word;
+	else if (word < firstWord)
+	{
+		words.insert (words.begin (), firstWord - word, 0);
+		firstWord = word;
+	}
+	if (word - firstWord >= words.size ())
+		words.resize (word - firstWord + 1, 0);
+
+	words[word - firstWord] |= uint64_t (1) << (constant & 63);
+}
+
+bool ConstantSet::erase (int constant)
+{
+	if (!contains (constant))
+		return false;
+
+	words[(size_t (constant) >> 6) - firstWord] &= ~(uint64_t (1) << (constant & 63));
+	trim ();
+	return true;
+}
+
+void ConstantSet::intersectWith (const ConstantSet & other)
+{
+	size_t begin = std::max (firstWord, other.firstWord);
+	size_t end = std::min (firstWord + words.size (), other.firstWord + other.words.size ());
+	if (begin >= end)
+	{
+		words.clear ();
+		firstWord = 0;
+		return;
+	}
+
+	uint64_t * ownWords = words.data () + (begin - firstWord);
+	const uint64_t * otherWords = other.words.data () + (begin - other.firstWord);
+	size_t count = end - begin;
+	for (size_t word = 0; word < count; ++word)
+		ownWords[word] &= otherWords[word];
+
+	// drop the words outside of the overlap
+	words.erase (words.begin () + (begin - firstWord) + count, words.end ());
+	words.erase (words.begin (), words.begin () + (begin - firstWord));
+	firstWord = begin;
+	trim ();
+}
+
+bool ConstantSet::isSubsetOf (const ConstantSet & other) const
+{
+	if (words.empty ())
+		return true;
+	// the first and last word are non-zero, so they have to be within the words of other
+	if (firstWord < other.firstWord || firstWord + words.size () > other.firstWord + other.words.size ())
+		return false;
+
+	const uint64_t * otherWords = other.words.data () + (firstWord - other.firstWord);
+	uint64_t missing = 0;
+	for (size_t word = 0; word < words.size (); ++word)
+		missing |= words[word] & ~otherWords[word];
+	return missing == 0;
+}
+
+size_t ConstantSet::hash (void) const
+{
+	size_t h = firstWord;
+	for (uint64_t word : words)
+		h = h * 601 + word;
+	return h;
+}
+
+uint64_t ConstantSet::signature (void) const
+{
+	// rotating by the word number keeps constants 64 apart from always sharing a bit
+	uint64_t result = 0;
+	for (size_t word = 0; word < words.size (); ++word)
+		result |= std::rotl (words[word], int (((firstWord + word) * 7) & 63));
+	return result;
+}
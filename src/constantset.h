@@ -0,0 +1,171 @@
+#ifndef CONSTANTSET_H_INCLUDED
+#define CONSTANTSET_H_INCLUDED
+
+/**
+ * @defgroup constantset Constant Set
+ * @brief Sets of constants stored as bitsets, used by the hierarchy typing.
+ *
+ * @{
+ */
+
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+/**
+ * @brief A set of constants stored as a bitset over the constant numbers.
+ *
+ * Only the words from the first to the last non-zero word are stored. Small sets, and sorts whose members are numbered closely
+ * (e.g. after --renumber-constants), are therefore compact. Intersection, inclusion and equality work on whole words without
+ * branches, so the compiler vectorises them.
+ */
+class ConstantSet
+{
+public:
+	class const_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = int;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const int *;
+		using reference = int;
+
+		const_iterator (const ConstantSet * set, size_t word) : set (set), word (word), remaining (word < set->words.size () ? set->words[word] : 0)
+		{
+			skipEmptyWords ();
+		}
+
+		int operator* (void) const
+		{
+			return int ((set->firstWord + word) * 64 + std::countr_zero (remaining));
+		}
+
+		const_iterator & operator++ (void)
+		{
+			remaining &= remaining - 1;
+			skipEmptyWords ();
+			return *this;
+		}
+
+		bool operator== (const const_iterator & other) const
+		{
+			return word == other.word && remaining == other.remaining;
+		}
+
+	private:
+		const ConstantSet * set;
+		size_t word;
+		uint64_t remaining;
+
+		void skipEmptyWords (void)
+		{
+			while (remaining == 0 && word < set->words.size ())
+			{
+				word++;
+				remaining = word < set->words.size () ? set->words[word] : 0;
+			}
+		}
+	};
+
+	ConstantSet (void) = default;
+
+	/**
+	 * @brief Returns the set of constants whose bits are set in a bitset over all constants, e.g. Sort::memberBits.
+	 */
+	static ConstantSet fromBits (const std::vector<uint64_t> & bits);
+
+	const_iterator begin (void) const
+	{
+		return const_iterator (this, 0);
+	}
+
+	const_iterator end (void) const
+	{
+		return const_iterator (this, words.size ());
+	}
+
+	bool empty (void) const
+	{
+		return words.empty ();
+	}
+
+	/**
+	 * @brief Returns the number of constants in the set.
+	 */
+	size_t size (void) const;
+
+	/**
+	 * @brief Returns the smallest constant of a non-empty set.
+	 */
+	int front (void) const
+	{
+		return int (firstWord * 64 + std::countr_zero (words.front ()));
+	}
+
+	bool contains (int constant) const
+	{
+		size_t word = size_t (constant) >> 6;
+		return constant >= 0 && word >= firstWord && word - firstWord < words.size () && ((words[word - firstWord] >> (constant & 63)) & 1);
+	}
+
+	void insert (int constant);
+
+	/**
+	 * @brief Removes the given constant and returns whether it was in the set.
+	 */
+	bool erase (int constant);
+
+	/**
+	 * @brief Removes all constants that are not in other.
+	 */
+	void intersectWith (const ConstantSet & other);
+
+	bool isSubsetOf (const ConstantSet & other) const;
+
+	bool operator== (const ConstantSet & other) const
+	{
+		return firstWord == other.firstWord && words == other.words;
+	}
+
+	/**
+	 * @brief An arbitrary total order of the sets, e.g. for sorting them. It is unrelated to inclusion.
+	 */
+	bool operator< (const ConstantSet & other) const
+	{
+		return firstWord != other.firstWord ? firstWord < other.firstWord : words < other.words;
+	}
+
+	size_t hash (void) const;
+
+	/**
+	 * @brief Returns a 64 bit signature with one bit per constant. The signature of a subset is a subset of the signature.
+	 */
+	uint64_t signature (void) const;
+
+	/**
+	 * @brief Returns the number of bytes used by the set.
+	 */
+	size_t memoryUsage (void) const
+	{
+		return sizeof (ConstantSet) + words.capacity () * sizeof (uint64_t);
+	}
+
+private:
+	/// The number of the first stored word, i.e. words[0] contains the constants from 64 * firstWord on. 0 for the empty set.
+	size_t firstWord = 0;
+	/// The first and the last word are non-zero, so equal sets have equal words.
+	std::vector<uint64_t> words;
+
+	/**
+	 * @brief Removes zero words at both ends.
+	 */
+	void trim (void);
+};
+
+/**
+ * @}
+ */
+
+#endif
@@ -0,0 +1,526 @@
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "daemon.h"
+#include "liftedcache.h"
+#include "parser.h"
+#include "tokenizer.h"
+
+namespace
+{
+	/**
+	 * @brief The domain schemas kept by the daemon (see readDomainSchemas()), identified by the names of the sorts they refer to and the
+	 * part of the input they were parsed from, which does not contain the constants.
+	 */
+	struct CachedDomain
+	{
+		std::vector<std::string> sortNames;
+		/// The hash and length of the part of the input between the sorts and the initial state
+		uint64_t schemaHash;
+		size_t schemaLength;
+		/// The predicates, functions, tasks and methods, without any constants and sorts
+		Domain domain;
+	};
+
+	/**
+	 * @brief The answer to a request. Its text is empty as long as the child process serving the request is running.
+	 */
+	struct Answer
+	{
+		pid_t child = -1;
+		std::chrono::steady_clock::time_point start;
+		std::string text;
+	};
+
+	/**
+	 * @brief A source of requests together with the destination of their answers: standard input and output, or a connection to the socket.
+	 */
+	struct Client
+	{
+		int requestFd;
+		int replyFd;
+		/// What was read, but not served yet
+		std::string pending;
+		/// Whether the requests have ended
+		bool ended = false;
+		/// The answers in the order of the requests. An answer is written as soon as all answers before it are.
+		std::deque<Answer> answers;
+	};
+
+	enum RequestResult
+	{
+		/// The request was answered or is being served by a child process, the daemon reads the next one
+		REQUEST_SERVED,
+		/// The daemon was asked to quit
+		REQUEST_QUIT,
+		/// This is the child process that serves the request
+		REQUEST_CHILD,
+	};
+
+	/// The write end of the pipe through which a terminated child process wakes up the daemon
+	int childSignalFd = -1;
+
+	void onChildSignal (int)
+	{
+		int savedErrno = errno;
+		char wakeUp = 0;
+		// if the pipe is full, the daemon wakes up anyway
+		if (write (childSignalFd, &wakeUp, 1) < 0) {}
+		errno = savedErrno;
+	}
+
+	/**
+	 * @brief The state of the daemon shared by all requests.
+	 */
+	struct Daemon
+	{
+		bool quietMode;
+		/// The number of domains to keep, at least one
+		size_t domainLimit;
+		/// The number of requests served at the same time, at least one
+		size_t jobLimit;
+		size_t runningJobs = 0;
+		int exitCode = 0;
+		/// The kept domains, the most recently used one first
+		std::list<CachedDomain> domains;
+		std::list<Client> clients;
+		/// The file descriptors the child process has to close besides those of the clients
+		std::vector<int> descriptors;
+
+		/**
+		 * @brief Returns the domain schemas of the input, whose constants and sorts have already been read into objects, and moves the
+		 * input after them. They are parsed if they are not kept yet. Returns nullptr if they cannot be read.
+		 */
+		CachedDomain * findDomain (InputTokenizer & input, const Domain & objects, const std::string & filename, std::string & reason)
+		{
+			std::string_view contents = input.contents ();
+			size_t start = input.offset ();
+			for (auto it = domains.begin (); it != domains.end (); ++it)
+			{
+				// the last token of the schemas must not continue in this input
+				size_t end = start + it->schemaLength;
+				if (end > contents.size () || (end < contents.size () && !std::isspace ((unsigned char) contents[end])))
+					continue;
+				if (!std::equal (it->sortNames.begin (), it->sortNames.end (), objects.sorts.begin (), objects.sorts.end (),
+							[] (const std::string & name, const Sort & sort) { return name == sort.name; }))
+					continue;
+				if (hashLiftedInput (contents.substr (start, it->schemaLength)) != it->schemaHash)
+					continue;
+
+				domains.splice (domains.begin (), domains, it);
+				input.seek (end);
+				return &domains.front ();
+			}
+
+			CachedDomain cached;
+			for (const Sort & sort : objects.sorts)
+				cached.sortNames.push_back (sort.name);
+			if (!readDomainSchemas (input, cached.domain))
+			{
+				reason = "failed to read input file " + filename;
+				return nullptr;
+			}
+			cached.schemaLength = input.offset () - start;
+			cached.schemaHash = hashLiftedInput (contents.substr (start, cached.schemaLength));
+
+			domains.push_front (std::move (cached));
+			while (domains.size () > domainLimit)
+				domains.pop_back ();
+			if (!quietMode)
+				std::cerr << "Daemon: parsed the domain of " << filename << ", keeping " << domains.size () << " lifted domains." << std::endl;
+			return &domains.front ();
+		}
+
+		/**
+		 * @brief Serves a single request line of the client. Its answer is added to the answers of the client.
+		 */
+		RequestResult serve (const std::string & request, Client & client, gengetopt_args_info & requestArgs, Domain & domain, Problem & problem)
+		{
+			std::istringstream words (request);
+			std::vector<std::string> arguments;
+			for (std::string word; words >> word;)
+				arguments.push_back (word);
+			if (arguments.empty ())
+				return REQUEST_SERVED;
+			if (arguments.size () == 1 && arguments[0] == "quit")
+				return REQUEST_QUIT;
+
+			client.answers.emplace_back ();
+			Answer & answer = client.answers.back ();
+
+			std::string reason = checkArguments (arguments);
+			gengetopt_args_info args;
+			bool parsed = false;
+			if (reason.empty ())
+			{
+				parsed = cmdline_parser_string (request.c_str (), &args, "pandaPIgrounder") == 0;
+				if (!parsed)
+					reason = "invalid arguments";
+				else if (args.daemon_given || args.daemon_socket_given || args.daemon_models_given || args.daemon_jobs_given)
+					reason = "daemon options are not allowed in requests";
+				else if (args.inputs_num < 2 || std::string (args.inputs[0]) == "-" || std::string (args.inputs[1]) == "-"
+						|| (args.inputs_num > 2 && std::string (args.inputs[2]) == "-"))
+					reason = "input and output must be files";
+			}
+
+			// only the problem specific parts of the input are read here, the rest of the problem by the child process
+			InputTokenizer input;
+			Domain objects;
+			CachedDomain * cached = nullptr;
+			if (reason.empty ())
+			{
+				try
+				{
+					if (!input.open (args.inputs[0]))
+						reason = std::string ("unable to open input file ") + args.inputs[0] + ": " + strerror (errno);
+					else if (!readProblemObjects (input, objects))
+						reason = std::string ("failed to read input file ") + args.inputs[0];
+					else
+						cached = findDomain (input, objects, args.inputs[0], reason);
+				}
+				// an invalid domain must not stop the daemon
+				catch (BadInputException & e)
+				{
+					reason = std::string ("invalid input file ") + args.inputs[0] + ": " + e.what ();
+				}
+			}
+
+			if (cached == nullptr)
+			{
+				if (parsed)
+					cmdline_parser_free (&args);
+				answer.text = "error " + reason;
+				return REQUEST_SERVED;
+			}
+
+			// nothing buffered may be written twice
+			std::cout.flush ();
+			std::cerr.flush ();
+			fflush (nullptr);
+
+			answer.start = std::chrono::steady_clock::now ();
+			pid_t child = fork ();
+			if (child < 0)
+			{
+				cmdline_parser_free (&args);
+				answer.text = std::string ("error unable to fork: ") + strerror (errno);
+				return REQUEST_SERVED;
+			}
+
+			if (child == 0)
+			{
+				for (int descriptor : descriptors)
+					close (descriptor);
+				for (const Client & other : clients)
+					if (other.requestFd != STDIN_FILENO)
+						close (other.requestFd);
+				signal (SIGPIPE, SIG_DFL);
+				signal (SIGCHLD, SIG_DFL);
+				// the requests are not for the child, which must not move the shared offset of standard input when it exits
+				int nothing = open ("/dev/null", O_RDONLY);
+				dup2 (nothing, STDIN_FILENO);
+				close (nothing);
+				// the answers of the daemon are the only output on its standard output
+				dup2 (STDERR_FILENO, STDOUT_FILENO);
+
+				// the kept domain is a private copy of this process, so it can be taken instead of copied
+				requestArgs = args;
+				domain = std::move (cached->domain);
+				domain.constants = std::move (objects.constants);
+				domain.sorts = std::move (objects.sorts);
+				if (!readProblemState (input, domain, problem))
+				{
+					std::cerr << "Failed to read input data!" << std::endl;
+					exit (1);
+				}
+				return REQUEST_CHILD;
+			}
+
+			cmdline_parser_free (&args);
+			answer.child = child;
+			runningJobs++;
+			return REQUEST_SERVED;
+		}
+
+		/**
+		 * @brief Returns why the arguments of a request cannot be served, or an empty string if they can.
+		 */
+		static std::string checkArguments (const std::vector<std::string> & arguments)
+		{
+			// these exit the process that parses them
+			for (const std::string & argument : arguments)
+				if (argument == "-h" || argument == "--help" || argument == "--full-help" || argument == "--detailed-help"
+						|| argument == "-V" || argument == "--version")
+					return "help and version are not available in requests";
+			return "";
+		}
+
+		static void reply (int replyFd, const std::string & answer)
+		{
+			std::string line = answer + "\n";
+			const char * data = line.data ();
+			size_t size = line.size ();
+			while (size > 0)
+			{
+				ssize_t written = write (replyFd, data, size);
+				if (written < 0 && errno == EINTR)
+					continue;
+				// the client is gone, which does not concern the daemon
+				if (written < 0)
+					return;
+				data += written;
+				size -= written;
+			}
+		}
+
+		/**
+		 * @brief Collects the results of all child processes that have terminated.
+		 */
+		void reapChildren (void)
+		{
+			int status;
+			pid_t child;
+			while ((child = waitpid (-1, &status, WNOHANG)) > 0)
+				for (Client & client : clients)
+				{
+					auto answer = std::find_if (client.answers.begin (), client.answers.end (), [&] (const Answer & a) { return a.child == child; });
+					if (answer == client.answers.end ())
+						continue;
+
+					double milliseconds = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - answer->start).count ();
+					if (WIFEXITED (status) && WEXITSTATUS (status) == 0)
+						answer->text = "ok " + std::to_string ((long long) milliseconds);
+					else if (WIFEXITED (status))
+						answer->text = "failed exit " + std::to_string (WEXITSTATUS (status));
+					else
+						answer->text = "failed signal " + std::to_string (WTERMSIG (status));
+					answer->child = -1;
+					runningJobs--;
+					break;
+				}
+		}
+
+		/**
+		 * @brief Serves the complete request lines read so far, as long as there are free jobs.
+		 */
+		RequestResult servePending (Client & client, gengetopt_args_info & requestArgs, Domain & domain, Problem & problem)
+		{
+			while (runningJobs < jobLimit)
+			{
+				size_t end = client.pending.find ('\n');
+				// the last request does not need to end with a line break
+				if (end == std::string::npos && (!client.ended || client.pending.empty ()))
+					break;
+
+				std::string request = client.pending.substr (0, end);
+				client.pending.erase (0, end == std::string::npos ? end : end + 1);
+				RequestResult result = serve (request, client, requestArgs, domain, problem);
+				if (result != REQUEST_SERVED)
+					return result;
+			}
+			return REQUEST_SERVED;
+		}
+
+		/**
+		 * @brief Serves the requests of the clients until they have ended or the daemon is asked to quit. New clients connect to the
+		 * listener, if it is given.
+		 *
+		 * @return Returns true in the child process serving a request, and false in the daemon once all answers are written.
+		 */
+		bool run (int listener, gengetopt_args_info & requestArgs, Domain & domain, Problem & problem)
+		{
+			int childSignal[2];
+			if (pipe (childSignal) != 0)
+			{
+				std::cerr << "Unable to create a pipe: " << strerror (errno) << std::endl;
+				exitCode = 1;
+				return false;
+			}
+			for (int descriptor : childSignal)
+				fcntl (descriptor, F_SETFL, fcntl (descriptor, F_GETFL) | O_NONBLOCK);
+			childSignalFd = childSignal[1];
+			descriptors.insert (descriptors.end (), {childSignal[0], childSignal[1]});
+
+			struct sigaction action;
+			memset (&action, 0, sizeof (action));
+			action.sa_handler = onChildSignal;
+			action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+			sigaction (SIGCHLD, &action, nullptr);
+
+			bool quitting = false;
+			while (true)
+			{
+				reapChildren ();
+				for (Client & client : clients)
+				{
+					if (quitting)
+						break;
+					RequestResult result = servePending (client, requestArgs, domain, problem);
+					if (result == REQUEST_CHILD)
+						return true;
+					quitting = result == REQUEST_QUIT;
+				}
+
+				for (auto client = clients.begin (); client != clients.end ();)
+				{
+					while (!client->answers.empty () && !client->answers.front ().text.empty ())
+					{
+						reply (client->replyFd, client->answers.front ().text);
+						client->answers.pop_front ();
+					}
+
+					bool done = client->answers.empty () && (quitting || (client->ended && client->pending.empty ()));
+					if (!done)
+					{
+						++client;
+						continue;
+					}
+					if (client->requestFd != STDIN_FILENO)
+						close (client->requestFd);
+					client = clients.erase (client);
+				}
+
+				// without running children, no client is left at this point
+				if (clients.empty () && (quitting || listener < 0))
+					break;
+
+				std::vector<pollfd> events = {{childSignal[0], POLLIN, 0}};
+				if (listener >= 0 && !quitting)
+					events.push_back ({listener, POLLIN, 0});
+				std::vector<Client *> readers;
+				for (Client & client : clients)
+					if (!quitting && !client.ended && runningJobs < jobLimit && client.pending.find ('\n') == std::string::npos)
+					{
+						events.push_back ({client.requestFd, POLLIN, 0});
+						readers.push_back (&client);
+					}
+
+				if (poll (events.data (), events.size (), -1) < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					std::cerr << "Unable to wait for requests: " << strerror (errno) << std::endl;
+					exitCode = 1;
+					quitting = true;
+					continue;
+				}
+
+				char buffer[1 << 16];
+				if (events[0].revents)
+					while (read (childSignal[0], buffer, sizeof (buffer)) > 0);
+
+				size_t first = 1;
+				if (listener >= 0 && !quitting)
+				{
+					first = 2;
+					if (events[1].revents)
+					{
+						int connection = accept (listener, nullptr, nullptr);
+						if (connection >= 0)
+							clients.push_back ({connection, connection});
+						else if (errno != EINTR && errno != ECONNABORTED)
+						{
+							std::cerr << "Unable to accept a connection: " << strerror (errno) << std::endl;
+							exitCode = 1;
+							quitting = true;
+						}
+					}
+				}
+
+				for (size_t reader = 0; reader < readers.size (); ++reader)
+				{
+					if (!events[first + reader].revents)
+						continue;
+					ssize_t bytes = read (readers[reader]->requestFd, buffer, sizeof (buffer));
+					if (bytes > 0)
+						readers[reader]->pending.append (buffer, bytes);
+					else if (bytes == 0 || errno != EINTR)
+						readers[reader]->ended = true;
+				}
+			}
+
+			signal (SIGCHLD, SIG_DFL);
+			close (childSignal[0]);
+			close (childSignal[1]);
+			return false;
+		}
+	};
+
+	bool serveSocket (Daemon & daemon, const std::string & path, gengetopt_args_info & requestArgs, Domain & domain, Problem & problem)
+	{
+		sockaddr_un address;
+		memset (&address, 0, sizeof (address));
+		address.sun_family = AF_UNIX;
+		if (path.size () >= sizeof (address.sun_path))
+		{
+			std::cerr << "The socket path " << path << " is too long." << std::endl;
+			daemon.exitCode = 1;
+			return false;
+		}
+		strcpy (address.sun_path, path.c_str ());
+
+		int listener = socket (AF_UNIX, SOCK_STREAM, 0);
+		unlink (path.c_str ());
+		if (listener < 0 || bind (listener, (sockaddr *) &address, sizeof (address)) != 0 || listen (listener, 16) != 0)
+		{
+			std::cerr << "Unable to listen on socket " << path << ": " << strerror (errno) << std::endl;
+			if (listener >= 0)
+				close (listener);
+			daemon.exitCode = 1;
+			return false;
+		}
+		if (!daemon.quietMode)
+			std::cerr << "Daemon: listening on " << path << "." << std::endl;
+
+		daemon.descriptors.push_back (listener);
+		if (daemon.run (listener, requestArgs, domain, problem))
+			return true;
+
+		close (listener);
+		unlink (path.c_str ());
+		return false;
+	}
+}
+
+bool runDaemon (const gengetopt_args_info & daemonArgs, gengetopt_args_info & requestArgs, Domain & domain, Problem & problem, int & exitCode)
+{
+	Daemon daemon;
+	daemon.quietMode = daemonArgs.quiet_flag;
+	daemon.domainLimit = std::max (daemonArgs.daemon_models_arg, 1);
+	daemon.jobLimit = std::max (daemonArgs.daemon_jobs_arg, 1);
+
+	// a client that disconnects early must not stop the daemon
+	signal (SIGPIPE, SIG_IGN);
+
+	bool child;
+	if (daemonArgs.daemon_socket_given)
+		child = serveSocket (daemon, daemonArgs.daemon_socket_arg, requestArgs, domain, problem);
+	else
+	{
+		if (!daemon.quietMode)
+			std::cerr << "Daemon: reading requests from standard input." << std::endl;
+		daemon.clients.push_back ({STDIN_FILENO, STDOUT_FILENO});
+		child = daemon.run (-1, requestArgs, domain, problem);
+	}
+	exitCode = daemon.exitCode;
+	return child;
+}
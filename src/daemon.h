@@ -0,0 +1,45 @@
+#ifndef DAEMON_H_INCLUDED
+#define DAEMON_H_INCLUDED
+
+/**
+ * @defgroup daemon Daemon Mode
+ * @brief Serves many grounding requests from one long-running process.
+ *
+ * @{
+ */
+
+#include "cmdline.h"
+#include "model.h"
+
+/**
+ * @brief Reads grounding requests line by line from standard input, or from the connections to a Unix domain socket, and serves each
+ * of them in a child process.
+ *
+ * A request consists of the arguments of a single run, separated by whitespace, e.g. "-q -i problem.htn problem.sas". Input and output
+ * must be files. The request is answered by a line "ok <milliseconds>" if the grounding succeeded, "failed exit <code>" or
+ * "failed signal <number>" if the child process did not, and "error <reason>" if it was not started at all. The request "quit" stops
+ * the daemon once the running requests are answered. Up to --daemon-jobs requests are served at the same time, every one with its own
+ * grounding_configuration, but the answers to the requests of a standard input or a connection are written in the order of the requests.
+ *
+ * The daemon reads the constants and sorts of a request itself, and keeps the domain schemas of the last --daemon-models domains (see
+ * readDomainSchemas()), identified by the names of the sorts and the hash of their part of the input. The child process inherits the
+ * schemas with fork(), so requests for problems of a kept domain neither parse them nor copy them, and only read the initial state, the
+ * goal and the initial task (see readProblemState()). Everything depending on them, like the order of the preconditions and the FAM
+ * groups, is computed for every request. Everything the grounding writes to standard output goes to standard error in the child, so
+ * the answers stay readable.
+ *
+ * @param[in] daemonArgs The arguments the daemon was started with.
+ * @param[out] requestArgs The arguments of the request, in the child process.
+ * @param[out] domain The lifted domain of the request, in the child process.
+ * @param[out] problem The lifted problem of the request, in the child process.
+ * @param[out] exitCode The exit code of the daemon, once it stops.
+ * @return Returns true in the child process serving a request, which then continues like a normal run. Returns false in the daemon once
+ * its input ends, it is asked to quit, or it cannot serve any requests.
+ */
+bool runDaemon (const gengetopt_args_info & daemonArgs, gengetopt_args_info & requestArgs, Domain & domain, Problem & problem, int & exitCode);
+
+/**
+ * @}
+ */
+
+#endif
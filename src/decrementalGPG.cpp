@@ -0,0 +1,335 @@
+#include <cassert>
+#include <iostream>
+
+#include "decrementalGPG.h"
+
+AndOrReachability::AndOrReachability (const CsrAdjacency & inputs, const CsrAdjacency & outputs, const CsrAdjacency & consumers,
+		const CsrAdjacency & producers, std::vector<bool> enabled, std::vector<bool> axioms) :
+	inputs (inputs), outputs (outputs), consumers (consumers), producers (producers), enabled (std::move (enabled)), axioms (std::move (axioms))
+{
+	assert (this->enabled.size () == inputs.size () && this->axioms.size () == consumers.size ());
+
+	reached.resize (consumers.size ());
+	fired.resize (inputs.size ());
+	missingInputs.resize (inputs.size ());
+
+	std::vector<int> newlyReached;
+	for (size_t orNode = 0; orNode < consumers.size (); orNode++)
+		if (this->axioms[orNode])
+		{
+			reached[orNode] = true;
+			newlyReached.push_back (orNode);
+		}
+
+	for (size_t andNode = 0; andNode < inputs.size (); andNode++)
+	{
+		missingInputs[andNode] = inputs[andNode].size ();
+		// AND nodes without inputs are never reached through forward()
+		if (missingInputs[andNode] == 0 && this->enabled[andNode])
+			fire (andNode, newlyReached);
+	}
+
+	forward (newlyReached);
+}
+
+void AndOrReachability::disable (int andNode)
+{
+	if (!enabled[andNode])
+		return;
+	enabled[andNode] = false;
+	disabledAndNodes.push_back (andNode);
+}
+
+void AndOrReachability::removeAxiom (int orNode)
+{
+	if (!axioms[orNode])
+		return;
+	axioms[orNode] = false;
+	removedAxioms.push_back (orNode);
+}
+
+void AndOrReachability::fire (int andNode, std::vector<int> & newlyReached)
+{
+	fired[andNode] = true;
+	for (int orNode : outputs[andNode])
+		if (!reached[orNode])
+		{
+			reached[orNode] = true;
+			newlyReached.push_back (orNode);
+		}
+}
+
+void AndOrReachability::forward (std::vector<int> & newlyReached)
+{
+	while (!newlyReached.empty ())
+	{
+		int orNode = newlyReached.back ();
+		newlyReached.pop_back ();
+
+		for (int andNode : consumers[orNode])
+			if (--missingInputs[andNode] == 0 && enabled[andNode] && !fired[andNode])
+				fire (andNode, newlyReached);
+	}
+}
+
+void AndOrReachability::propagate (std::vector<int> & lostOrNodes, std::vector<int> & lostAndNodes)
+{
+	// Delete everything that depends on a removed node, whether it has another derivation or not
+	std::vector<int> deletedOrNodes;
+	std::vector<int> deletedAndNodes;
+	std::vector<int> toBeDeleted;
+
+	auto deleteOrNode = [&] (int orNode)
+	{
+		reached[orNode] = false;
+		deletedOrNodes.push_back (orNode);
+		toBeDeleted.push_back (orNode);
+	};
+	auto unfire = [&] (int andNode)
+	{
+		fired[andNode] = false;
+		deletedAndNodes.push_back (andNode);
+		for (int orNode : outputs[andNode])
+			if (reached[orNode])
+				deleteOrNode (orNode);
+	};
+
+	for (int andNode : disabledAndNodes)
+		if (fired[andNode])
+			unfire (andNode);
+	for (int orNode : removedAxioms)
+		if (reached[orNode])
+			deleteOrNode (orNode);
+	disabledAndNodes.clear ();
+	removedAxioms.clear ();
+
+	while (!toBeDeleted.empty ())
+	{
+		int orNode = toBeDeleted.back ();
+		toBeDeleted.pop_back ();
+
+		for (int andNode : consumers[orNode])
+		{
+			missingInputs[andNode]++;
+			if (fired[andNode])
+				unfire (andNode);
+		}
+	}
+
+	// Everything still reached has a derivation that does not use a deleted node, so re-derive the deleted nodes from it
+	std::vector<int> newlyReached;
+	for (int orNode : deletedOrNodes)
+	{
+		if (reached[orNode])
+			continue;
+
+		bool derivable = axioms[orNode];
+		for (size_t producerIdx = 0; !derivable && producerIdx < producers[orNode].size (); producerIdx++)
+			derivable = fired[producers[orNode][producerIdx]];
+
+		if (derivable)
+		{
+			reached[orNode] = true;
+			newlyReached.push_back (orNode);
+		}
+	}
+	forward (newlyReached);
+
+	for (int orNode : deletedOrNodes)
+		if (!reached[orNode])
+			lostOrNodes.push_back (orNode);
+	for (int andNode : deletedAndNodes)
+		if (!fired[andNode])
+			lostAndNodes.push_back (andNode);
+}
+
+bool DecrementalGroundedGpg::isValid (void) const
+{
+	return model != nullptr;
+}
+
+void DecrementalGroundedGpg::invalidate (void)
+{
+	pg.reset ();
+	tdg.reset ();
+	dfs.reset ();
+	model.reset ();
+	methodsByAddedTask = CsrAdjacency ();
+	decomposedTasksOfMethod = CsrAdjacency ();
+}
+
+void DecrementalGroundedGpg::build (const Domain & domain, const Problem & problem, const std::vector<Fact> & facts, const std::vector<GroundedTask> & tasks,
+		const std::vector<GroundedMethod> & methods, const std::vector<bool> & prunedFacts, const std::vector<bool> & prunedTasks,
+		const std::vector<bool> & prunedMethods)
+{
+	invalidate ();
+
+	model = std::make_unique<GroundedModel> (facts, tasks, methods);
+	methodsByAddedTask = model->methodTasks.reversed (tasks.size (), false);
+	decomposedTasksOfMethod = model->taskMethods.reversed (methods.size (), false);
+
+	primitive.assign (tasks.size (), false);
+	conditionalEffect.assign (tasks.size (), false);
+	root.assign (tasks.size (), false);
+	for (size_t taskIdx = 0; taskIdx < tasks.size (); taskIdx++)
+	{
+		const GroundedTask & task = tasks[taskIdx];
+		assert (task.groundedNo == int (taskIdx));
+		primitive[taskIdx] = task.taskNo < domain.nPrimitiveTasks;
+		conditionalEffect[taskIdx] = domain.tasks[task.taskNo].isCompiledConditionalEffect;
+		root[taskIdx] = task.taskNo == problem.initialAbstractTask;
+	}
+
+	// The grounded PG: facts and primitive tasks, where the first facts are the ones of the initial state
+	std::vector<bool> enabledTasks (tasks.size ());
+	std::vector<bool> initFacts (facts.size ());
+	for (size_t taskIdx = 0; taskIdx < tasks.size (); taskIdx++)
+		enabledTasks[taskIdx] = primitive[taskIdx] && !prunedTasks[taskIdx];
+	for (size_t factIdx = 0; factIdx < problem.init.size () && factIdx < facts.size (); factIdx++)
+		initFacts[factIdx] = true;
+	pg = std::make_unique<AndOrReachability> (model->taskPreconditions, model->taskAddEffects, model->tasksByPrecondition, model->tasksByAddEffect,
+			enabledTasks, initFacts);
+
+	// The grounded TDG: bottom-up from the primitive tasks
+	std::vector<bool> enabledMethods (methods.size ());
+	for (size_t methodIdx = 0; methodIdx < methods.size (); methodIdx++)
+		enabledMethods[methodIdx] = !prunedMethods[methodIdx];
+	tdg = std::make_unique<AndOrReachability> (model->methodSubtasks, model->methodTasks, model->methodsBySubtask, methodsByAddedTask,
+			enabledMethods, enabledTasks);
+
+	// The DFS: top-down from the initial abstract task, a method is visited if the task it decomposes is
+	std::vector<bool> roots (tasks.size ());
+	for (size_t taskIdx = 0; taskIdx < tasks.size (); taskIdx++)
+		roots[taskIdx] = root[taskIdx] && !prunedTasks[taskIdx];
+	dfs = std::make_unique<AndOrReachability> (decomposedTasksOfMethod, model->methodSubtasks, model->taskMethods, model->methodsBySubtask,
+			enabledMethods, roots);
+
+	// Only a fixpoint of the full iteration can be maintained
+	bool consistent = true;
+	for (size_t factIdx = 0; consistent && factIdx < facts.size (); factIdx++)
+		consistent = pg->isReached (factIdx) || prunedFacts[factIdx];
+	for (size_t taskIdx = 0; consistent && taskIdx < tasks.size (); taskIdx++)
+		consistent = (!enabledTasks[taskIdx] || pg->isFired (taskIdx))
+			&& (tdg->isReached (taskIdx) || prunedTasks[taskIdx])
+			&& (dfs->isReached (taskIdx) || prunedTasks[taskIdx] || conditionalEffect[taskIdx]);
+	for (size_t methodIdx = 0; consistent && methodIdx < methods.size (); methodIdx++)
+		consistent = prunedMethods[methodIdx]
+			|| (tdg->isFired (methodIdx) && dfs->isFired (methodIdx) && decomposedTasksOfMethod[methodIdx].size () == 1);
+
+	if (!consistent)
+	{
+		invalidate ();
+		return;
+	}
+
+	knownPrunedTasks = prunedTasks;
+	knownPrunedMethods = prunedMethods;
+}
+
+void DecrementalGroundedGpg::run (std::vector<bool> & prunedFacts, std::vector<bool> & prunedTasks, std::vector<bool> & prunedMethods,
+		bool alwaysRunDFS, const grounding_configuration & config)
+{
+	assert (isValid ());
+
+	size_t numberOfPrunedFacts = 0;
+	size_t numberOfPrunedTasks = 0;
+	size_t numberOfPrunedMethods = 0;
+
+	// The delta consists of everything pruned by other passes since the last call
+	std::vector<int> newlyPrunedTasks;
+	std::vector<int> newlyPrunedMethods;
+	size_t prunedPrimitiveTasks = 0;
+	for (size_t taskIdx = 0; taskIdx < prunedTasks.size (); taskIdx++)
+	{
+		if (prunedTasks[taskIdx] && primitive[taskIdx])
+			prunedPrimitiveTasks++;
+		if (prunedTasks[taskIdx] && !knownPrunedTasks[taskIdx])
+			newlyPrunedTasks.push_back (taskIdx);
+	}
+	for (size_t methodIdx = 0; methodIdx < prunedMethods.size (); methodIdx++)
+		if (prunedMethods[methodIdx] && !knownPrunedMethods[methodIdx])
+			newlyPrunedMethods.push_back (methodIdx);
+	size_t deltaSize = newlyPrunedTasks.size () + newlyPrunedMethods.size ();
+
+	// As the full iteration, stop after the grounded PG if no primitive task is pruned at all. The delta is kept for the next call.
+	if (prunedPrimitiveTasks == 0 && !alwaysRunDFS)
+		return;
+
+	auto pruneTask = [&] (int taskIdx)
+	{
+		if (prunedTasks[taskIdx])
+			return;
+		prunedTasks[taskIdx] = true;
+		newlyPrunedTasks.push_back (taskIdx);
+		numberOfPrunedTasks++;
+	};
+	auto pruneMethod = [&] (int methodIdx)
+	{
+		if (prunedMethods[methodIdx])
+			return;
+		prunedMethods[methodIdx] = true;
+		newlyPrunedMethods.push_back (methodIdx);
+		numberOfPrunedMethods++;
+	};
+
+	std::vector<int> lostOrNodes;
+	std::vector<int> lostAndNodes;
+	while (!newlyPrunedTasks.empty () || !newlyPrunedMethods.empty ())
+	{
+		for (int taskIdx : newlyPrunedTasks)
+		{
+			knownPrunedTasks[taskIdx] = true;
+			if (primitive[taskIdx])
+			{
+				pg->disable (taskIdx);
+				tdg->removeAxiom (taskIdx);
+			}
+			if (root[taskIdx])
+				dfs->removeAxiom (taskIdx);
+		}
+		for (int methodIdx : newlyPrunedMethods)
+		{
+			knownPrunedMethods[methodIdx] = true;
+			tdg->disable (methodIdx);
+			dfs->disable (methodIdx);
+		}
+		newlyPrunedTasks.clear ();
+		newlyPrunedMethods.clear ();
+
+		// Grounded PG: prune unreachable facts and the tasks needing them
+		lostOrNodes.clear ();
+		lostAndNodes.clear ();
+		pg->propagate (lostOrNodes, lostAndNodes);
+		for (int factIdx : lostOrNodes)
+			if (!prunedFacts[factIdx])
+			{
+				prunedFacts[factIdx] = true;
+				numberOfPrunedFacts++;
+			}
+		for (int taskIdx : lostAndNodes)
+			pruneTask (taskIdx);
+
+		// Grounded TDG: prune methods with an unreachable subtask and the tasks without a method
+		lostOrNodes.clear ();
+		lostAndNodes.clear ();
+		tdg->propagate (lostOrNodes, lostAndNodes);
+		for (int taskIdx : lostOrNodes)
+			pruneTask (taskIdx);
+		for (int methodIdx : lostAndNodes)
+			pruneMethod (methodIdx);
+
+		// DFS: prune everything not reachable from the initial abstract task, except for conditional effects
+		lostOrNodes.clear ();
+		lostAndNodes.clear ();
+		dfs->propagate (lostOrNodes, lostAndNodes);
+		for (int taskIdx : lostOrNodes)
+			if (!conditionalEffect[taskIdx])
+				pruneTask (taskIdx);
+		for (int methodIdx : lostAndNodes)
+			pruneMethod (methodIdx);
+	}
+
+	if (!config.quietMode)
+		std::cerr << "Decremental grounded GPG: delta of " << deltaSize << " tasks and methods, pruned [" << numberOfPrunedTasks << ", "
+			<< numberOfPrunedMethods << ", " << numberOfPrunedFacts << "] further tasks, methods and facts." << std::endl;
+}
@@ -0,0 +1,153 @@
+#ifndef DECREMENTALGPG_H_INCLUDED
+#define DECREMENTALGPG_H_INCLUDED
+
+/**
+ * @defgroup decrementalgpg Decremental Grounded GPG
+ * @brief Keeps the reachability of the grounded PG, TDG and DFS alive between calls of run_grounded_HTN_GPG().
+ *
+ * @{
+ */
+
+#include <memory>
+#include <vector>
+
+#include "grounding.h"
+#include "groundedmodel.h"
+#include "model.h"
+
+/**
+ * @brief The least fixpoint of an AND/OR graph that can be maintained while AND nodes are disabled and OR nodes lose their axiom.
+ *
+ * An OR node is reached if it is an axiom or an output of a fired AND node. An AND node fires if it is enabled and all of its
+ * inputs are reached. The grounded PG (facts and tasks), TDG (tasks and methods) and DFS (tasks and methods) are such graphs.
+ *
+ * Removals are propagated with delete and re-derive: everything that depends on a removed node is deleted first, then the
+ * deleted OR nodes that still have an axiom or a fired producer are reached again together with their consequences. Cycles,
+ * e.g. facts that are added by tasks depending on each other, are handled correctly.
+ *
+ * The graph is given by references to adjacencies, which must outlive the object.
+ */
+class AndOrReachability
+{
+public:
+	/**
+	 * @brief Computes the fixpoint from scratch.
+	 *
+	 * inputs and outputs contain the OR nodes of every AND node, consumers and producers the AND nodes having an OR node as an
+	 * input or output, respectively. Inputs and consumers must contain each other with the same multiplicity.
+	 */
+	AndOrReachability (const CsrAdjacency & inputs, const CsrAdjacency & outputs, const CsrAdjacency & consumers, const CsrAdjacency & producers,
+			std::vector<bool> enabled, std::vector<bool> axioms);
+
+	/**
+	 * @brief Disables the given AND node with the next call of propagate().
+	 */
+	void disable (int andNode);
+
+	/**
+	 * @brief Removes the axiom of the given OR node with the next call of propagate().
+	 */
+	void removeAxiom (int orNode);
+
+	/**
+	 * @brief Applies all removals since the last call and appends the nodes that are no longer reached or fired.
+	 */
+	void propagate (std::vector<int> & lostOrNodes, std::vector<int> & lostAndNodes);
+
+	bool isReached (int orNode) const
+	{
+		return reached[orNode];
+	}
+
+	bool isFired (int andNode) const
+	{
+		return fired[andNode];
+	}
+
+private:
+	const CsrAdjacency & inputs;
+	const CsrAdjacency & outputs;
+	const CsrAdjacency & consumers;
+	const CsrAdjacency & producers;
+
+	std::vector<bool> enabled;
+	std::vector<bool> axioms;
+	std::vector<bool> reached;
+	std::vector<bool> fired;
+	/// Per AND node, the number of its inputs that are not reached
+	std::vector<int> missingInputs;
+
+	std::vector<int> disabledAndNodes;
+	std::vector<int> removedAxioms;
+
+	void fire (int andNode, std::vector<int> & newlyReached);
+
+	/**
+	 * @brief Propagates the given newly reached OR nodes forward.
+	 */
+	void forward (std::vector<int> & newlyReached);
+};
+
+/**
+ * @brief The grounded PG, TDG and DFS of run_grounded_HTN_GPG() as three AndOrReachability instances.
+ *
+ * After a full run of run_grounded_HTN_GPG(), build() creates the three graphs. Later calls then only propagate the tasks and
+ * methods that were pruned since the last call through them and prune whatever is no longer reachable. The result is the same as
+ * that of the full fixpoint iteration. Passes that change the lists of the grounded tasks or methods must call invalidate().
+ */
+class DecrementalGroundedGpg
+{
+public:
+	/**
+	 * @brief Returns whether run() can be used, i.e. build() succeeded and nothing invalidated it since.
+	 */
+	bool isValid (void) const;
+
+	/**
+	 * @brief Drops all graphs, the next call of run_grounded_HTN_GPG() runs the full fixpoint iteration again.
+	 */
+	void invalidate (void);
+
+	/**
+	 * @brief Builds the graphs for the given grounding.
+	 *
+	 * The pruning masks must be a fixpoint of the grounded PG, TDG and DFS, otherwise the object stays invalid.
+	 */
+	void build (const Domain & domain, const Problem & problem, const std::vector<Fact> & facts, const std::vector<GroundedTask> & tasks,
+			const std::vector<GroundedMethod> & methods, const std::vector<bool> & prunedFacts, const std::vector<bool> & prunedTasks,
+			const std::vector<bool> & prunedMethods);
+
+	/**
+	 * @brief Prunes all facts, tasks and methods that became unreachable because of the tasks and methods pruned since the last call.
+	 *
+	 * Like the full iteration, this does nothing unless some primitive task is pruned or alwaysRunDFS is set.
+	 */
+	void run (std::vector<bool> & prunedFacts, std::vector<bool> & prunedTasks, std::vector<bool> & prunedMethods, bool alwaysRunDFS,
+			const grounding_configuration & config);
+
+private:
+	std::unique_ptr<GroundedModel> model;
+	/// Per grounded task, the methods whose add effect it is
+	CsrAdjacency methodsByAddedTask;
+	/// Per grounded method, the tasks listing it as a decomposition method
+	CsrAdjacency decomposedTasksOfMethod;
+
+	std::unique_ptr<AndOrReachability> pg;
+	std::unique_ptr<AndOrReachability> tdg;
+	std::unique_ptr<AndOrReachability> dfs;
+
+	std::vector<bool> primitive;
+	std::vector<bool> conditionalEffect;
+	/// Grounded tasks of the initial abstract task
+	std::vector<bool> root;
+
+	/// The pruning masks as of the end of the last call
+	std::vector<bool> knownPrunedTasks;
+	std::vector<bool> knownPrunedMethods;
+};
+
+/**
+ * @}
+ */
+
+#endif
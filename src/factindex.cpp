@@ -0,0 +1,138 @@
+#include <bit>
+#include <cassert>
+#include <cstring>
+
+#include "factindex.h"
+
+static uint64_t mix (uint64_t x)
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+FlatFactIndex::FlatFactIndex (size_t keyWidth, int maximalValue) : keyWidth (keyWidth)
+{
+	assert (maximalValue >= 0);
+	bitsPerValue = std::bit_width (static_cast<unsigned> (maximalValue));
+	if (bitsPerValue == 0)
+		bitsPerValue = 1;
+	packed = keyWidth * bitsPerValue <= 64;
+}
+
+uint64_t FlatFactIndex::packKey (const int * key) const
+{
+	uint64_t result = 0;
+	if (packed)
+	{
+		for (size_t i = 0; i < keyWidth; ++i)
+		{
+			assert (key[i] >= 0 && std::bit_width (static_cast<unsigned> (key[i])) <= bitsPerValue);
+			result = (result << bitsPerValue) | static_cast<uint64_t> (key[i]);
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < keyWidth; ++i)
+			result = mix (result ^ static_cast<uint64_t> (key[i]));
+	}
+	return result;
+}
+
+bool FlatFactIndex::keyEquals (const Slot & slot, uint64_t packedKey, const int * key) const
+{
+	if (slot.key != packedKey)
+		return false;
+	if (packed)
+		return true;
+	return std::memcmp (keys.data () + slot.list * keyWidth, key, keyWidth * sizeof (int)) == 0;
+}
+
+size_t FlatFactIndex::findSlot (uint64_t packedKey, const int * key) const
+{
+	assert (!slots.empty ());
+	size_t mask = slots.size () - 1;
+	size_t slotIdx = mix (packedKey) & mask;
+	while (slots[slotIdx].list != EMPTY && !keyEquals (slots[slotIdx], packedKey, key))
+		slotIdx = (slotIdx + 1) & mask;
+	return slotIdx;
+}
+
+void FlatFactIndex::grow (void)
+{
+	std::vector<Slot> previousSlots = std::move (slots);
+	slots.assign (previousSlots.empty () ? 16 : 2 * previousSlots.size (), Slot {0, EMPTY});
+
+	size_t mask = slots.size () - 1;
+	for (const Slot & slot : previousSlots)
+	{
+		if (slot.list == EMPTY)
+			continue;
+
+		// all keys are distinct, so we only need to find a free slot
+		size_t slotIdx = mix (slot.key) & mask;
+		while (slots[slotIdx].list != EMPTY)
+			slotIdx = (slotIdx + 1) & mask;
+		slots[slotIdx] = slot;
+	}
+}
+
+void FlatFactIndex::insert (const int * key, int factIdx)
+{
+	// keep the load factor below 1/2
+	if (2 * (lists.size () + 1) > slots.size ())
+		grow ();
+
+	uint64_t packedKey = packKey (key);
+	size_t slotIdx = findSlot (packedKey, key);
+	Slot & slot = slots[slotIdx];
+	if (slot.list == EMPTY)
+	{
+		slot.key = packedKey;
+		slot.list = lists.size ();
+		lists.push_back ({static_cast<uint32_t> (postings.size ()), 0, 1});
+		postings.push_back (0);
+		if (!packed)
+			keys.insert (keys.end (), key, key + keyWidth);
+	}
+
+	PostingList & list = lists[slot.list];
+	if (list.size == list.capacity)
+	{
+		// move the list to the end, so that it stays contiguous
+		uint32_t newBegin = postings.size ();
+		postings.resize (postings.size () + 2 * list.capacity);
+		std::memcpy (postings.data () + newBegin, postings.data () + list.begin, list.size * sizeof (int));
+		list.begin = newBegin;
+		list.capacity *= 2;
+	}
+	postings[list.begin + list.size++] = factIdx;
+}
+
+std::span<const int> FlatFactIndex::find (const int * key) const
+{
+	if (slots.empty ())
+		return {};
+
+	uint64_t packedKey = packKey (key);
+	const Slot & slot = slots[findSlot (packedKey, key)];
+	if (slot.list == EMPTY)
+		return {};
+
+	const PostingList & list = lists[slot.list];
+	return std::span<const int> (postings.data () + list.begin, list.size);
+}
+
+size_t FlatFactIndex::numberOfKeys (void) const
+{
+	return lists.size ();
+}
+
+size_t FlatFactIndex::memoryUsage (void) const
+{
+	return sizeof (FlatFactIndex) + slots.capacity () * sizeof (Slot) + lists.capacity () * sizeof (PostingList)
+		+ keys.capacity () * sizeof (int) + postings.capacity () * sizeof (int);
+}
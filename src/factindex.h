@@ -0,0 +1,98 @@
+#ifndef FACTINDEX_H_INCLUDED
+#define FACTINDEX_H_INCLUDED
+
+/**
+ * @defgroup factindex Flat Fact Index
+ * @brief An open addressing hash table from fixed-width keys to lists of fact indices.
+ *
+ * @{
+ */
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * @brief Maps keys of keyWidth constants to lists of fact indices.
+ *
+ * This is the alternative to the std::map based index of GpgStateMap. If all constants of a key fit into 64 bits, the key is packed
+ * into a single integer and compared as such. Otherwise, the slot contains a hash of the key and the key itself is stored once per
+ * posting list.
+ *
+ * All posting lists live in a single vector. A list that is full is moved to the end of that vector with twice its capacity, so
+ * every list is contiguous and the space wasted by moved lists is at most the space used by the current ones.
+ *
+ * find() does not modify the index and can be called concurrently.
+ */
+class FlatFactIndex
+{
+public:
+	/**
+	 * @brief Creates an empty index for keys of keyWidth constants. All constants must be in [0; maximalValue].
+	 */
+	FlatFactIndex (size_t keyWidth, int maximalValue);
+
+	/**
+	 * @brief Appends factIdx to the posting list of the given key, which consists of keyWidth values.
+	 */
+	void insert (const int * key, int factIdx);
+
+	/**
+	 * @brief Returns the posting list of the given key, which is empty if the key has never been inserted.
+	 *
+	 * The returned span is invalidated by the next insert().
+	 */
+	std::span<const int> find (const int * key) const;
+
+	/**
+	 * @brief Returns the number of distinct keys in the index.
+	 */
+	size_t numberOfKeys (void) const;
+
+	/**
+	 * @brief Returns the number of bytes allocated by the index.
+	 */
+	size_t memoryUsage (void) const;
+
+private:
+	static const uint32_t EMPTY = UINT32_MAX;
+
+	struct Slot
+	{
+		/// The packed key, or the hash of the key if it can't be packed
+		uint64_t key;
+		/// Index of the posting list, EMPTY if the slot is free
+		uint32_t list;
+	};
+
+	struct PostingList
+	{
+		uint32_t begin;
+		uint32_t size;
+		uint32_t capacity;
+	};
+
+	uint64_t packKey (const int * key) const;
+
+	bool keyEquals (const Slot & slot, uint64_t packedKey, const int * key) const;
+
+	size_t findSlot (uint64_t packedKey, const int * key) const;
+
+	void grow (void);
+
+	size_t keyWidth;
+	unsigned bitsPerValue;
+	bool packed;
+
+	std::vector<Slot> slots;
+	std::vector<PostingList> lists;
+	/// keyWidth values per posting list; only used if keys are not packed
+	std::vector<int> keys;
+	std::vector<int> postings;
+};
+
+/**
+ * @}
+ */
+
+#endif
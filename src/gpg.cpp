@@ -10,37 +10,64 @@ std::map<int,double> stateElementInsertTime;
 std::map<int,double> liftedGroundingTime;
 std::map<int,double> instantiationtime;
 std::map<int,double> instantiationtime2;
-size_t totalFactTests = 0;
-std::vector<std::vector<std::vector<size_t>>> factTests;
-size_t totalFactHits = 0;
-std::vector<std::vector<std::vector<size_t>>> factHits;
-std::vector<std::vector<std::vector<size_t>>> factFutureRejects;
-std::vector<std::vector<std::vector<size_t>>> noextensionFound;
+GpgMatchStatistics gpgMatchStatistics;
 
-std::vector<size_t> futureReject;
-std::vector<size_t> futureTests;
-std::vector<size_t> htReject;
-std::vector<size_t> htTests;
+template <typename T>
+static void addAndClear (std::vector<T> & target, std::vector<T> & source)
+{
+	for (size_t i = 0; i < target.size (); ++i)
+	{
+		if constexpr (std::is_arithmetic_v<T>)
+		{
+			target[i] += source[i];
+			source[i] = 0;
+		}
+		else
+			addAndClear (target[i], source[i]);
+	}
+}
+
+void GpgMatchStatistics::moveFrom (GpgMatchStatistics & other)
+{
+	totalFactTests += other.totalFactTests;
+	totalFactHits += other.totalFactHits;
+	other.totalFactTests = 0;
+	other.totalFactHits = 0;
+
+	addAndClear (factTests, other.factTests);
+	addAndClear (factHits, other.factHits);
+	addAndClear (factFutureRejects, other.factFutureRejects);
+	addAndClear (noextensionFound, other.noextensionFound);
+	addAndClear (futureReject, other.futureReject);
+	addAndClear (futureTests, other.futureTests);
+	addAndClear (htReject, other.htReject);
+	addAndClear (htTests, other.htTests);
+	addAndClear (factLookupTime, other.factLookupTime);
+}
 
 
 
 // Returns the new number of the visited grounded task
-int innerTdgDfs (std::vector<GroundedTask> & outputTasks, std::vector<GroundedMethod> & outputMethods, std::vector<GroundedTask*> & inputTasks, std::vector<GroundedMethod *> & inputMethods, std::vector<Fact> & reachableFactsList, std::unordered_set<int> & reachableCEGuards, const Domain & domain, std::vector<int> & visitedTasks, size_t groundedTaskIdx)
+int innerTdgDfs (std::vector<GroundedTask> & outputTasks, std::vector<GroundedMethod> & outputMethods, std::vector<GroundedTask*> & inputTasks, std::vector<GroundedMethod *> & inputMethods, ObjectPool<GroundedTask> & taskPool, ObjectPool<GroundedMethod> & methodPool, std::vector<Fact> & reachableFactsList, std::unordered_set<int> & reachableCEGuards, const Domain & domain, std::vector<int> & visitedTasks, size_t groundedTaskIdx)
 {
 	if (visitedTasks[groundedTaskIdx] != -1)
 		return visitedTasks[groundedTaskIdx];
 
 	GroundedTask * groundedTask = inputTasks[groundedTaskIdx];
 
-	// Copy and renumber the grounded task
+	// Move and renumber the grounded task. Its methods are renumbered in place below, so always access it by index, as the
+	// recursion may reallocate outputTasks.
 	int newTaskNo = outputTasks.size ();
-	GroundedTask taskCopy = *groundedTask;
-	taskCopy.groundedNo = newTaskNo;
-	outputTasks.push_back (taskCopy);
+	outputTasks.push_back (std::move (*groundedTask));
+	outputTasks[newTaskNo].groundedNo = newTaskNo;
+
+	// release memory of this task
+	taskPool.release (groundedTask);
+	inputTasks[groundedTaskIdx] = 0;
 
 	// add effects that guard conditional effects
 	
-	for (int & groundNo : taskCopy.groundedAddEffects)
+	for (int & groundNo : outputTasks[newTaskNo].groundedAddEffects)
 		if (domain.predicates[reachableFactsList[groundNo].predicateNo].guard_for_conditional_effect){
 		reachableCEGuards.insert(groundNo);
 	}
@@ -48,43 +75,36 @@ int innerTdgDfs (std::vector<GroundedTask> & outputTasks, std::vector<GroundedMe
 
 	visitedTasks[groundedTaskIdx] = newTaskNo;
 
-	//for (auto groundedMethodIdx : groundedTask.groundedDecompositionMethods)
-	for (size_t groundedMethodIdx = 0; groundedMethodIdx < groundedTask->groundedDecompositionMethods.size (); ++groundedMethodIdx)
+	for (size_t groundedMethodIdx = 0; groundedMethodIdx < outputTasks[newTaskNo].groundedDecompositionMethods.size (); ++groundedMethodIdx)
 	{
-		int groundedMethodNo = groundedTask->groundedDecompositionMethods[groundedMethodIdx];
+		int groundedMethodNo = outputTasks[newTaskNo].groundedDecompositionMethods[groundedMethodIdx];
 		GroundedMethod * groundedMethod = inputMethods[groundedMethodNo];
 
-		// Copy and renumber the grounded method
+		// Move and renumber the grounded method, its subtasks are renumbered in place as well
 		int newMethodNo = outputMethods.size ();
-		GroundedMethod methodCopy = * groundedMethod;
-		methodCopy.groundedNo = newMethodNo;
+		outputMethods.push_back (std::move (*groundedMethod));
+		outputMethods[newMethodNo].groundedNo = newMethodNo;
 
-		outputTasks[newTaskNo].groundedDecompositionMethods[groundedMethodIdx] = newMethodNo;
+		// release memory of method
+		methodPool.release (groundedMethod);
 
-		methodCopy.groundedAddEffects.clear ();
-		methodCopy.groundedAddEffects.push_back (newTaskNo);
+		outputTasks[newTaskNo].groundedDecompositionMethods[groundedMethodIdx] = newMethodNo;
 
-		outputMethods.push_back (methodCopy);
+		outputMethods[newMethodNo].groundedAddEffects.clear ();
+		outputMethods[newMethodNo].groundedAddEffects.push_back (newTaskNo);
 
-		for (size_t subtaskIdx = 0; subtaskIdx < groundedMethod->groundedPreconditions.size (); ++subtaskIdx)
+		for (size_t subtaskIdx = 0; subtaskIdx < outputMethods[newMethodNo].groundedPreconditions.size (); ++subtaskIdx)
 		{
-			int subtaskNo = groundedMethod->groundedPreconditions[subtaskIdx];
-			int newSubtaskNo = innerTdgDfs (outputTasks, outputMethods, inputTasks, inputMethods, reachableFactsList, reachableCEGuards, domain, visitedTasks, subtaskNo);
+			int subtaskNo = outputMethods[newMethodNo].groundedPreconditions[subtaskIdx];
+			int newSubtaskNo = innerTdgDfs (outputTasks, outputMethods, inputTasks, inputMethods, taskPool, methodPool, reachableFactsList, reachableCEGuards, domain, visitedTasks, subtaskNo);
 			outputMethods[newMethodNo].groundedPreconditions[subtaskIdx] = newSubtaskNo;
 		}
-
-		// release memory of method
-		delete groundedMethod;
 	}
 
-	// release memory of this task
-	delete groundedTask;
-	inputTasks[groundedTaskIdx] = 0;
-
 	return newTaskNo;
 }
 
-void tdgDfs (std::vector<GroundedTask> & outputTasks, std::vector<GroundedMethod> & outputMethods, std::vector<GroundedTask*> & inputTasks, std::vector<GroundedMethod *> & inputMethods, std::vector<Fact> & reachableFactsList, std::unordered_set<int> & reachableCEGuards, const Domain & domain, const Problem & problem)
+void tdgDfs (std::vector<GroundedTask> & outputTasks, std::vector<GroundedMethod> & outputMethods, std::vector<GroundedTask*> & inputTasks, std::vector<GroundedMethod *> & inputMethods, ObjectPool<GroundedTask> & taskPool, ObjectPool<GroundedMethod> & methodPool, std::vector<Fact> & reachableFactsList, std::unordered_set<int> & reachableCEGuards, const Domain & domain, const Problem & problem)
 {
 	std::vector<int> visitedTasks (inputTasks.size (), -1);
 
@@ -92,7 +112,7 @@ void tdgDfs (std::vector<GroundedTask> & outputTasks, std::vector<GroundedMethod
 	{
 		if (task->taskNo != problem.initialAbstractTask)
 			continue;
-		innerTdgDfs (outputTasks, outputMethods, inputTasks, inputMethods, reachableFactsList, reachableCEGuards, domain, visitedTasks, task->groundedNo);
+		innerTdgDfs (outputTasks, outputMethods, inputTasks, inputMethods, taskPool, methodPool, reachableFactsList, reachableCEGuards, domain, visitedTasks, task->groundedNo);
 		return;
 	}
 }
@@ -7,6 +7,7 @@
  * @{
  */
 
+#include <chrono>
 #include <ctime>
 
 #include <algorithm>
@@ -17,19 +18,30 @@
 #include <numeric>
 #include <queue>
 #include <set>
+#include <span>
 #include <sstream>
 #include <vector>
 #include <ostream>
 #include <map>
 #include <cassert>
+#include <tuple>
 #include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include <unordered_map>
 #include <unordered_set>
 
 
 #include "debug.h"
+#include "factindex.h"
 #include "hierarchy-typing.h"
 #include "model.h"
+#include "objectpool.h"
 #include "rss.h"
+#include "statictable.h"
+#include "threadpool.h"
+#include "trieindex.h"
 
 #define TDG
 #define PRINT_METHODS
@@ -48,6 +60,8 @@ concept GpgInstance = requires (T instance)
 	requires Literal<typename T::ResultType>;
 	requires Literal<typename T::PreconditionType>;
 
+	{ instance.createResult () } -> std::same_as<typename T::ResultType *>;
+
 	//requires bool pruneWithHierarchyTyping;
 	//requires bool pruneWithFutureSatisfiablility;
 	// ...other things?
@@ -355,6 +369,90 @@ namespace std {
 }
 
 
+/**
+ * @brief The order in which gpgMatchPrecondition() matches the preconditions of an action for one initially matched precondition.
+ */
+struct GpgJoinPlan
+{
+	/**
+	 * @brief All preconditions except the initially matched one, in the order in which they are matched.
+	 */
+	std::vector<int> order;
+
+	/**
+	 * @brief For every step of order, the number of the set of assigned variables whose fact index is used (see GpgPreprocessedDomain#assignedVariablesSet).
+	 */
+	std::vector<int> variablesNumbers;
+
+	/**
+	 * @brief For every step of order, the arguments of the precondition whose values form the key of the fact index.
+	 */
+	std::vector<std::vector<int>> keyArguments;
+
+	/**
+	 * @brief Whether order is ascending. Only then the consistency table fits the order and the future satisfiability check can be used.
+	 */
+	bool ascending = true;
+
+	/**
+	 * @brief For every precondition, the number of facts compatible with it when this plan was made. Empty if the plan was never made.
+	 */
+	std::vector<size_t> plannedFactCounts;
+
+	/**
+	 * @brief For every step of order, the number of the static table probed in it, -1 if the step uses the fact index, and -2 if the precondition is joined in a table probed in an earlier step.
+	 *
+	 * For steps probing a static table, variablesNumbers holds the number of the index of the table instead.
+	 */
+	std::vector<int> staticTableNumbers;
+};
+
+/**
+ * @brief Static preconditions of an action that are connected by shared variables, joined in advance over the initial state.
+ *
+ * A precondition is static if no action has its predicate as a consequence, so all its state elements are known before the GPG
+ * starts. See gpgCompileStaticPreconditions().
+ */
+struct GpgStaticTable
+{
+	/**
+	 * @brief The static preconditions joined in the table, ascending.
+	 */
+	std::vector<int> preconditions;
+
+	/**
+	 * @brief The variables of these preconditions, ascending.
+	 */
+	std::vector<int> variables;
+
+	/**
+	 * @brief The rows: the values of variables, followed by the grounded number of the state element matched to each of the preconditions.
+	 */
+	StaticTable table;
+};
+
+/**
+ * @brief How gpgTriejoin() joins the preconditions of an action for one initially matched precondition.
+ */
+struct GpgTriejoinPlan
+{
+	/**
+	 * @brief The variables occurring in preconditions, in the order in which they are joined. Those of the initially matched precondition come first.
+	 */
+	std::vector<int> variableOrder;
+
+	/**
+	 * @brief For every precondition, the number of the trie whose levels follow variableOrder, -1 for the initially matched precondition.
+	 */
+	std::vector<int> trieNumbers;
+
+	/**
+	 * @brief For every position in variableOrder, the preconditions (except the initially matched one) containing that variable.
+	 */
+	std::vector<std::vector<int>> participants;
+};
+
+
 /**
  * @brief Allows efficient access to Facts that could potentially satisfy a precondition.
  */
@@ -373,6 +471,24 @@ struct GpgStateMap
 	 */
 	const GpgPreprocessedDomain<InstanceType> & preprocessedDomain;
 
+	/**
+	 * @brief The sets of assigned variables the fact indexes are kept for, see GpgPreprocessedDomain#assignedVariablesSet.
+	 *
+	 * This and the next two members start as copies of the preprocessed domain, which is never changed, and change with the fact
+	 * indexes of this state map when the join planner adds indexes or the memory controller drops them.
+	 */
+	std::vector<std::vector<std::vector<std::set<int>>>> assignedVariablesSet;
+
+	/**
+	 * @brief The number of the set of assigned variables for every initially matched precondition, see GpgPreprocessedDomain#assignedVariablesByTaskAndPrecondition.
+	 */
+	std::vector<std::vector<std::map<int, int>>> assignedVariablesByTaskAndPrecondition;
+
+	/**
+	 * @brief The preconditions that are optimized as initially matched preconditions, see GpgPreprocessedDomain#eligibleInitialPreconditionsByAction.
+	 */
+	std::vector<std::set<int>> eligibleInitialPreconditionsByAction;
+
 	/**
 	 * @brief if true, future consistency will be cached separately per initially matched precondition
 	 */
@@ -383,14 +499,86 @@ struct GpgStateMap
 	 */
 	std::vector<const typename InstanceType::StateType*> addedStateElements;
 
+	/**
+	 * @brief if true, flatFactMap is used instead of factMap
+	 */
+	bool useFlatFactIndex;
+
+	/**
+	 * @brief if true, the time spent in insertState() is measured per action
+	 */
+	bool measureTimes;
+
+	/**
+	 * @brief true while the workers of the parallel GPG match against this state map, see gpgProcessQueueInParallel()
+	 *
+	 * The fact index tables must only be added or dropped between the batches of the workers.
+	 */
+	bool matchingInParallel = false;
+
 	/**
 	 * @brief A list of Facts for each task, precondition, and ID of assigned variables and actually assigned constants.
 	 */
 	std::vector<std::vector<std::vector<VariablesToFactListMap>>> factMap;
 
+	/**
+	 * @brief The same as factMap, but stored in open addressing hash tables.
+	 */
+	std::vector<std::vector<std::vector<FlatFactIndex>>> flatFactMap;
+
+	/**
+	 * @brief Time in ms spent inserting into the fact index, per action. Only measured if measureTimes is set.
+	 */
+	std::vector<double> factIndexInsertTime;
+
 
 	std::vector<int> numberOfAntecedantsWithoutFact;
 
+	/**
+	 * @brief The number of facts inserted into the fact index of each task and precondition, i.e. that are compatible with the precondition.
+	 */
+	std::vector<std::vector<size_t>> factCounts;
+
+	/**
+	 * @brief The join plan of each task and initially matched precondition.
+	 */
+	std::vector<std::vector<GpgJoinPlan>> joinPlans;
+
+	/**
+	 * @brief Per task, whether the join plans must stay ascending because the fact index tables they would need were dropped.
+	 */
+	std::vector<bool> joinPlansFixed;
+
+	/**
+	 * @brief Per task, whether it is matched by gpgTriejoin() instead of gpgMatchPrecondition().
+	 */
+	std::vector<bool> matchWithTriejoin;
+
+	/**
+	 * @brief Per task and initially matched precondition, the plan for gpgTriejoin(). Only set up if matchWithTriejoin is.
+	 */
+	std::vector<std::vector<GpgTriejoinPlan>> triejoinPlans;
+
+	/**
+	 * @brief For every task, precondition and trie, the facts compatible with the precondition as tuples of the values of trieArguments, followed by the index of the fact in addedStateElements.
+	 */
+	std::vector<std::vector<std::vector<TrieIndex>>> tries;
+
+	/**
+	 * @brief For every task, precondition and trie, the arguments of the precondition that make up the levels of the trie.
+	 */
+	std::vector<std::vector<std::vector<std::vector<int>>>> trieArguments;
+
+	/**
+	 * @brief Per task, the tables its static preconditions are joined in. Empty unless set by setStaticTables().
+	 */
+	std::vector<std::vector<GpgStaticTable>> staticTables;
+
+	/**
+	 * @brief For every task and precondition, the number of the static table it is joined in, -1 if it is matched against the fact index.
+	 */
+	std::vector<std::vector<int>> staticTableOfPrecondition;
+
 	/**
 	 * @brief Whether a fact exists for each task, precondition, future precondition and initially matched precondition (-1 if not eligible) and set of assigned variables.
 	 * note that the index of the precondition is moved by one, i.e. 0 represents precondition -1 (i.e. none matched so far) and size-1 is actually size-2 as it is not necessary to check for the last precondition at all
@@ -400,204 +588,637 @@ struct GpgStateMap
 	/**
 	 * @brief Initializes the factMap.
 	 */
-	GpgStateMap (const InstanceType & instance, const GpgPreprocessedDomain<InstanceType> & preprocessedDomain, bool _futureCachingByPrecondition) : 
-		instance (instance), preprocessedDomain (preprocessedDomain), futureCachingByPrecondition(_futureCachingByPrecondition)
+	GpgStateMap (const InstanceType & instance, const GpgPreprocessedDomain<InstanceType> & preprocessedDomain, bool _futureCachingByPrecondition, bool _useFlatFactIndex, bool _measureTimes) : 
+		instance (instance), preprocessedDomain (preprocessedDomain), assignedVariablesSet (preprocessedDomain.assignedVariablesSet),
+		assignedVariablesByTaskAndPrecondition (preprocessedDomain.assignedVariablesByTaskAndPrecondition),
+		eligibleInitialPreconditionsByAction (preprocessedDomain.eligibleInitialPreconditionsByAction), futureCachingByPrecondition(_futureCachingByPrecondition), useFlatFactIndex(_useFlatFactIndex), measureTimes(_measureTimes)
 	{
 		numberOfAntecedantsWithoutFact.resize(instance.getNumberOfActions());
 		factMap.resize (instance.getNumberOfActions ());
+		flatFactMap.resize (instance.getNumberOfActions ());
+		factIndexInsertTime.resize (instance.getNumberOfActions ());
 		consistency.resize (instance.getNumberOfActions ());
+		factCounts.resize (instance.getNumberOfActions ());
+		joinPlans.resize (instance.getNumberOfActions ());
+		joinPlansFixed.resize (instance.getNumberOfActions ());
+		matchWithTriejoin.resize (instance.getNumberOfActions ());
+		triejoinPlans.resize (instance.getNumberOfActions ());
+		tries.resize (instance.getNumberOfActions ());
+		trieArguments.resize (instance.getNumberOfActions ());
+		staticTables.resize (instance.getNumberOfActions ());
+		staticTableOfPrecondition.resize (instance.getNumberOfActions ());
 
 		for (size_t actionIdx = 0; actionIdx < instance.getNumberOfActions (); ++actionIdx)
 		{
 			const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
 			factMap[actionIdx].resize (action.getAntecedents ().size ());
+			factCounts[actionIdx].resize (action.getAntecedents ().size ());
+			tries[actionIdx].resize (action.getAntecedents ().size ());
+			trieArguments[actionIdx].resize (action.getAntecedents ().size ());
+			staticTableOfPrecondition[actionIdx].assign (action.getAntecedents ().size (), -1);
 			consistency[actionIdx].resize (action.getAntecedents().size () + 1);
 			numberOfAntecedantsWithoutFact[actionIdx] = action.getAntecedents().size();
 			
 			for (size_t preconditionIdx = 0; preconditionIdx < action.getAntecedents().size()+1; preconditionIdx++)
 				consistency[actionIdx][preconditionIdx].resize (action.getAntecedents ().size ());
 			
-			for (size_t preconditionIdx = 0; preconditionIdx < action.getAntecedents().size(); preconditionIdx++)
-				factMap[actionIdx][preconditionIdx].resize(preprocessedDomain.assignedVariablesSet[actionIdx][preconditionIdx].size());
+			if (useFlatFactIndex)
+				flatFactMap[actionIdx].resize (action.getAntecedents ().size ());
+
+			for (size_t preconditionIdx = 0; preconditionIdx < action.getAntecedents().size(); preconditionIdx++){
+				if (!useFlatFactIndex){
+					factMap[actionIdx][preconditionIdx].resize(assignedVariablesSet[actionIdx][preconditionIdx].size());
+					continue;
+				}
+
+				for (const std::set<int> & assignedVariables : assignedVariablesSet[actionIdx][preconditionIdx])
+					flatFactMap[actionIdx][preconditionIdx].emplace_back (getKeyArguments (actionIdx, preconditionIdx, assignedVariables).size (), std::max<int> (instance.domain.constants.size (), 1) - 1);
+			}
+
+			joinPlans[actionIdx].resize (action.getAntecedents ().size ());
+			for (size_t initiallyMatchedPreconditionIdx = 0; initiallyMatchedPreconditionIdx < action.getAntecedents().size(); initiallyMatchedPreconditionIdx++)
+				setAscendingJoinPlan (actionIdx, initiallyMatchedPreconditionIdx);
 		}
 	}
 
 	/**
-	 * @brief Inserts a Fact into the maps of all preconditions with the same predicate as the Fact.
+	 * @brief Like GpgPreprocessedDomain#hasVariable(), but for the sets of assigned variables of this state map.
 	 */
-	void insertState (const typename InstanceType::StateType * stateElement)
+	bool hasVariable (int actionIdx, int preconditionIdx, int initiallyMatchedPrecondition, int var) const
 	{
-		int stateElementIndex = addedStateElements.size();
-		addedStateElements.push_back(stateElement);
-		
-		for (const auto & [actionIdx, preconditionIdx] : preprocessedDomain.preconditionsByPredicate[stateElement->getHeadNo ()])
-		{
-			const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
-			const typename InstanceType::PreconditionType & precondition = action.getAntecedents ()[preconditionIdx];
+		auto it = assignedVariablesByTaskAndPrecondition[actionIdx][preconditionIdx].find (initiallyMatchedPrecondition);
+		if (it == assignedVariablesByTaskAndPrecondition[actionIdx][preconditionIdx].end ()) return false;
 
-			assert (precondition.arguments.size () == stateElement->arguments.size ());
+		return assignedVariablesSet[actionIdx][preconditionIdx][it->second].count (var) > 0;
+	}
 
-			std::vector<int> values;
+	/**
+	 * @brief Returns the arguments of the given precondition that are instantiated with one of the given variables, i.e. that form the key of its fact index.
+	 */
+	std::vector<int> getKeyArguments (size_t actionIdx, size_t preconditionIdx, const std::set<int> & assignedVariables) const
+	{
+		const typename InstanceType::PreconditionType & precondition = instance.getAllActions ()[actionIdx].getAntecedents ()[preconditionIdx];
+		std::vector<int> keyArguments;
+		for (size_t argumentIdx = 0; argumentIdx < precondition.arguments.size (); ++argumentIdx)
+			if (assignedVariables.count (precondition.arguments[argumentIdx]))
+				keyArguments.push_back (argumentIdx);
+		return keyArguments;
+	}
 
-			for (const std::vector<int> & identical_group : preprocessedDomain.identicalArgumentsByTaskAndPrecondition[actionIdx][preconditionIdx]){
-				int val = stateElement->arguments[identical_group[0]];
-				for (size_t i = 1; i < identical_group.size(); i++)
-					if (stateElement->arguments[identical_group[i]] != val)
-						goto next_action;
-			}
+	/**
+	 * @brief Returns the number of the fact index of the given action and precondition with the given key arguments, or -1 if there is none.
+	 */
+	int findFactIndex (size_t actionIdx, size_t preconditionIdx, const std::vector<int> & keyArguments) const
+	{
+		const auto & assignedVariablesSets = assignedVariablesSet[actionIdx][preconditionIdx];
+		for (size_t variablesNumber = 0; variablesNumber < assignedVariablesSets.size (); variablesNumber++)
+			if (getKeyArguments (actionIdx, preconditionIdx, assignedVariablesSets[variablesNumber]) == keyArguments)
+				return variablesNumber;
+		return -1;
+	}
 
-			// Ineligible initially matched precondition
-			for (size_t argumentIdx = 0; argumentIdx < precondition.arguments.size (); ++argumentIdx)
-			{
-				int var = precondition.arguments[argumentIdx];
+	/**
+	 * @brief Returns the number of a fact index of the given action and precondition that is keyed by the given assigned variables.
+	 *
+	 * If there is none, a new one is created and filled with all facts inserted so far. Must not be called while
+	 * gpgMatchPrecondition() is running, i.e. only by the join planner between the batches of the parallel GPG.
+	 */
+	int getOrAddFactIndex (size_t actionIdx, size_t preconditionIdx, const std::set<int> & assignedVariables)
+	{
+		assert (!matchingInParallel);
+		std::vector<int> keyArguments = getKeyArguments (actionIdx, preconditionIdx, assignedVariables);
+		int variablesNumber = findFactIndex (actionIdx, preconditionIdx, keyArguments);
+		if (variablesNumber != -1)
+			return variablesNumber;
+
+		variablesNumber = assignedVariablesSet[actionIdx][preconditionIdx].size ();
+		assignedVariablesSet[actionIdx][preconditionIdx].push_back (assignedVariables);
+		if (useFlatFactIndex)
+			flatFactMap[actionIdx][preconditionIdx].emplace_back (keyArguments.size (), std::max<int> (instance.domain.constants.size (), 1) - 1);
+		else
+			factMap[actionIdx][preconditionIdx].emplace_back ();
 
-				// Skip this fact if its variables are incompatible with the sorts defined by the action
-				int value = stateElement->arguments[argumentIdx];
-				if (preprocessedDomain.domain.sorts[action.variableSorts[var]].members.count (value) == 0)
-					goto next_action;
+		const typename InstanceType::PreconditionType & precondition = instance.getAllActions ()[actionIdx].getAntecedents ()[preconditionIdx];
+		std::vector<int> values (keyArguments.size ());
+		for (size_t stateElementIndex = 0; stateElementIndex < addedStateElements.size (); ++stateElementIndex){
+			const typename InstanceType::StateType * stateElement = addedStateElements[stateElementIndex];
+			if (stateElement->getHeadNo () != precondition.getHeadNo () || !isCompatible (actionIdx, preconditionIdx, *stateElement))
+				continue;
 
-				if (preprocessedDomain.hasVariable(actionIdx,preconditionIdx,-1,var))
-					values.push_back (value);
-			}
-			if (factMap[actionIdx][preconditionIdx][0].size() == 0) // works as the assignment without a matched precondition is always the first
-				numberOfAntecedantsWithoutFact[actionIdx]--;
+			for (size_t keyIdx = 0; keyIdx < keyArguments.size (); keyIdx++)
+				values[keyIdx] = stateElement->arguments[keyArguments[keyIdx]];
+			if (useFlatFactIndex)
+				flatFactMap[actionIdx][preconditionIdx][variablesNumber].insert (values.data (), stateElementIndex);
+			else
+				factMap[actionIdx][preconditionIdx][variablesNumber][values].push_back (stateElementIndex);
+		}
 
+		return variablesNumber;
+	}
 
-			for (size_t variablesNumber = 0; variablesNumber < preprocessedDomain.assignedVariablesSet[actionIdx][preconditionIdx].size(); variablesNumber++){
-				const std::set<int> & assignedVariables = preprocessedDomain.assignedVariablesSet[actionIdx][preconditionIdx][variablesNumber];
-				std::vector<int> values;
-				for (size_t argumentIdx = 0; argumentIdx < precondition.arguments.size (); ++argumentIdx)
-				{
-					int var = precondition.arguments[argumentIdx];
-					int value = stateElement->arguments[argumentIdx];
-					// we have already checked this value in the previous loop	
+	/**
+	 * @brief Lets the given initially matched precondition of the given action match the other preconditions in ascending order.
+	 */
+	void setAscendingJoinPlan (size_t actionIdx, size_t initiallyMatchedPreconditionIdx)
+	{
+		bool initiallyMatchedPreconditionIsEligible = eligibleInitialPreconditionsByAction[actionIdx].count (initiallyMatchedPreconditionIdx) > 0;
+		GpgJoinPlan & joinPlan = joinPlans[actionIdx][initiallyMatchedPreconditionIdx];
+		joinPlan.order.clear ();
+		joinPlan.variablesNumbers.clear ();
+		joinPlan.keyArguments.clear ();
+		joinPlan.ascending = true;
+
+		for (size_t preconditionIdx = 0; preconditionIdx < joinPlans[actionIdx].size (); preconditionIdx++){
+			if (preconditionIdx == initiallyMatchedPreconditionIdx)
+				continue;
 
-					if (assignedVariables.count(var)) values.push_back(value);
-				}
-				
-				factMap[actionIdx][preconditionIdx][variablesNumber][values].push_back(stateElementIndex);
-			}
+			int variablesNumber = assignedVariablesByTaskAndPrecondition[actionIdx][preconditionIdx].at (initiallyMatchedPreconditionIsEligible ? initiallyMatchedPreconditionIdx : -1);
+			joinPlan.order.push_back (preconditionIdx);
+			joinPlan.variablesNumbers.push_back (variablesNumber);
+			joinPlan.keyArguments.push_back (getKeyArguments (actionIdx, preconditionIdx, assignedVariablesSet[actionIdx][preconditionIdx][variablesNumber]));
+		}
+		addStaticTableSteps (actionIdx, initiallyMatchedPreconditionIdx, joinPlan);
+	}
 
-			if (! instance.pruneWithFutureSatisfiablility[actionIdx]) continue;
-			
-			// mark as potential future precondition
-			for (int pastPreconditionIdx = -1; pastPreconditionIdx < preconditionIdx; pastPreconditionIdx++){
-				
-				// Ineligible initially matched precondition
-				std::vector<int> values;
-				for (size_t argumentIdx = 0; argumentIdx < precondition.arguments.size (); ++argumentIdx)
-				{
-					int var = precondition.arguments[argumentIdx];
-	
-					// check whether this variable will already have been set by the past precondition
-					if (preprocessedDomain.hasVariable(actionIdx,pastPreconditionIdx+1,-1,var))
-					{
-						values.push_back (stateElement->arguments[argumentIdx]);
-					}
-				}
-				consistency[actionIdx][pastPreconditionIdx+1][preconditionIdx][-1].insert(values);
+	/**
+	 * @brief Lets the given initially matched precondition of the given action match the other preconditions in the given order.
+	 *
+	 * Creates the fact index tables the order needs. Must not be called while gpgMatchPrecondition() is running.
+	 */
+	void setJoinPlan (size_t actionIdx, size_t initiallyMatchedPreconditionIdx, const std::vector<int> & order)
+	{
+		GpgJoinPlan & joinPlan = joinPlans[actionIdx][initiallyMatchedPreconditionIdx];
+		joinPlan.plannedFactCounts = factCounts[actionIdx];
+		if (std::is_sorted (order.begin (), order.end ())){
+			setAscendingJoinPlan (actionIdx, initiallyMatchedPreconditionIdx);
+			return;
+		}
 
-				if (!futureCachingByPrecondition) continue;	
-				// Eligible initially matched preconditions
-				for (int initiallyMatchedPreconditionIdx : preprocessedDomain.eligibleInitialPreconditionsByAction[actionIdx])
-				{
-					std::vector<int> values;
-					for (size_t argumentIdx = 0; argumentIdx < precondition.arguments.size (); ++argumentIdx)
-					{
-						int var = precondition.arguments[argumentIdx];
-						if (preprocessedDomain.hasVariable(actionIdx,pastPreconditionIdx+1,initiallyMatchedPreconditionIdx,var))
-						{
-							values.push_back (stateElement->arguments[argumentIdx]);
-						}
-					}
-	
-					consistency[actionIdx][pastPreconditionIdx+1][preconditionIdx][initiallyMatchedPreconditionIdx].insert(values);
-				}
+		const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
+		std::set<int> assignedVariables;
+		if (eligibleInitialPreconditionsByAction[actionIdx].count (initiallyMatchedPreconditionIdx))
+			assignedVariables.insert (action.getAntecedents ()[initiallyMatchedPreconditionIdx].arguments.begin (), action.getAntecedents ()[initiallyMatchedPreconditionIdx].arguments.end ());
+
+		joinPlan.order = order;
+		joinPlan.variablesNumbers.clear ();
+		joinPlan.keyArguments.clear ();
+		joinPlan.ascending = false;
+		for (int preconditionIdx : order){
+			int staticTableNumber = staticTableOfPrecondition[actionIdx][preconditionIdx];
+			if (staticTableNumber != -1){
+				// filled in by addStaticTableSteps()
+				joinPlan.variablesNumbers.push_back (-1);
+				joinPlan.keyArguments.emplace_back ();
+				const std::vector<int> & tableVariables = staticTables[actionIdx][staticTableNumber].variables;
+				assignedVariables.insert (tableVariables.begin (), tableVariables.end ());
+				continue;
 			}
 
-next_action:;
+			int variablesNumber = getOrAddFactIndex (actionIdx, preconditionIdx, assignedVariables);
+			joinPlan.variablesNumbers.push_back (variablesNumber);
+			joinPlan.keyArguments.push_back (getKeyArguments (actionIdx, preconditionIdx, assignedVariables));
+
+			const typename InstanceType::PreconditionType & precondition = action.getAntecedents ()[preconditionIdx];
+			assignedVariables.insert (precondition.arguments.begin (), precondition.arguments.end ());
 		}
+		addStaticTableSteps (actionIdx, initiallyMatchedPreconditionIdx, joinPlan);
 	}
 
-	void dropEligibleInitialPrecondition(){
-		return;
+	/**
+	 * @brief Lets the first step of the given join plan whose precondition is joined in a static table probe that table, and the later ones skip it.
+	 *
+	 * The index of the table is keyed by those of its variables that are assigned before the step, i.e. the variables of the
+	 * initially matched precondition (if any, -1 means none) and of all steps before. Must not be called while
+	 * gpgMatchPrecondition() is running.
+	 */
+	void addStaticTableSteps (size_t actionIdx, int initiallyMatchedPreconditionIdx, GpgJoinPlan & joinPlan)
+	{
+		joinPlan.staticTableNumbers.assign (joinPlan.order.size (), -1);
+		if (staticTables[actionIdx].empty ())
+			return;
 
-		std::vector<std::tuple<int,int,int>> eligibleSizes;
-		for (size_t a = 0; a < factMap.size(); a++){
-			for (size_t p = 0; p < factMap[a].size(); p++){
-				for (size_t pp = 1; pp < factMap[a][p].size(); pp++){
-					if (!preprocessedDomain.eligibleInitialPreconditionsByAction[a].count(pp-1)) continue;
+		const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
+		std::set<int> assignedVariables;
+		if (initiallyMatchedPreconditionIdx != -1)
+			assignedVariables.insert (action.getAntecedents ()[initiallyMatchedPreconditionIdx].arguments.begin (), action.getAntecedents ()[initiallyMatchedPreconditionIdx].arguments.end ());
+
+		std::vector<bool> probed (staticTables[actionIdx].size ());
+		for (size_t stepIdx = 0; stepIdx < joinPlan.order.size (); stepIdx++){
+			int staticTableNumber = staticTableOfPrecondition[actionIdx][joinPlan.order[stepIdx]];
+			if (staticTableNumber == -1){
+				const typename InstanceType::PreconditionType & precondition = action.getAntecedents ()[joinPlan.order[stepIdx]];
+				assignedVariables.insert (precondition.arguments.begin (), precondition.arguments.end ());
+				continue;
+			}
 
-					eligibleSizes.push_back(std::make_tuple(factMap[a][p][pp].size(), a, pp-1));
-				}
+			if (probed[staticTableNumber]){
+				joinPlan.staticTableNumbers[stepIdx] = -2;
+				continue;
 			}
+			probed[staticTableNumber] = true;
+
+			GpgStaticTable & staticTable = staticTables[actionIdx][staticTableNumber];
+			std::vector<int> keyColumns;
+			for (size_t column = 0; column < staticTable.variables.size (); column++)
+				if (assignedVariables.count (staticTable.variables[column]))
+					keyColumns.push_back (column);
+
+			joinPlan.staticTableNumbers[stepIdx] = staticTableNumber;
+			joinPlan.variablesNumbers[stepIdx] = staticTable.table.getOrAddIndex (keyColumns);
+			assignedVariables.insert (staticTable.variables.begin (), staticTable.variables.end ());
 		}
+	}
 
-		std::sort(eligibleSizes.begin(), eligibleSizes.end());
-		// prune 10 largest ones
-		for (int i = 0; i < 1 && eligibleSizes.size() - i - 1 >= 0; i++){
-			int size = std::get<0>(eligibleSizes[eligibleSizes.size() - i - 1]);
-			int a = std::get<1>(eligibleSizes[eligibleSizes.size() - i - 1]);
-			int pre = std::get<2>(eligibleSizes[eligibleSizes.size() - i - 1]);
-			const_cast<GpgPreprocessedDomain<InstanceType> &>(preprocessedDomain).eligibleInitialPreconditionsByAction[a].erase(pre);
-			
-			for (size_t p = 0; p < factMap[a].size(); p++)
-				factMap[a][p][1+pre].clear();
+	/**
+	 * @brief Returns a join plan for an action whose preconditions are all joined in static tables, without an initially matched precondition.
+	 */
+	GpgJoinPlan getStaticJoinPlan (size_t actionIdx)
+	{
+		GpgJoinPlan joinPlan;
+		joinPlan.ascending = false;
+		for (size_t preconditionIdx = 0; preconditionIdx < staticTableOfPrecondition[actionIdx].size (); preconditionIdx++){
+			assert (staticTableOfPrecondition[actionIdx][preconditionIdx] != -1);
+			joinPlan.order.push_back (preconditionIdx);
+			joinPlan.variablesNumbers.push_back (-1);
+			joinPlan.keyArguments.emplace_back ();
 		}
+		addStaticTableSteps (actionIdx, -1, joinPlan);
+		return joinPlan;
 	}
 
 	/**
-	 * @brief Returns all Facts for the given precondition in the given task that are compatible with the given variable assignment.
+	 * @brief Lets the given action match its static preconditions by probing the given tables instead of the fact index.
 	 *
-	 * For performance reasons, we want to return the Fact vector by reference. This means that we may have to instantiate a new
-	 * Fact vector if there is none for the given variable assignment. As a result, this method cannot be declared to be const.
+	 * The static preconditions are not inserted into the fact index anymore and are never initially matched. Thus, the tables count
+	 * as their facts, and the state elements of the tables must be inserted into the consistency table by the caller. Must be called
+	 * before any state element is inserted.
 	 */
-	std::vector<typename InstanceType::StateType> getFacts (size_t actionIdx, size_t preconditionIdx, const VariableAssignment & assignedVariables, int initiallyMatchedPreconditionIdx)
+	void setStaticTables (size_t actionIdx, std::vector<GpgStaticTable> && tables)
 	{
-		const typename InstanceType::PreconditionType & precondition = instance.getAllActions ()[actionIdx].getAntecedents ()[preconditionIdx];
+		assert (addedStateElements.empty ());
+		staticTables[actionIdx] = std::move (tables);
+		for (size_t staticTableNumber = 0; staticTableNumber < staticTables[actionIdx].size (); staticTableNumber++){
+			const GpgStaticTable & staticTable = staticTables[actionIdx][staticTableNumber];
+			for (int preconditionIdx : staticTable.preconditions){
+				staticTableOfPrecondition[actionIdx][preconditionIdx] = staticTableNumber;
+				factCounts[actionIdx][preconditionIdx] = staticTable.table.size ();
+				if (staticTable.table.size () > 0)
+					numberOfAntecedantsWithoutFact[actionIdx]--;
+			}
+		}
 
-		bool initiallyMatchedPreconditionIsEligible = preprocessedDomain.eligibleInitialPreconditionsByAction[actionIdx].count (initiallyMatchedPreconditionIdx) > 0;
-		if (!initiallyMatchedPreconditionIsEligible)
-			initiallyMatchedPreconditionIdx = -1;
+		for (size_t initiallyMatchedPreconditionIdx = 0; initiallyMatchedPreconditionIdx < joinPlans[actionIdx].size (); initiallyMatchedPreconditionIdx++)
+			setAscendingJoinPlan (actionIdx, initiallyMatchedPreconditionIdx);
+	}
 
-		// Build the vector which is used as the key in the map
-		std::vector<int> assignedVariableValues;
-		for (size_t argIdx = 0; argIdx < precondition.arguments.size (); ++argIdx)
-		{
-			int var = precondition.arguments[argIdx];
-			if (!(preprocessedDomain.hasVariable(actionIdx,preconditionIdx,initiallyMatchedPreconditionIdx,var)))
-				continue;
+	/**
+	 * @brief Inserts the given fact into the given trie of the given action and precondition.
+	 */
+	void insertIntoTrie (size_t actionIdx, size_t preconditionIdx, size_t trieNumber, int stateElementIndex)
+	{
+		thread_local std::vector<int> tuple;
+		tuple.clear ();
+		for (int argumentIdx : trieArguments[actionIdx][preconditionIdx][trieNumber])
+			tuple.push_back (addedStateElements[stateElementIndex]->arguments[argumentIdx]);
+		tuple.push_back (stateElementIndex);
+		tries[actionIdx][preconditionIdx][trieNumber].insert (tuple);
+	}
 
-			assert (assignedVariables.isAssigned (var));
-			assignedVariableValues.push_back (assignedVariables[var]);
-		}
+	/**
+	 * @brief Returns the number of a trie of the given action and precondition whose levels are the given arguments.
+	 *
+	 * If there is none, a new one is created and filled with all facts inserted so far.
+	 */
+	int getOrAddTrie (size_t actionIdx, size_t preconditionIdx, const std::vector<int> & arguments)
+	{
+		std::vector<std::vector<int>> & preconditionTrieArguments = trieArguments[actionIdx][preconditionIdx];
+		auto trieIt = std::find (preconditionTrieArguments.begin (), preconditionTrieArguments.end (), arguments);
+		if (trieIt != preconditionTrieArguments.end ())
+			return trieIt - preconditionTrieArguments.begin ();
 
-		
-		// generate return set
-		std::vector<typename InstanceType::StateType> ret;
-		int variableID = preprocessedDomain.assignedVariablesByTaskAndPrecondition[actionIdx][preconditionIdx].at(initiallyMatchedPreconditionIdx);
-		
-		for (int & x : factMap[actionIdx][preconditionIdx][variableID][assignedVariableValues])
-			ret.push_back(*addedStateElements[x]);
+		int trieNumber = preconditionTrieArguments.size ();
+		preconditionTrieArguments.push_back (arguments);
+		tries[actionIdx][preconditionIdx].emplace_back ();
 
+		const typename InstanceType::PreconditionType & precondition = instance.getAllActions ()[actionIdx].getAntecedents ()[preconditionIdx];
+		for (size_t stateElementIndex = 0; stateElementIndex < addedStateElements.size (); ++stateElementIndex){
+			const typename InstanceType::StateType * stateElement = addedStateElements[stateElementIndex];
+			if (stateElement->getHeadNo () == precondition.getHeadNo () && isCompatible (actionIdx, preconditionIdx, *stateElement))
+				insertIntoTrie (actionIdx, preconditionIdx, trieNumber, stateElementIndex);
+		}
 
-		return ret;
+		return trieNumber;
 	}
 
-	bool hasInstanceForAllAntecedants(size_t actionIdx, int initiallyMatchedPreconditionIdx){
-		if (numberOfAntecedantsWithoutFact[actionIdx] == 0) return true;
-		if (numberOfAntecedantsWithoutFact[actionIdx] >= 2) return false;
+	/**
+	 * @brief Lets gpgTriejoin() match the given action and sets up its plans and tries.
+	 *
+	 * The variables of the initially matched precondition are joined first, the others by descending number of preconditions
+	 * they occur in. Must not be called while gpgMatchPrecondition() or gpgTriejoin() is running.
+	 */
+	void enableTriejoin (size_t actionIdx)
+	{
+		const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
+		size_t numberOfPreconditions = action.getAntecedents ().size ();
+		matchWithTriejoin[actionIdx] = true;
+		triejoinPlans[actionIdx].assign (numberOfPreconditions, GpgTriejoinPlan ());
+
+		std::vector<int> numberOfOccurrences (action.variableSorts.size ());
+		for (const typename InstanceType::PreconditionType & precondition : action.getAntecedents ())
+			for (int var : std::set<int> (precondition.arguments.begin (), precondition.arguments.end ()))
+				numberOfOccurrences[var]++;
+
+		std::vector<int> variablesByOccurrences;
+		for (size_t var = 0; var < numberOfOccurrences.size (); var++)
+			if (numberOfOccurrences[var] > 0)
+				variablesByOccurrences.push_back (var);
+		std::stable_sort (variablesByOccurrences.begin (), variablesByOccurrences.end (), [&] (int var1, int var2) { return numberOfOccurrences[var1] > numberOfOccurrences[var2]; });
+
+		for (size_t initiallyMatchedPreconditionIdx = 0; initiallyMatchedPreconditionIdx < numberOfPreconditions; initiallyMatchedPreconditionIdx++){
+			GpgTriejoinPlan & plan = triejoinPlans[actionIdx][initiallyMatchedPreconditionIdx];
+			for (int var : action.getAntecedents ()[initiallyMatchedPreconditionIdx].arguments)
+				if (std::find (plan.variableOrder.begin (), plan.variableOrder.end (), var) == plan.variableOrder.end ())
+					plan.variableOrder.push_back (var);
+			for (int var : variablesByOccurrences)
+				if (std::find (plan.variableOrder.begin (), plan.variableOrder.end (), var) == plan.variableOrder.end ())
+					plan.variableOrder.push_back (var);
+
+			plan.participants.resize (plan.variableOrder.size ());
+			plan.trieNumbers.assign (numberOfPreconditions, -1);
+			for (size_t preconditionIdx = 0; preconditionIdx < numberOfPreconditions; preconditionIdx++){
+				if (preconditionIdx == initiallyMatchedPreconditionIdx)
+					continue;
 
-		return factMap[actionIdx][initiallyMatchedPreconditionIdx][0].size() == 0;
+				const typename InstanceType::PreconditionType & precondition = action.getAntecedents ()[preconditionIdx];
+				std::vector<int> arguments;
+				for (size_t position = 0; position < plan.variableOrder.size (); position++){
+					auto argumentIt = std::find (precondition.arguments.begin (), precondition.arguments.end (), plan.variableOrder[position]);
+					if (argumentIt == precondition.arguments.end ())
+						continue;
+
+					// repeated variables are taken care of by isCompatible()
+					arguments.push_back (argumentIt - precondition.arguments.begin ());
+					plan.participants[position].push_back (preconditionIdx);
+				}
+				plan.trieNumbers[preconditionIdx] = getOrAddTrie (actionIdx, preconditionIdx, arguments);
+			}
+		}
 	}
 
+	/**
+	 * @brief Returns the number of distinct keys in the fact index of the given action, precondition and set of assigned variables.
+	 */
+	size_t numberOfFactIndexKeys (size_t actionIdx, size_t preconditionIdx, size_t variablesNumber) const
+	{
+		if (useFlatFactIndex)
+			return flatFactMap[actionIdx][preconditionIdx][variablesNumber].numberOfKeys ();
+		return factMap[actionIdx][preconditionIdx][variablesNumber].size ();
+	}
 
-
-	// precondition index may be -1 indicating that no precondition has been set yet, except for the initially matched one	
-	bool hasPotentiallyConsistentExtension (size_t actionIdx, size_t preconditionIdx, const VariableAssignment & assignedVariables, int initiallyMatchedPreconditionIdx){
+	/**
+	 * @brief Returns the number of bytes used by the fact index of the given action, precondition and set of assigned variables. For factMap, this is an estimate.
+	 */
+	size_t getFactIndexMemoryUsage (size_t actionIdx, size_t preconditionIdx, size_t variablesNumber) const
+	{
+		if (useFlatFactIndex)
+			return flatFactMap[actionIdx][preconditionIdx][variablesNumber].memoryUsage ();
+
+		// assume three pointers and a colour per tree node
+		const size_t nodeOverhead = 4 * sizeof (void *);
+		size_t bytes = sizeof (VariablesToFactListMap);
+		for (const auto & [key, facts] : factMap[actionIdx][preconditionIdx][variablesNumber])
+			bytes += nodeOverhead + sizeof (typename VariablesToFactListMap::value_type) + key.capacity () * sizeof (int) + facts.capacity () * sizeof (int);
+		return bytes;
+	}
+
+	/**
+	 * @brief Returns the number of bytes used by the fact index of the given action.
+	 */
+	size_t getFactIndexMemoryUsage (size_t actionIdx) const
+	{
+		size_t bytes = 0;
+		for (size_t preconditionIdx = 0; preconditionIdx < assignedVariablesSet[actionIdx].size (); preconditionIdx++)
+			for (size_t variablesNumber = 0; variablesNumber < assignedVariablesSet[actionIdx][preconditionIdx].size (); variablesNumber++)
+				bytes += getFactIndexMemoryUsage (actionIdx, preconditionIdx, variablesNumber);
+		for (const std::vector<TrieIndex> & preconditionTries : tries[actionIdx])
+			for (const TrieIndex & trie : preconditionTries)
+				bytes += trie.memoryUsage ();
+		for (const GpgStaticTable & staticTable : staticTables[actionIdx])
+			bytes += staticTable.table.memoryUsage ();
+		return bytes;
+	}
+
+	/**
+	 * @brief Returns whether the given Fact can be matched to the given precondition, i.e. whether it fits the sorts and repeated variables of the precondition.
+	 */
+	bool isCompatible (size_t actionIdx, size_t preconditionIdx, const typename InstanceType::StateType & stateElement) const
+	{
+		const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
+		const typename InstanceType::PreconditionType & precondition = action.getAntecedents ()[preconditionIdx];
+
+		assert (precondition.arguments.size () == stateElement.arguments.size ());
+
+		for (const std::vector<int> & identical_group : preprocessedDomain.identicalArgumentsByTaskAndPrecondition[actionIdx][preconditionIdx]){
+			int val = stateElement.arguments[identical_group[0]];
+			for (size_t i = 1; i < identical_group.size(); i++)
+				if (stateElement.arguments[identical_group[i]] != val)
+					return false;
+		}
+
+		// Skip this fact if its variables are incompatible with the sorts defined by the action
+		for (size_t argumentIdx = 0; argumentIdx < precondition.arguments.size (); ++argumentIdx)
+			if (!preprocessedDomain.domain.sorts[action.variableSorts[precondition.arguments[argumentIdx]]].contains (stateElement.arguments[argumentIdx]))
+				return false;
+
+		return true;
+	}
+
+	/**
+	 * @brief Inserts a Fact into the maps of all preconditions with the same predicate as the Fact.
+	 */
+	void insertState (const typename InstanceType::StateType * stateElement)
+	{
+		int stateElementIndex = addedStateElements.size();
+		addedStateElements.push_back(stateElement);
+
+		for (const auto & [actionIdx, preconditionIdx] : preprocessedDomain.preconditionsByPredicate[stateElement->getHeadNo ()])
+		{
+			const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
+			const typename InstanceType::PreconditionType & precondition = action.getAntecedents ()[preconditionIdx];
+
+			// static preconditions joined in a table are not matched against the fact index
+			if (staticTableOfPrecondition[actionIdx][preconditionIdx] != -1 || !isCompatible (actionIdx, preconditionIdx, *stateElement))
+				continue;
+
+			if (factCounts[actionIdx][preconditionIdx] == 0)
+				numberOfAntecedantsWithoutFact[actionIdx]--;
+			factCounts[actionIdx][preconditionIdx]++;
+
+			std::chrono::steady_clock::time_point insertStart;
+			if (measureTimes) insertStart = std::chrono::steady_clock::now ();
+
+			for (size_t variablesNumber = 0; variablesNumber < assignedVariablesSet[actionIdx][preconditionIdx].size(); variablesNumber++){
+				const std::set<int> & assignedVariables = assignedVariablesSet[actionIdx][preconditionIdx][variablesNumber];
+				std::vector<int> values;
+				for (size_t argumentIdx = 0; argumentIdx < precondition.arguments.size (); ++argumentIdx)
+				{
+					int var = precondition.arguments[argumentIdx];
+					int value = stateElement->arguments[argumentIdx];
+					// isCompatible() has already checked this value
+
+					if (assignedVariables.count(var)) values.push_back(value);
+				}
+			
+				if (useFlatFactIndex)
+					flatFactMap[actionIdx][preconditionIdx][variablesNumber].insert(values.data(), stateElementIndex);
+				else
+					factMap[actionIdx][preconditionIdx][variablesNumber][values].push_back(stateElementIndex);
+			}
+
+			for (size_t trieNumber = 0; trieNumber < tries[actionIdx][preconditionIdx].size (); trieNumber++)
+				insertIntoTrie (actionIdx, preconditionIdx, trieNumber, stateElementIndex);
+
+			if (measureTimes)
+				factIndexInsertTime[actionIdx] += std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - insertStart).count ();
+
+			if (! instance.pruneWithFutureSatisfiablility[actionIdx]) continue;
+			
+			insertIntoConsistencyTable (actionIdx, preconditionIdx, *stateElement);
+		}
+	}
+
+	/**
+	 * @brief Marks the given Fact as a potential future match of the given precondition of the given action in the consistency table.
+	 */
+	void insertIntoConsistencyTable (size_t actionIdx, int preconditionIdx, const typename InstanceType::StateType & stateElement)
+	{
+		const typename InstanceType::PreconditionType & precondition = instance.getAllActions ()[actionIdx].getAntecedents ()[preconditionIdx];
+
+		// mark as potential future precondition
+		for (int pastPreconditionIdx = -1; pastPreconditionIdx < preconditionIdx; pastPreconditionIdx++){
+			
+			// Ineligible initially matched precondition
+			std::vector<int> values;
+			for (size_t argumentIdx = 0; argumentIdx < precondition.arguments.size (); ++argumentIdx)
+			{
+				int var = precondition.arguments[argumentIdx];
+
+				// check whether this variable will already have been set by the past precondition
+				if (hasVariable(actionIdx,pastPreconditionIdx+1,-1,var))
+				{
+					values.push_back (stateElement.arguments[argumentIdx]);
+				}
+			}
+			consistency[actionIdx][pastPreconditionIdx+1][preconditionIdx][-1].insert(values);
+
+			if (!futureCachingByPrecondition) continue;	
+			// Eligible initially matched preconditions
+			for (int initiallyMatchedPreconditionIdx : eligibleInitialPreconditionsByAction[actionIdx])
+			{
+				std::vector<int> values;
+				for (size_t argumentIdx = 0; argumentIdx < precondition.arguments.size (); ++argumentIdx)
+				{
+					int var = precondition.arguments[argumentIdx];
+					if (hasVariable(actionIdx,pastPreconditionIdx+1,initiallyMatchedPreconditionIdx,var))
+					{
+						values.push_back (stateElement.arguments[argumentIdx]);
+					}
+				}
+
+				consistency[actionIdx][pastPreconditionIdx+1][preconditionIdx][initiallyMatchedPreconditionIdx].insert(values);
+			}
+		}
+	}
+
+	/**
+	 * @brief Returns the bytes used by the fact index tables that only serve eligible initially matched preconditions or non-ascending join plans of the given action.
+	 */
+	size_t getEligibleFactIndexMemoryUsage (size_t actionIdx) const
+	{
+		size_t bytes = 0;
+		for (size_t preconditionIdx = 0; preconditionIdx < assignedVariablesSet[actionIdx].size (); preconditionIdx++)
+			for (size_t variablesNumber = 1; variablesNumber < assignedVariablesSet[actionIdx][preconditionIdx].size (); variablesNumber++)
+				bytes += getFactIndexMemoryUsage (actionIdx, preconditionIdx, variablesNumber);
+		return bytes;
+	}
+
+	/**
+	 * @brief Makes all initially matched preconditions of the given action ineligible and frees the fact index tables only they used.
+	 *
+	 * getFacts() then uses the tables for "no initially matched precondition", which return more facts, but gpgMatchPrecondition()
+	 * checks every fact anyway. The join plans of the action become ascending for good. Must not be called while
+	 * gpgMatchPrecondition() is running, as it invalidates returned spans.
+	 */
+	void dropEligibleInitialPreconditions (size_t actionIdx)
+	{
+		assert (!matchingInParallel);
+		eligibleInitialPreconditionsByAction[actionIdx].clear ();
+		joinPlansFixed[actionIdx] = true;
+
+		for (size_t preconditionIdx = 0; preconditionIdx < assignedVariablesSet[actionIdx].size (); preconditionIdx++){
+			// the assignment without a matched precondition is always the first, and the only one still in use
+			std::map<int, int> & variablesNumbers = assignedVariablesByTaskAndPrecondition[actionIdx][preconditionIdx];
+			variablesNumbers = {{-1, variablesNumbers.at (-1)}};
+			assert (variablesNumbers.at (-1) == 0);
+			assignedVariablesSet[actionIdx][preconditionIdx].resize (1);
+
+			if (useFlatFactIndex)
+				flatFactMap[actionIdx][preconditionIdx].erase (flatFactMap[actionIdx][preconditionIdx].begin () + 1, flatFactMap[actionIdx][preconditionIdx].end ());
+			else
+				factMap[actionIdx][preconditionIdx].erase (factMap[actionIdx][preconditionIdx].begin () + 1, factMap[actionIdx][preconditionIdx].end ());
+		}
+
+		for (size_t initiallyMatchedPreconditionIdx = 0; initiallyMatchedPreconditionIdx < joinPlans[actionIdx].size (); initiallyMatchedPreconditionIdx++)
+			setAscendingJoinPlan (actionIdx, initiallyMatchedPreconditionIdx);
+	}
+
+	/**
+	 * @brief Returns the indices (in addedStateElements) of all Facts for the precondition matched in the given step of the join plan that are compatible with the given variable assignment.
+	 *
+	 * The returned span stays valid until the next call of insertState(). The parallel GPG calls this concurrently from several
+	 * threads, so this must not modify the index.
+	 */
+	std::span<const int> getFacts (size_t actionIdx, const GpgJoinPlan & joinPlan, size_t stepIdx, const VariableAssignment & assignedVariables) const
+	{
+		const typename InstanceType::PreconditionType & precondition = instance.getAllActions ()[actionIdx].getAntecedents ()[joinPlan.order[stepIdx]];
+
+		// Build the vector which is used as the key in the map. It is reused to avoid an allocation per call.
+		thread_local std::vector<int> assignedVariableValues;
+		assignedVariableValues.clear ();
+		for (int argIdx : joinPlan.keyArguments[stepIdx])
+		{
+			int var = precondition.arguments[argIdx];
+			assert (assignedVariables.isAssigned (var));
+			assignedVariableValues.push_back (assignedVariables[var]);
+		}
+
+		int variableID = joinPlan.variablesNumbers[stepIdx];
+
+		if (useFlatFactIndex)
+			return flatFactMap[actionIdx][joinPlan.order[stepIdx]][variableID].find (assignedVariableValues.data ());
+
+		const VariablesToFactListMap & factLists = factMap[actionIdx][joinPlan.order[stepIdx]][variableID];
+		auto factListIt = factLists.find (assignedVariableValues);
+		if (factListIt == factLists.end ())
+			return {};
+
+		return factListIt->second;
+	}
+
+	bool hasInstanceForAllAntecedants(size_t actionIdx, int initiallyMatchedPreconditionIdx){
+		if (numberOfAntecedantsWithoutFact[actionIdx] == 0) return true;
+		if (numberOfAntecedantsWithoutFact[actionIdx] >= 2) return false;
+
+		return factCounts[actionIdx][initiallyMatchedPreconditionIdx] == 0;
+	}
+
+
+
+	// precondition index may be -1 indicating that no precondition has been set yet, except for the initially matched one	
+	bool hasPotentiallyConsistentExtension (size_t actionIdx, size_t preconditionIdx, const VariableAssignment & assignedVariables, int initiallyMatchedPreconditionIdx){
 		// for testing: always disregard the initially matched Precondition
 
-		bool initiallyMatchedPreconditionIsEligible = preprocessedDomain.eligibleInitialPreconditionsByAction[actionIdx].count (initiallyMatchedPreconditionIdx) > 0;
+		bool initiallyMatchedPreconditionIsEligible = eligibleInitialPreconditionsByAction[actionIdx].count (initiallyMatchedPreconditionIdx) > 0;
 		if (!initiallyMatchedPreconditionIsEligible || !futureCachingByPrecondition)
 			initiallyMatchedPreconditionIdx = -1;
 	
@@ -616,7 +1237,7 @@ next_action:;
 			{
 				int var = futurePrecondition.arguments[argIdx];
 				// check whether the future precondition will have already been assigned
-				if (!(preprocessedDomain.hasVariable(actionIdx,preconditionIdx+1,initiallyMatchedPreconditionIdx,var)))
+				if (!(hasVariable(actionIdx,preconditionIdx+1,initiallyMatchedPreconditionIdx,var)))
 					continue;
 	
 				assert (assignedVariables.isAssigned (var));
@@ -624,7 +1245,9 @@ next_action:;
 				assignedVariableValues.push_back (assignedVariables[var]);
 			}
 			
-			if (consistency[actionIdx][preconditionIdx+1][futurePreconditionIdx][initiallyMatchedPreconditionIdx].count(assignedVariableValues) == 0){
+			const auto & consistencyByInitiallyMatched = consistency[actionIdx][preconditionIdx+1][futurePreconditionIdx];
+			auto consistentIt = consistencyByInitiallyMatched.find (initiallyMatchedPreconditionIdx);
+			if (consistentIt == consistencyByInitiallyMatched.end () || consistentIt->second.count(assignedVariableValues) == 0){
 				//std::cout << " -> reject " << std::endl;
 				return false;
 			}
@@ -635,8 +1258,37 @@ next_action:;
 	}
 
 
-	void dropConsistencyTable(){
-		consistency.clear();
+	/**
+	 * @brief Returns an estimate of the bytes used by the consistency table of the given action.
+	 */
+	size_t getConsistencyMemoryUsage (size_t actionIdx) const
+	{
+		if (actionIdx >= consistency.size ())
+			return 0;
+
+		// assume three pointers and a colour per tree node, and two pointers per hash node
+		const size_t treeNodeOverhead = 4 * sizeof (void *);
+		const size_t hashNodeOverhead = 2 * sizeof (void *);
+		size_t bytes = 0;
+		for (const auto & byFuturePrecondition : consistency[actionIdx])
+			for (const auto & byInitiallyMatched : byFuturePrecondition){
+				bytes += sizeof (byInitiallyMatched);
+				for (const auto & [initiallyMatchedPreconditionIdx, values] : byInitiallyMatched){
+					bytes += treeNodeOverhead + sizeof (std::pair<const int, std::unordered_set<std::vector<int>>>) + values.bucket_count () * sizeof (void *);
+					for (const std::vector<int> & value : values)
+						bytes += hashNodeOverhead + sizeof (std::vector<int>) + value.capacity () * sizeof (int);
+				}
+			}
+		return bytes;
+	}
+
+	/**
+	 * @brief Frees the consistency table of the given action. The future satisfiability check must already be disabled for it.
+	 */
+	void dropConsistencyTable (size_t actionIdx){
+		assert (!instance.pruneWithFutureSatisfiablility[actionIdx]);
+		if (actionIdx < consistency.size ())
+			std::vector<std::vector<std::map<int, std::unordered_set<std::vector<int>>>>> ().swap (consistency[actionIdx]);
 	}
 };
 
@@ -653,12 +1305,18 @@ struct GpgPlanningGraph
 	const Domain & domain;
 
 	const Problem & problem;
+
+	/// Owns the grounded tasks found by the GPG
+	ObjectPool<GroundedTask> & resultPool;
 	
 	bool allFutureSatisfiabilityDisabled = false;
 	std::vector<bool> pruneWithHierarchyTyping;
 	std::vector<bool> pruneWithFutureSatisfiablility;
 
-	GpgPlanningGraph (const Domain & domain, const Problem & problem) : domain (domain), problem (problem) {
+	/// Whether actions may be matched by gpgTriejoin()
+	static const bool triejoinSupported = true;
+
+	GpgPlanningGraph (const Domain & domain, const Problem & problem, ObjectPool<GroundedTask> & resultPool) : domain (domain), problem (problem), resultPool (resultPool) {
 		for (size_t i = 0; i < domain.nPrimitiveTasks; i++){
 			pruneWithFutureSatisfiablility.push_back(true);
 			pruneWithHierarchyTyping.push_back(true);
@@ -685,6 +1343,11 @@ struct GpgPlanningGraph
 		return it == problem.init.end();
 	}
 
+	ResultType * createResult (void) const
+	{
+		return resultPool.create ();
+	}
+
 	size_t getNumberOfActions (void) const
 	{
 		return domain.nPrimitiveTasks;
@@ -695,6 +1358,14 @@ struct GpgPlanningGraph
 		return domain.predicates.size ();
 	}
 
+	/**
+	 * @brief Returns whether no action changes the given predicate, see Domain#staticPredicates.
+	 */
+	bool isStaticPredicate (int predicateNo) const
+	{
+		return domain.staticPredicates[predicateNo];
+	}
+
 	const std::vector<ActionType> & getAllActions (void) const
 	{
 		return domain.tasks;
@@ -733,14 +1404,88 @@ extern std::map<int,double> liftedGroundingTime;
 extern std::map<int,double> instantiationtime;
 extern std::map<int,double> instantiationtime2;
 
+/**
+ * @brief Numbers the results output[firstNewResult..] and registers their add effects as (possibly new) state elements.
+ *
+ * New state elements are numbered consecutively and appended to the queue. The numbering thus only depends on the order of the
+ * results in output, which allows the parallel GPG to produce exactly the same numbering as the sequential one.
+ */
 template <GpgInstance InstanceType>
-static void gpgAssignVariables (
+void gpgRegisterResults (
 	const InstanceType & instance,
-	const HierarchyTyping * hierarchyTyping,
 	std::vector<typename InstanceType::ResultType *> & output,
+	size_t firstNewResult,
 	std::queue<typename std::unordered_set<typename InstanceType::StateType>::const_iterator> & toBeProcessedQueue,
 	std::unordered_set<typename InstanceType::StateType> & toBeProcessedSet,
-	const GpgLiteralSet<typename InstanceType::StateType> & processedStates,
+	const GpgLiteralSet<typename InstanceType::StateType> & processedStates
+)
+{
+	for (size_t resultIdx = firstNewResult; resultIdx < output.size (); ++resultIdx)
+	{
+		typename InstanceType::ResultType * result = output[resultIdx];
+		int actionNo = result->getHeadNo ();
+		const typename InstanceType::ActionType & action = instance.getAllActions ()[actionNo];
+
+		liftedGroundingCount[actionNo]++;
+		result->groundedNo = resultIdx;
+
+		// Add "add" effects from this action to our known facts
+		for (const typename InstanceType::PreconditionType & addEffect : action.getConsequences ())
+		{
+			
+			typename InstanceType::StateType addState;
+			addState.setHeadNo (addEffect.getHeadNo ());
+			for (int varIdx : addEffect.arguments)
+			{
+				addState.arguments.push_back (result->arguments[varIdx]);
+			}
+
+			// Check if we already know this fact
+			bool found = false;
+			typename std::unordered_set<typename InstanceType::StateType>::const_iterator factIt;
+			if ((factIt = processedStates.find (addState)) != processedStates.end (addEffect.getHeadNo ()))
+			{
+				addState = *factIt;
+				found = true;
+			}
+			else if ((factIt = toBeProcessedSet.find (addState)) != toBeProcessedSet.end ())
+			{
+				addState = *factIt;
+				found = true;
+			}
+
+			// If we already processed this fact, don't add it again
+			if (!found)
+			{
+				// New state element; give it a number
+				addState.groundedNo = processedStates.size () + toBeProcessedSet.size ();
+
+				DEBUG(std::cout << "New Fact " << addState.groundedNo << ": " << addEffect.getHeadNo();
+				for (int varIdx : addEffect.arguments) std::cout << " " << result->arguments[varIdx];
+				std::cout << std::endl;
+				);
+
+
+				auto [it,_] = toBeProcessedSet.insert (addState);
+				toBeProcessedQueue.push (it);
+			}
+
+			// Add this add effect to the list of add effects of the result we created
+			result->groundedAddEffects.push_back (addState.groundedNo);
+		}
+	}
+}
+
+/**
+ * @brief Assigns all variables that are not determined by the matched preconditions and appends the resulting groundings to output.
+ *
+ * The results are neither numbered nor are their add effects known yet; this is done by gpgRegisterResults().
+ */
+template <GpgInstance InstanceType>
+static void gpgAssignVariables (
+	const InstanceType & instance,
+	const HierarchyTyping * hierarchyTyping,
+	std::vector<typename InstanceType::ResultType *> & output,
 	int actionNo,
 	VariableAssignment & assignedVariables,
 	std::vector<int> & matchedPreconditions,
@@ -748,7 +1493,7 @@ static void gpgAssignVariables (
 )
 {
 	const Domain & domain = instance.domain;
-	const typename InstanceType::ActionType action = instance.getAllActions ()[actionNo];
+	const typename InstanceType::ActionType & action = instance.getAllActions ()[actionNo];
 
 	assert (actionNo < instance.getNumberOfActions ());
 
@@ -782,18 +1527,11 @@ static void gpgAssignVariables (
 
 		DEBUG (std::cerr << "Found grounded action for action [" << action.name << "]." << std::endl);
 
-		liftedGroundingCount[actionNo]++;
-
 		// Create and return grounded action
-		typename InstanceType::ResultType * result = new typename InstanceType::ResultType();
-		result->groundedNo = output.size ();
+		typename InstanceType::ResultType * result = instance.createResult ();
 		result->setHeadNo (actionNo);
 		result->arguments = assignedVariables;
-
-		// XXX TODO: insert vector as subtasks of result
-		// XXX TODO: insert ground preconditions and add effects
 		result->groundedPreconditions = matchedPreconditions;
-		// Still anything TODO?
 		
 		DEBUG(
 			std::cout << "  Arguments:";
@@ -803,95 +1541,99 @@ static void gpgAssignVariables (
 			for (int p : result->groundedPreconditions) std::cout << " " << p;
 			std::cout << std::endl;
 							);
-		
-		// Add "add" effects from this action to our known facts
-		for (const typename InstanceType::PreconditionType & addEffect : action.getConsequences ())
-		{
-			
-			typename InstanceType::StateType addState;
-			addState.setHeadNo (addEffect.getHeadNo ());
-			for (int varIdx : addEffect.arguments)
-			{
-				assert (assignedVariables.isAssigned (varIdx));
-				addState.arguments.push_back (assignedVariables[varIdx]);
-			}
-
-			//std::clock_t cc_begin = std::clock();
-			// Check if we already know this fact
-			bool found = false;
-			typename std::unordered_set<typename InstanceType::StateType>::const_iterator factIt;
-			if ((factIt = processedStates.find (addState)) != processedStates.end (addEffect.getHeadNo ()))
-			{
-				addState = *factIt;
-				found = true;
-			}
-			else if ((factIt = toBeProcessedSet.find (addState)) != toBeProcessedSet.end ())
-			{
-				addState = *factIt;
-				found = true;
-			}
-			//std::clock_t cc_end = std::clock();
-			//double time_elapsed_ms = 1000.0 * (cc_end-cc_begin) / CLOCKS_PER_SEC;
-			//instantiationtime2[actionNo] += time_elapsed_ms;
 
-			// If we already processed this fact, don't add it again
-			if (!found)
-			{
-				// New state element; give it a number
-				addState.groundedNo = processedStates.size () + toBeProcessedSet.size ();
+		output.push_back (result);
 
-				DEBUG(std::cout << "New Fact " << addState.groundedNo << ": " << addEffect.getHeadNo();
-				for (int varIdx : addEffect.arguments) std::cout << " " << assignedVariables[varIdx];
-				std::cout << std::endl;
-				);
+		return;
+	}
 
-
-				auto [it,_] = toBeProcessedSet.insert (addState);
-				toBeProcessedQueue.push (it);
-			}
-
-			// Add this add effect to the list of add effects of the result we created
-			result->groundedAddEffects.push_back (addState.groundedNo);
-		}
-
-		output.push_back (result);
-
-		return;
-	}
-
-	if (assignedVariables.isAssigned (variableIdx))
-	{
-		// Variable is already assigned
-		gpgAssignVariables (instance, hierarchyTyping, output, toBeProcessedQueue, toBeProcessedSet, processedStates, actionNo, assignedVariables, matchedPreconditions, variableIdx + 1);
-		return;
-	}
+	if (assignedVariables.isAssigned (variableIdx))
+	{
+		// Variable is already assigned
+		gpgAssignVariables (instance, hierarchyTyping, output, actionNo, assignedVariables, matchedPreconditions, variableIdx + 1);
+		return;
+	}
 
 	int variableSort = action.variableSorts[variableIdx];
 	for (int sortMember : domain.sorts[variableSort].members)
 	{
 		assignedVariables[variableIdx] = sortMember;
-		gpgAssignVariables (instance, hierarchyTyping, output, toBeProcessedQueue, toBeProcessedSet, processedStates, actionNo, assignedVariables, matchedPreconditions, variableIdx + 1);
+		gpgAssignVariables (instance, hierarchyTyping, output, actionNo, assignedVariables, matchedPreconditions, variableIdx + 1);
 	}
 	assignedVariables.erase (variableIdx);
 }
 
-extern size_t totalFactTests;
-extern std::vector<std::vector<std::vector<size_t>>> factTests;
-extern size_t totalFactHits;
-extern std::vector<std::vector<std::vector<size_t>>> factHits;
-extern std::vector<std::vector<std::vector<size_t>>> factFutureRejects;
-extern std::vector<std::vector<std::vector<size_t>>> noextensionFound;
+/**
+ * @brief Counters collected by gpgMatchPrecondition().
+ *
+ * The sequential GPG counts into the global gpgMatchStatistics. Every worker of the parallel GPG counts into its own instance,
+ * which is added to the global one after each batch.
+ */
+struct GpgMatchStatistics
+{
+	size_t totalFactTests = 0;
+	size_t totalFactHits = 0;
 
-extern std::vector<size_t> futureReject;
-extern std::vector<size_t> futureTests;
-extern std::vector<size_t> htReject;
-extern std::vector<size_t> htTests;
+	/**
+	 * @brief Per action, precondition, and initially matched precondition.
+	 */
+	std::vector<std::vector<std::vector<size_t>>> factTests;
+	std::vector<std::vector<std::vector<size_t>>> factHits;
+	std::vector<std::vector<std::vector<size_t>>> factFutureRejects;
+	std::vector<std::vector<std::vector<size_t>>> noextensionFound;
+
+	/**
+	 * @brief Per action.
+	 */
+	std::vector<size_t> futureReject;
+	std::vector<size_t> futureTests;
+	std::vector<size_t> htReject;
+	std::vector<size_t> htTests;
+	/// Time in ms spent in GpgStateMap::getFacts(); only measured with --print-timings
+	std::vector<double> factLookupTime;
+
+	/**
+	 * @brief Sets all counters to zero and sizes them for the given instance.
+	 */
+	template<GpgInstance InstanceType>
+	void reset (const InstanceType & instance)
+	{
+		size_t numberOfActions = instance.getNumberOfActions ();
+		totalFactTests = 0;
+		totalFactHits = 0;
+		futureReject.assign (numberOfActions, 0);
+		futureTests.assign (numberOfActions, 0);
+		htReject.assign (numberOfActions, 0);
+		htTests.assign (numberOfActions, 0);
+		factLookupTime.assign (numberOfActions, 0);
+
+		factTests.assign (numberOfActions, {});
+		factHits.assign (numberOfActions, {});
+		factFutureRejects.assign (numberOfActions, {});
+		noextensionFound.assign (numberOfActions, {});
+		for (size_t i = 0; i < numberOfActions; ++i){
+			size_t numberOfPreconditions = instance.getAllActions ()[i].getAntecedents ().size ();
+			factTests[i].assign (numberOfPreconditions, std::vector<size_t> (numberOfPreconditions));
+			factHits[i].assign (numberOfPreconditions, std::vector<size_t> (numberOfPreconditions));
+			factFutureRejects[i].assign (numberOfPreconditions, std::vector<size_t> (numberOfPreconditions));
+			noextensionFound[i].assign (numberOfPreconditions, std::vector<size_t> (numberOfPreconditions));
+		}
+	}
+
+	/**
+	 * @brief Adds the counters of other to this one and sets those of other to zero. Both must have been reset for the same instance.
+	 */
+	void moveFrom (GpgMatchStatistics & other);
+};
+
+extern GpgMatchStatistics gpgMatchStatistics;
 
 template<GpgInstance InstanceType>
-void printStatistics(const InstanceType & instance){
+void printStatistics(const InstanceType & instance, const GpgStateMap<InstanceType> & stateMap){
 	//bool outputPerPrec = true;
 	std::cerr << "========================================" << std::endl;
-	std::cerr << "Total fact misses: " << (totalFactTests - totalFactHits) << " / " << totalFactTests << " = " << std::fixed << std::setprecision (3) << 100.0 * (totalFactTests - totalFactHits) / totalFactTests << " % (" << totalFactHits << " hits)" << std::endl;
+	const GpgMatchStatistics & statistics = gpgMatchStatistics;
+	std::cerr << "Total fact misses: " << (statistics.totalFactTests - statistics.totalFactHits) << " / " << statistics.totalFactTests << " = " << std::fixed << std::setprecision (3) << 100.0 * (statistics.totalFactTests - statistics.totalFactHits) / statistics.totalFactTests << " % (" << statistics.totalFactHits << " hits)" << std::endl;
 	//for (size_t i = 0; i < instance.getNumberOfActions (); ++i)
 	//{
 	//	//if (i != 2) continue;
@@ -952,6 +1694,19 @@ void printStatistics(const InstanceType & instance){
 	}
 	std::cerr << "  total: " << total << std::endl;
 
+	size_t totalBytes = 0;
+	double totalInsertTime = 0;
+	double totalLookupTime = 0;
+	std::cerr << "Fact Index (" << (stateMap.useFlatFactIndex ? "flat" : "map") << "): memory [KiB], insert time [ms], lookup time [ms]" << std::endl;
+	for (size_t actionIdx = 0; actionIdx < instance.getNumberOfActions (); ++actionIdx) {
+		size_t bytes = stateMap.getFactIndexMemoryUsage(actionIdx);
+		std::cerr << "  " << instance.getAllActions()[actionIdx].name << " " << bytes / 1024 << " " << stateMap.factIndexInsertTime[actionIdx] << " " << gpgMatchStatistics.factLookupTime[actionIdx] << std::endl;
+		totalBytes += bytes;
+		totalInsertTime += stateMap.factIndexInsertTime[actionIdx];
+		totalLookupTime += gpgMatchStatistics.factLookupTime[actionIdx];
+	}
+	std::cerr << "  total: " << totalBytes / 1024 << " " << totalInsertTime << " " << totalLookupTime << std::endl;
+
 	std::cerr << "Instantiaton Time: " << std::endl;
 	for (auto g : instantiationtime)
 		std::cerr << "  " << instance.getAllActions()[g.first].name << " " << g.second << std::endl;
@@ -960,29 +1715,465 @@ void printStatistics(const InstanceType & instance){
 		std::cerr << "  " << instance.getAllActions()[g.first].name << " " << g.second << std::endl;
 }
 
+/**
+ * @brief Keeps the memory usage of the GPG below the memory limit by dropping data structures that only speed up grounding.
+ *
+ * The results and the fact index for "no initially matched precondition" are needed and only accounted for. Everything else is
+ * dropped in three tiers, one action at a time, until the estimated savings cover the excess memory:
+ *  1. the consistency table of the future satisfiability check
+ *  2. the fact index tables for eligible initially matched preconditions and non-ascending join plans
+ *  3. the splitted possible constants of the hierarchy typing
+ * Within a tier, the structure that did the least work per byte (rejects, fact hits, or hierarchy typing tests) is dropped first.
+ */
+template<GpgInstance InstanceType>
+struct GpgMemoryController
+{
+	/**
+	 * @brief The memory limit in bytes, 0 if there is none.
+	 */
+	size_t limit;
+
+	/**
+	 * @brief The number of fact tests when the memory usage was last checked.
+	 */
+	size_t factTestsAtLastCheck = 0;
+
+	/**
+	 * @brief Whether everything that can be dropped has been dropped.
+	 */
+	bool exhausted = false;
+
+	GpgMemoryController (const grounding_configuration & config) : limit (size_t (config.memoryLimit) * 1024 * 1024)
+	{
+	}
+
+	/**
+	 * @brief Calls check() if at least 1000 facts have been tested since the last check.
+	 */
+	void checkPeriodically (const InstanceType & instance, GpgStateMap<InstanceType> & stateMap, const HierarchyTyping * hierarchyTyping,
+			const GpgMatchStatistics & statistics, const std::vector<typename InstanceType::ResultType *> & output, grounding_configuration & config)
+	{
+		if (statistics.totalFactTests - factTestsAtLastCheck < 1000)
+			return;
+
+		check (instance, stateMap, hierarchyTyping, statistics, output, config);
+	}
+
+	/**
+	 * @brief Drops data structures if the memory limit is exceeded. Must not be called while gpgMatchPrecondition() is running.
+	 */
+	void check (const InstanceType & instance, GpgStateMap<InstanceType> & stateMap, const HierarchyTyping * hierarchyTyping,
+			const GpgMatchStatistics & statistics, const std::vector<typename InstanceType::ResultType *> & output, grounding_configuration & config)
+	{
+		factTestsAtLastCheck = statistics.totalFactTests;
+		if (limit == 0 || exhausted)
+			return;
+
+		size_t currentRSS = getCurrentRSS();
+		if (currentRSS < limit)
+			return;
+
+		const size_t MiB = 1024 * 1024;
+		if (!config.quietMode){
+			size_t consistencyBytes = 0;
+			size_t factIndexBytes = 0;
+			for (size_t actionIdx = 0; actionIdx < instance.getNumberOfActions (); ++actionIdx){
+				consistencyBytes += stateMap.getConsistencyMemoryUsage (actionIdx);
+				factIndexBytes += stateMap.getFactIndexMemoryUsage (actionIdx);
+			}
+			size_t outputBytes = output.capacity () * sizeof (typename InstanceType::ResultType *);
+			for (const typename InstanceType::ResultType * result : output)
+				outputBytes += sizeof (*result) + (result->arguments.capacity () + result->groundedPreconditions.capacity () + result->groundedAddEffects.capacity ()) * sizeof (int);
+
+			std::cerr << "Memory usage of " << currentRSS / MiB << " MiB exceeds the limit of " << limit / MiB << " MiB (consistency tables: " << consistencyBytes / MiB
+				<< " MiB, fact index: " << factIndexBytes / MiB << " MiB, hierarchy typing: " << (hierarchyTyping ? hierarchyTyping->getMemoryUsage () : 0) / MiB
+				<< " MiB, results: " << outputBytes / MiB << " MiB)" << std::endl;
+		}
+
+		// aim a bit below the limit, so that we don't have to drop something again right away
+		size_t toBeReclaimed = currentRSS - limit + limit / 10;
+		size_t reclaimed = 0;
+
+		for (int tier = 1; tier <= 3 && reclaimed < toBeReclaimed; tier++){
+			// benefit per byte, bytes, action
+			std::vector<std::tuple<double, size_t, size_t>> candidates;
+			for (size_t actionIdx = 0; actionIdx < instance.getNumberOfActions (); ++actionIdx){
+				size_t bytes = 0;
+				double benefit = 0;
+				if (tier == 1 && instance.pruneWithFutureSatisfiablility[actionIdx]){
+					bytes = stateMap.getConsistencyMemoryUsage (actionIdx);
+					benefit = statistics.futureReject[actionIdx];
+				} else if (tier == 2 && !stateMap.joinPlansFixed[actionIdx]){
+					bytes = stateMap.getEligibleFactIndexMemoryUsage (actionIdx);
+					for (const auto & hitsByInitiallyMatched : statistics.factHits[actionIdx])
+						benefit += std::accumulate (hitsByInitiallyMatched.begin (), hitsByInitiallyMatched.end (), size_t (0));
+				} else if (tier == 3 && hierarchyTyping != nullptr){
+					bytes = hierarchyTyping->getSplittedMemoryUsage<typename InstanceType::ActionType> (actionIdx);
+					benefit = statistics.htTests[actionIdx];
+				}
+
+				if (bytes > 0)
+					candidates.push_back (std::make_tuple (benefit / bytes, bytes, actionIdx));
+			}
+			std::sort (candidates.begin (), candidates.end ());
+
+			for (const auto & [benefitPerByte, bytes, actionIdx] : candidates){
+				if (reclaimed >= toBeReclaimed)
+					break;
+
+				std::string what;
+				if (tier == 1){
+					const_cast<InstanceType &>(instance).disablePruneWithFutureSatisfiablility (actionIdx);
+					stateMap.dropConsistencyTable (actionIdx);
+					what = "consistency table";
+				} else if (tier == 2){
+					stateMap.dropEligibleInitialPreconditions (actionIdx);
+					what = "fact index for initially matched preconditions";
+				} else {
+					const_cast<HierarchyTyping *>(hierarchyTyping)->dropSplitted<typename InstanceType::ActionType> (actionIdx);
+					what = "splitted hierarchy typing";
+				}
+				reclaimed += bytes;
+
+				if (!config.quietMode)
+					std::cerr << " ---> Dropping " << what << " of action " << actionIdx << " (" << instance.getAllActions ()[actionIdx].name << "), reclaiming " << bytes / 1024 << " KiB" << std::endl;
+			}
+		}
+
+#ifdef __GLIBC__
+		// give the freed memory back to the operating system, otherwise the RSS does not change
+		malloc_trim (0);
+#endif
+
+		if (reclaimed < toBeReclaimed)
+			exhausted = true;
+
+		if (!config.quietMode){
+			std::cerr << "Reclaimed about " << reclaimed / MiB << " MiB, memory usage is now " << getCurrentRSS () / MiB << " MiB." << std::endl;
+			if (exhausted)
+				std::cerr << "Nothing left to drop, continuing above the memory limit." << std::endl;
+		}
+	}
+};
+
+/**
+ * @brief Chooses the join plan of every action and initially matched precondition from the statistics collected so far.
+ *
+ * The preconditions are ordered greedily: the next one is the one with the fewest expected matches given the variables assigned
+ * by the ones before. The expected matches of a precondition are the facts compatible with it, divided by the number of keys of
+ * its fact index (or by the sizes of the sorts of the key variables if there is no such index yet), times its hit rate.
+ * A non-ascending order is only used if it is expected to test less than half the partial groundings of the ascending order,
+ * since it needs additional fact index tables and can't use the future satisfiability check.
+ *
+ * A plan is made again once the number of facts of one of the preconditions has doubled since it was made.
+ */
+template<GpgInstance InstanceType>
+struct GpgJoinPlanner
+{
+	/**
+	 * @brief Whether plans are made at all. If not, all plans stay ascending.
+	 */
+	bool enabled;
+
+	/**
+	 * @brief The number of fact tests when the plans were last checked.
+	 */
+	size_t factTestsAtLastCheck = 0;
+
+	/**
+	 * @brief The number of times a plan changed its order.
+	 */
+	size_t numberOfChangedPlans = 0;
+
+	GpgJoinPlanner (const grounding_configuration & config) : enabled (config.joinPlanner)
+	{
+	}
+
+	/**
+	 * @brief Calls check() if at least 1000 facts have been tested since the last check.
+	 */
+	void checkPeriodically (const InstanceType & instance, GpgStateMap<InstanceType> & stateMap, const GpgMatchStatistics & statistics, grounding_configuration & config)
+	{
+		if (!enabled || statistics.totalFactTests - factTestsAtLastCheck < 1000)
+			return;
+
+		check (instance, stateMap, statistics, config);
+	}
+
+	/**
+	 * @brief Makes all plans again whose statistics have drifted. Must not be called while gpgMatchPrecondition() is running.
+	 */
+	void check (const InstanceType & instance, GpgStateMap<InstanceType> & stateMap, const GpgMatchStatistics & statistics, grounding_configuration & config)
+	{
+		factTestsAtLastCheck = statistics.totalFactTests;
+		if (!enabled)
+			return;
+
+		for (size_t actionIdx = 0; actionIdx < instance.getNumberOfActions (); ++actionIdx){
+			// with less than three preconditions, there is nothing to order
+			size_t numberOfPreconditions = instance.getAllActions ()[actionIdx].getAntecedents ().size ();
+			if (numberOfPreconditions < 3 || stateMap.joinPlansFixed[actionIdx] || stateMap.matchWithTriejoin[actionIdx] || stateMap.numberOfAntecedantsWithoutFact[actionIdx] > 0)
+				continue;
+
+			for (size_t initiallyMatchedPreconditionIdx = 0; initiallyMatchedPreconditionIdx < numberOfPreconditions; initiallyMatchedPreconditionIdx++){
+				const GpgJoinPlan & joinPlan = stateMap.joinPlans[actionIdx][initiallyMatchedPreconditionIdx];
+				if (!hasDrifted (joinPlan.plannedFactCounts, stateMap.factCounts[actionIdx]))
+					continue;
+
+				std::vector<int> previousOrder = joinPlan.order;
+				std::vector<int> order = chooseOrder (instance, stateMap, statistics, actionIdx, initiallyMatchedPreconditionIdx);
+				stateMap.setJoinPlan (actionIdx, initiallyMatchedPreconditionIdx, order);
+				if (order == previousOrder)
+					continue;
+
+				numberOfChangedPlans++;
+				if (!config.quietMode && config.printTimings){
+					std::cerr << " ---> Join plan of action " << actionIdx << " (" << instance.getAllActions ()[actionIdx].name << ") for initially matched precondition " << initiallyMatchedPreconditionIdx << ":";
+					for (int preconditionIdx : order)
+						std::cerr << " " << preconditionIdx;
+					std::cerr << std::endl;
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Returns whether the number of facts of a precondition has doubled (plus some slack for small numbers) since the plan was made.
+	 */
+	static bool hasDrifted (const std::vector<size_t> & plannedFactCounts, const std::vector<size_t> & factCounts)
+	{
+		if (plannedFactCounts.empty ())
+			return true;
+
+		for (size_t preconditionIdx = 0; preconditionIdx < factCounts.size (); preconditionIdx++)
+			if (factCounts[preconditionIdx] >= 2 * plannedFactCounts[preconditionIdx] + 64)
+				return true;
+		return false;
+	}
+
+	/**
+	 * @brief Returns the expected number of facts that match the given precondition when the given variables are assigned.
+	 */
+	static double getExpectedMatches (const InstanceType & instance, const GpgStateMap<InstanceType> & stateMap, const GpgMatchStatistics & statistics,
+			size_t actionIdx, size_t initiallyMatchedPreconditionIdx, size_t preconditionIdx, const std::set<int> & assignedVariables)
+	{
+		const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
+		double expectedMatches = stateMap.factCounts[actionIdx][preconditionIdx];
+
+		std::vector<int> keyArguments = stateMap.getKeyArguments (actionIdx, preconditionIdx, assignedVariables);
+		if (!keyArguments.empty ()){
+			int variablesNumber = stateMap.findFactIndex (actionIdx, preconditionIdx, keyArguments);
+			size_t numberOfKeys = variablesNumber == -1 ? 0 : stateMap.numberOfFactIndexKeys (actionIdx, preconditionIdx, variablesNumber);
+			if (numberOfKeys > 0)
+				expectedMatches /= numberOfKeys;
+			else {
+				std::set<int> keyVariables;
+				for (int argIdx : keyArguments)
+					keyVariables.insert (action.getAntecedents ()[preconditionIdx].arguments[argIdx]);
+				for (int var : keyVariables)
+					expectedMatches /= std::max<size_t> (instance.domain.sorts[action.variableSorts[var]].members.size (), 1);
+			}
+		}
+
+		size_t factTests = statistics.factTests[actionIdx][preconditionIdx][initiallyMatchedPreconditionIdx];
+		if (factTests >= 100)
+			expectedMatches *= double (statistics.factHits[actionIdx][preconditionIdx][initiallyMatchedPreconditionIdx]) / factTests;
+
+		return expectedMatches;
+	}
+
+	/**
+	 * @brief Returns the order in which the preconditions of the given action are matched for the given initially matched precondition.
+	 */
+	static std::vector<int> chooseOrder (const InstanceType & instance, const GpgStateMap<InstanceType> & stateMap, const GpgMatchStatistics & statistics,
+			size_t actionIdx, size_t initiallyMatchedPreconditionIdx)
+	{
+		const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
+		std::set<int> initiallyAssignedVariables;
+		if (stateMap.eligibleInitialPreconditionsByAction[actionIdx].count (initiallyMatchedPreconditionIdx)){
+			const typename InstanceType::PreconditionType & initiallyMatchedPrecondition = action.getAntecedents ()[initiallyMatchedPreconditionIdx];
+			initiallyAssignedVariables.insert (initiallyMatchedPrecondition.arguments.begin (), initiallyMatchedPrecondition.arguments.end ());
+		}
+
+		// the cost of an order is the expected number of partial groundings it tests
+		auto getCost = [&] (const std::vector<int> & order)
+		{
+			std::set<int> assignedVariables = initiallyAssignedVariables;
+			double partialGroundings = 1;
+			double cost = 0;
+			for (int preconditionIdx : order){
+				partialGroundings *= getExpectedMatches (instance, stateMap, statistics, actionIdx, initiallyMatchedPreconditionIdx, preconditionIdx, assignedVariables);
+				cost += partialGroundings;
+				assignedVariables.insert (action.getAntecedents ()[preconditionIdx].arguments.begin (), action.getAntecedents ()[preconditionIdx].arguments.end ());
+			}
+			return cost;
+		};
+
+		std::vector<int> ascendingOrder;
+		for (size_t preconditionIdx = 0; preconditionIdx < action.getAntecedents ().size (); preconditionIdx++)
+			if (preconditionIdx != initiallyMatchedPreconditionIdx)
+				ascendingOrder.push_back (preconditionIdx);
+
+		std::vector<int> greedyOrder;
+		std::vector<int> remaining = ascendingOrder;
+		std::set<int> assignedVariables = initiallyAssignedVariables;
+		while (!remaining.empty ()){
+			// ties are broken in favour of the precondition that comes first
+			size_t bestIdx = 0;
+			double bestExpectedMatches = 0;
+			for (size_t remainingIdx = 0; remainingIdx < remaining.size (); remainingIdx++){
+				double expectedMatches = getExpectedMatches (instance, stateMap, statistics, actionIdx, initiallyMatchedPreconditionIdx, remaining[remainingIdx], assignedVariables);
+				if (remainingIdx == 0 || expectedMatches < bestExpectedMatches){
+					bestIdx = remainingIdx;
+					bestExpectedMatches = expectedMatches;
+				}
+			}
+
+			int preconditionIdx = remaining[bestIdx];
+			greedyOrder.push_back (preconditionIdx);
+			remaining.erase (remaining.begin () + bestIdx);
+			assignedVariables.insert (action.getAntecedents ()[preconditionIdx].arguments.begin (), action.getAntecedents ()[preconditionIdx].arguments.end ());
+		}
+
+		if (2 * getCost (greedyOrder) < getCost (ascendingOrder))
+			return greedyOrder;
+		return ascendingOrder;
+	}
+};
+
+/**
+ * @brief Disables the future satisfiability check (and potentially the hierarchy typing check) for an action if it rarely prunes anything.
+ *
+ * The decision needs at least 100 tests.
+ */
+template<GpgInstance InstanceType>
+void gpgCheckPruningUsefulness (const InstanceType & instance, GpgStateMap<InstanceType> & stateMap, const GpgMatchStatistics & statistics, size_t actionNo, grounding_configuration & config)
+{
+	if (statistics.futureTests[actionNo] >= 100){
+		const auto & action = instance.getAllActions()[actionNo];
+		if (instance.pruneWithFutureSatisfiablility[actionNo] && statistics.futureReject[actionNo] < statistics.futureTests[actionNo] / 10){
+			const_cast<InstanceType &>(instance).disablePruneWithFutureSatisfiablility(actionNo);
+			stateMap.dropConsistencyTable(actionNo);
+			if (!config.quietMode)
+			   	std::cerr << " ---> Disabling potentially consistent extension checking for action:           " << actionNo << " (" << action.name << ")" << std::endl;
+		}
+	}
+
+
+
+	if (false && statistics.htTests[actionNo] >= 100){
+		const auto & action = instance.getAllActions()[actionNo];
+		if (instance.pruneWithHierarchyTyping[actionNo] && statistics.htReject[actionNo] < statistics.htTests[actionNo] / 10){
+			const_cast<InstanceType &>(instance).disablePruneWithHierarchyTyping(actionNo);
+			if (!config.quietMode)
+			   	std::cerr << " ---> Disabling hierarchy typing checking during match precondition for action: " << actionNo << " (" << action.name << ")" << std::endl;
+		}
+	}
+}
+
+/**
+ * @brief Probes the static table of the given step of the join plan with the assigned variables and calls extend for every row that fits them.
+ *
+ * While extend runs, the variables of the table are assigned and the static preconditions joined in it are matched. The rows
+ * already fit the sorts and the variable constraints among the variables of the table, so only the other constraints and the
+ * hierarchy typing are checked here.
+ */
+template<GpgInstance InstanceType, typename Extend>
+void gpgProbeStaticTable (
+	const InstanceType & instance,
+	const HierarchyTyping * hierarchyTyping,
+	const GpgStateMap<InstanceType> & stateMap,
+	size_t actionNo,
+	VariableAssignment & assignedVariables,
+	std::vector<int> & matchedPreconditions,
+	const GpgJoinPlan & joinPlan,
+	size_t stepIdx,
+	GpgMatchStatistics & statistics,
+	Extend extend
+)
+{
+	const typename InstanceType::ActionType & action = instance.getAllActions ()[actionNo];
+	const GpgStaticTable & staticTable = stateMap.staticTables[actionNo][joinPlan.staticTableNumbers[stepIdx]];
+
+	// The assigned variables of the table are exactly those the index is keyed by, see GpgStateMap::addStaticTableSteps()
+	std::vector<int> key;
+	std::vector<int> newlyAssignedColumns;
+	for (size_t column = 0; column < staticTable.variables.size (); column++)
+	{
+		if (assignedVariables.isAssigned (staticTable.variables[column]))
+			key.push_back (assignedVariables[staticTable.variables[column]]);
+		else
+			newlyAssignedColumns.push_back (column);
+	}
+
+	for (int rowIdx : staticTable.table.find (joinPlan.variablesNumbers[stepIdx], key.data ()))
+	{
+		const int * row = staticTable.table.row (rowIdx);
+		for (int column : newlyAssignedColumns)
+			assignedVariables[staticTable.variables[column]] = row[column];
+
+		bool rowMatches = true;
+		for (const VariableConstraint & constraint : action.variableConstraints)
+		{
+			if (!rowMatches || !assignedVariables.isAssigned (constraint.var1) || !assignedVariables.isAssigned (constraint.var2))
+				continue;
+
+			bool equal = assignedVariables[constraint.var1] == assignedVariables[constraint.var2];
+			rowMatches = equal == (constraint.type == VariableConstraint::Type::EQUAL);
+		}
+
+		if (rowMatches && !newlyAssignedColumns.empty () && instance.pruneWithHierarchyTyping[actionNo] && hierarchyTyping != nullptr){
+			statistics.htTests[actionNo]++;
+			if (!hierarchyTyping->isAssignmentCompatible<typename InstanceType::ActionType> (actionNo, assignedVariables)){
+				rowMatches = false;
+				statistics.htReject[actionNo]++;
+			}
+		}
+
+		if (rowMatches)
+		{
+			for (size_t tableIdx = 0; tableIdx < staticTable.preconditions.size (); tableIdx++)
+				matchedPreconditions[staticTable.preconditions[tableIdx]] = row[staticTable.variables.size () + tableIdx];
+			extend ();
+		}
+	}
+
+	for (int column : newlyAssignedColumns)
+		assignedVariables.erase (staticTable.variables[column]);
+}
+
+/**
+ * @brief Matches the preconditions of an action in the order of joinPlan, starting at stepIdx, and appends all resulting groundings to output.
+ *
+ * Only state elements that are not numbered higher than initiallyMatchedState are used. The sequential GPG never has any such
+ * elements in the state map, the parallel one inserts a whole batch before matching.
+ *
+ * Workers of the parallel GPG set inParallelWorker. They must neither change the instance nor the state map, so the pruning
+ * heuristics are adapted after each batch instead. The memory limit is never enforced in here, see GpgMemoryController.
+ */
 template<GpgInstance InstanceType>
 void gpgMatchPrecondition (
 	const InstanceType & instance,
 	const HierarchyTyping * hierarchyTyping,
 	std::vector<typename InstanceType::ResultType *> & output,
-	std::queue<typename std::unordered_set<typename InstanceType::StateType>::const_iterator> & toBeProcessedQueue,
-	std::unordered_set<typename InstanceType::StateType> & toBeProcessedSet,
-	const GpgLiteralSet<typename InstanceType::StateType> & processedStates,
 	GpgStateMap<InstanceType> & stateMap,
 	size_t actionNo,
 	VariableAssignment & assignedVariables,
 	size_t initiallyMatchedPrecondition,
 	const typename InstanceType::StateType & initiallyMatchedState,
 	std::vector<int> & matchedPreconditions,
-	size_t preconditionIdx,
+	const GpgJoinPlan & joinPlan,
+	size_t stepIdx,
+	GpgMatchStatistics & statistics,
+	bool inParallelWorker,
 	grounding_configuration & config
 )
 {
 	
-	if (preconditionIdx == 0){
+	if (stepIdx == 0){
 		if (instance.pruneWithFutureSatisfiablility[actionNo] && !stateMap.hasPotentiallyConsistentExtension(actionNo, -1, assignedVariables, initiallyMatchedPrecondition)){
-			factFutureRejects[actionNo][initiallyMatchedPrecondition][initiallyMatchedPrecondition]++;
-			futureReject[actionNo]++;
+			statistics.factFutureRejects[actionNo][initiallyMatchedPrecondition][initiallyMatchedPrecondition]++;
+			statistics.futureReject[actionNo]++;
 			return;
 		}
 	
@@ -991,13 +2182,13 @@ void gpgMatchPrecondition (
 	
 	const typename InstanceType::ActionType & action = instance.getAllActions ()[actionNo];
 
-	if (preconditionIdx >= action.getAntecedents ().size ())
+	if (stepIdx >= joinPlan.order.size ())
 	{
 		// Processed all preconditions. This is a potentially reachable ground instance.
 		// Now we only need to assign all unassigned variables.
 		
 		//std::clock_t cc_begin = std::clock();
-		gpgAssignVariables (instance, hierarchyTyping, output, toBeProcessedQueue, toBeProcessedSet, processedStates, actionNo, assignedVariables, matchedPreconditions);
+		gpgAssignVariables (instance, hierarchyTyping, output, actionNo, assignedVariables, matchedPreconditions);
 		//std::clock_t cc_end = std::clock();
 		//double time_elapsed_ms = 1000.0 * (cc_end-cc_begin) / CLOCKS_PER_SEC;
 		//instantiationtime[actionNo] += time_elapsed_ms;
@@ -1005,32 +2196,50 @@ void gpgMatchPrecondition (
 		return;
 	}
 
-	// Skip initially matched precondition
-	if (preconditionIdx == initiallyMatchedPrecondition)
+	// Static preconditions are matched all at once by probing their table
+	if (joinPlan.staticTableNumbers[stepIdx] != -1)
 	{
-		// if the initially matched precondition cannot be extended continue
-		//if (!stateMap.hasPotentiallyConsistentExtension(actionNo, preconditionIdx, assignedVariables, initiallyMatchedPrecondition))
-		//	return
-		
-		
-		gpgMatchPrecondition (instance, hierarchyTyping, output, toBeProcessedQueue, toBeProcessedSet, processedStates, stateMap, actionNo, assignedVariables, initiallyMatchedPrecondition, initiallyMatchedState, matchedPreconditions, preconditionIdx + 1, config);
+		auto extend = [&] ()
+		{
+			gpgMatchPrecondition (instance, hierarchyTyping, output, stateMap, actionNo, assignedVariables, initiallyMatchedPrecondition, initiallyMatchedState, matchedPreconditions, joinPlan, stepIdx + 1, statistics, inParallelWorker, config);
+		};
+
+		if (joinPlan.staticTableNumbers[stepIdx] == -2)
+			extend ();
+		else
+			gpgProbeStaticTable (instance, hierarchyTyping, stateMap, actionNo, assignedVariables, matchedPreconditions, joinPlan, stepIdx, statistics, extend);
 		return;
 	}
 
+	// The initially matched precondition is not part of the join plan
+	size_t preconditionIdx = joinPlan.order[stepIdx];
 	const typename InstanceType::PreconditionType & precondition = action.getAntecedents ()[preconditionIdx];
 
 	bool foundExtension = false;
 
+	std::chrono::steady_clock::time_point lookupStart;
+	if (!config.quietMode && config.printTimings) lookupStart = std::chrono::steady_clock::now ();
+
+	std::span<const int> candidates = stateMap.getFacts (actionNo, joinPlan, stepIdx, assignedVariables);
+
+	if (!config.quietMode && config.printTimings)
+		statistics.factLookupTime[actionNo] += std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - lookupStart).count ();
+
 	// Try to find a fact that fulfills this precondition
-	for (const typename InstanceType::StateType & stateElement : stateMap.getFacts (actionNo, preconditionIdx, assignedVariables, initiallyMatchedPrecondition))
+	for (int stateElementIndex : candidates)
 	{
+		const typename InstanceType::StateType & stateElement = *stateMap.addedStateElements[stateElementIndex];
 		// Necessary for duplicate elimination. If an action has two preconditions to which the initiallyMatchedState can be matched, we would generate some groundings twice.
 		// The currently *new* initiallyMatchedState can only be matched to preconditions before the precondition to which it was matched to start this grounding.
 		if (preconditionIdx >= initiallyMatchedPrecondition && stateElement == initiallyMatchedState)
 			continue;
 
-		++totalFactTests;
-		++factTests[actionNo][preconditionIdx][initiallyMatchedPrecondition];
+		// State elements of the current batch that are processed after the initially matched one will find this grounding themselves.
+		if (stateElement.groundedNo > initiallyMatchedState.groundedNo)
+			continue;
+
+		++statistics.totalFactTests;
+		++statistics.factTests[actionNo][preconditionIdx][initiallyMatchedPrecondition];
 
 		assert (stateElement.getHeadNo () == precondition.getHeadNo ());
 		assert (stateElement.arguments.size () == precondition.arguments.size ());
@@ -1046,7 +2255,7 @@ void gpgMatchPrecondition (
 				// Variable is not assigned yet
 				int taskArgIdx = precondition.arguments[argIdx];
 				int argumentSort = action.variableSorts[taskArgIdx];
-				if (instance.domain.sorts[argumentSort].members.count (stateElement.arguments[argIdx]) == 0)
+				if (!instance.domain.sorts[argumentSort].contains (stateElement.arguments[argIdx]))
 				{
 					factMatches = false;
 					std::cerr << "Sort does not match" << std::endl;
@@ -1071,26 +2280,26 @@ void gpgMatchPrecondition (
 
 		if (factMatches)
 		{
-			++totalFactHits;
-			++factHits[actionNo][preconditionIdx][initiallyMatchedPrecondition];
+			++statistics.totalFactHits;
+			++statistics.factHits[actionNo][preconditionIdx][initiallyMatchedPrecondition];
 		}
 
-		// do prediction whether the precondition in the future may still have matching instantiations
-		if (factMatches && instance.pruneWithFutureSatisfiablility[actionNo]
+		// do prediction whether the precondition in the future may still have matching instantiations. The consistency table assumes the ascending order.
+		if (factMatches && instance.pruneWithFutureSatisfiablility[actionNo] && joinPlan.ascending
 				&&preconditionIdx !=  action.getAntecedents().size()-1){
-			futureTests[actionNo]++;
+			statistics.futureTests[actionNo]++;
 			if (!stateMap.hasPotentiallyConsistentExtension(actionNo, preconditionIdx, assignedVariables, initiallyMatchedPrecondition)){
-				factFutureRejects[actionNo][preconditionIdx][initiallyMatchedPrecondition]++;
+				statistics.factFutureRejects[actionNo][preconditionIdx][initiallyMatchedPrecondition]++;
 				factMatches = false;
-				futureReject[actionNo]++;
+				statistics.futureReject[actionNo]++;
 			}
 		}
 		
 		if (factMatches && instance.pruneWithHierarchyTyping[actionNo] && hierarchyTyping != nullptr ){
-			htTests[actionNo]++;
+			statistics.htTests[actionNo]++;
 			if (!hierarchyTyping->isAssignmentCompatible<typename InstanceType::ActionType> (actionNo, assignedVariables)){
 				factMatches = false;
-				htReject[actionNo]++;
+				statistics.htReject[actionNo]++;
 			}
 		}
 
@@ -1118,74 +2327,405 @@ void gpgMatchPrecondition (
 					}
 				}
 			}
-	
+	
+		}
+
+		/*if (statistics.totalFactTests % 10000 == 0)
+			for (int x = 0; x < instance.getNumberOfActions(); x++)
+				std::cerr << "Action " << x << " (" << instance.getAllActions()[x].name << "): " << futureReject[x] << " / " << futureTests[x] << "    " <<
+				   htReject[x] << " / " << htTests[x] << std::endl;
+*/
+
+		if (!inParallelWorker && statistics.futureTests[actionNo] % 100 == 0)
+			gpgCheckPruningUsefulness (instance, stateMap, statistics, actionNo, config);
+
+		//if (config.printTimings && totalFactTests % 100000 == 0)
+		//{
+			// printStatistics(instance);
+		//}
+
+		if (factMatches)
+		{
+			foundExtension = true;
+			matchedPreconditions[preconditionIdx] = stateElement.groundedNo;
+			gpgMatchPrecondition (instance, hierarchyTyping, output, stateMap, actionNo, assignedVariables, initiallyMatchedPrecondition, initiallyMatchedState, matchedPreconditions, joinPlan, stepIdx + 1, statistics, inParallelWorker, config);
+		}
+
+		for (int newlyAssignedVar : newlyAssigned)
+			assignedVariables.erase (newlyAssignedVar);
+	}
+
+	if (! foundExtension)
+		statistics.noextensionFound[actionNo][preconditionIdx][initiallyMatchedPrecondition]++;
+}
+
+
+
+/**
+ * @brief Returns whether the hypergraph of the preconditions of the given action, with variables as vertices, is cyclic.
+ *
+ * Uses the GYO reduction: variables occurring in a single precondition and preconditions whose variables are a subset of those
+ * of another one are removed as long as possible. The hypergraph is acyclic iff at most one precondition is left.
+ */
+template<GpgInstance InstanceType>
+bool gpgHasCyclicPreconditions (const typename InstanceType::ActionType & action)
+{
+	std::vector<std::set<int>> edges;
+	for (const typename InstanceType::PreconditionType & precondition : action.getAntecedents ())
+		edges.emplace_back (precondition.arguments.begin (), precondition.arguments.end ());
+
+	bool changed = true;
+	while (changed){
+		changed = false;
+
+		std::map<int, int> numberOfOccurrences;
+		for (const std::set<int> & edge : edges)
+			for (int var : edge)
+				numberOfOccurrences[var]++;
+		for (std::set<int> & edge : edges)
+			for (auto varIt = edge.begin (); varIt != edge.end ();)
+				if (numberOfOccurrences[*varIt] == 1){
+					varIt = edge.erase (varIt);
+					changed = true;
+				} else
+					++varIt;
+
+		for (size_t edgeIdx = 0; edgeIdx < edges.size () && edges.size () > 1; edgeIdx++)
+			for (size_t otherEdgeIdx = 0; otherEdgeIdx < edges.size (); otherEdgeIdx++)
+				if (edgeIdx != otherEdgeIdx && std::includes (edges[otherEdgeIdx].begin (), edges[otherEdgeIdx].end (), edges[edgeIdx].begin (), edges[edgeIdx].end ())){
+					edges.erase (edges.begin () + edgeIdx);
+					edgeIdx--;
+					changed = true;
+					break;
+				}
+	}
+
+	return edges.size () > 1;
+}
+
+/**
+ * @brief Returns whether the given action should be matched by gpgTriejoin().
+ *
+ * In auto mode, this is the case if its preconditions are cyclic, as the nested loops of gpgMatchPrecondition() can then
+ * produce far more partial groundings than there are groundings.
+ */
+template<GpgInstance InstanceType>
+bool gpgUseTriejoin (const InstanceType & instance, size_t actionIdx, const grounding_configuration & config)
+{
+	if (!InstanceType::triejoinSupported || config.joinEngine == JOIN_NESTED_LOOP)
+		return false;
+
+	const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
+	if (action.getAntecedents ().size () < 2)
+		return false;
+
+	return config.joinEngine == JOIN_TRIEJOIN || gpgHasCyclicPreconditions<InstanceType> (action);
+}
+
+/**
+ * @brief Joins the preconditions of an action with leapfrog triejoin, one variable of the plan at a time, and appends all resulting groundings to output.
+ *
+ * Every precondition except the initially matched one has a TrieIterator in iterators. For each variable, the iterators of
+ * the preconditions containing it are intersected, so no partial grounding is produced that is not consistent with all
+ * preconditions containing its variables. Like gpgMatchPrecondition(), only state elements that are not numbered higher than
+ * initiallyMatchedState are used, which is checked once all variables are assigned.
+ */
+template<GpgInstance InstanceType>
+void gpgTriejoin (
+	const InstanceType & instance,
+	const HierarchyTyping * hierarchyTyping,
+	std::vector<typename InstanceType::ResultType *> & output,
+	const GpgStateMap<InstanceType> & stateMap,
+	size_t actionNo,
+	VariableAssignment & assignedVariables,
+	size_t initiallyMatchedPrecondition,
+	const typename InstanceType::StateType & initiallyMatchedState,
+	std::vector<int> & matchedPreconditions,
+	const GpgTriejoinPlan & plan,
+	std::vector<TrieIterator> & iterators,
+	size_t position,
+	GpgMatchStatistics & statistics
+)
+{
+	const typename InstanceType::ActionType & action = instance.getAllActions ()[actionNo];
+
+	if (position == plan.variableOrder.size ())
+	{
+		// Every precondition has exactly one fact with the assigned values
+		bool allMatch = true;
+		for (size_t preconditionIdx = 0; preconditionIdx < action.getAntecedents ().size (); ++preconditionIdx)
+		{
+			if (preconditionIdx == initiallyMatchedPrecondition)
+				continue;
+
+			const typename InstanceType::StateType & stateElement = *stateMap.addedStateElements[iterators[preconditionIdx].tuple ().back ()];
+			++statistics.totalFactTests;
+			++statistics.factTests[actionNo][preconditionIdx][initiallyMatchedPrecondition];
+
+			// See gpgMatchPrecondition() for both conditions
+			if ((preconditionIdx >= initiallyMatchedPrecondition && stateElement == initiallyMatchedState) || stateElement.groundedNo > initiallyMatchedState.groundedNo){
+				allMatch = false;
+				break;
+			}
+
+			++statistics.totalFactHits;
+			++statistics.factHits[actionNo][preconditionIdx][initiallyMatchedPrecondition];
+			matchedPreconditions[preconditionIdx] = stateElement.groundedNo;
+		}
+
+		if (allMatch)
+			gpgAssignVariables (instance, hierarchyTyping, output, actionNo, assignedVariables, matchedPreconditions);
+		return;
+	}
+
+	int var = plan.variableOrder[position];
+	const std::vector<int> & participants = plan.participants[position];
+
+	// Checks the newly assigned variable against the hierarchy typing and the variable constraints and continues with the next one
+	auto extend = [&] ()
+	{
+		if (instance.pruneWithHierarchyTyping[actionNo] && hierarchyTyping != nullptr){
+			statistics.htTests[actionNo]++;
+			if (!hierarchyTyping->isAssignmentCompatible<typename InstanceType::ActionType> (actionNo, assignedVariables)){
+				statistics.htReject[actionNo]++;
+				return;
+			}
+		}
+
+		for (const VariableConstraint & constraint : action.variableConstraints)
+		{
+			if ((constraint.var1 != var && constraint.var2 != var) || !assignedVariables.isAssigned (constraint.var1) || !assignedVariables.isAssigned (constraint.var2))
+				continue;
+
+			bool equal = assignedVariables[constraint.var1] == assignedVariables[constraint.var2];
+			if (equal != (constraint.type == VariableConstraint::Type::EQUAL))
+				return;
+		}
+
+		gpgTriejoin (instance, hierarchyTyping, output, stateMap, actionNo, assignedVariables, initiallyMatchedPrecondition, initiallyMatchedState, matchedPreconditions, plan, iterators, position + 1, statistics);
+	};
+
+	for (int preconditionIdx : participants)
+		iterators[preconditionIdx].open ();
+
+	if (assignedVariables.isAssigned (var))
+	{
+		// Assigned by the initially matched precondition, so every participant must contain its value
+		int value = assignedVariables[var];
+		bool allContainValue = true;
+		for (int preconditionIdx : participants)
+		{
+			iterators[preconditionIdx].seek (value);
+			allContainValue &= !iterators[preconditionIdx].atEnd () && iterators[preconditionIdx].key () == value;
+		}
+
+		if (allContainValue)
+			gpgTriejoin (instance, hierarchyTyping, output, stateMap, actionNo, assignedVariables, initiallyMatchedPrecondition, initiallyMatchedState, matchedPreconditions, plan, iterators, position + 1, statistics);
+	}
+	else
+	{
+		// Leapfrog: the iterator with the smallest key seeks the largest key until all keys are equal
+		// deeper positions must not resize leapfrogsByPosition, as that would invalidate leapfrog
+		thread_local std::vector<std::vector<TrieIterator *>> leapfrogsByPosition;
+		if (leapfrogsByPosition.size () < plan.variableOrder.size ())
+			leapfrogsByPosition.resize (plan.variableOrder.size ());
+		std::vector<TrieIterator *> & leapfrog = leapfrogsByPosition[position];
+		leapfrog.clear ();
+
+		bool atEnd = false;
+		for (int preconditionIdx : participants)
+		{
+			leapfrog.push_back (&iterators[preconditionIdx]);
+			atEnd |= iterators[preconditionIdx].atEnd ();
+		}
+
+		if (!atEnd)
+		{
+			std::sort (leapfrog.begin (), leapfrog.end (), [] (const TrieIterator * it1, const TrieIterator * it2) { return it1->key () < it2->key (); });
+			int maximalKey = leapfrog.back ()->key ();
+			size_t leapfrogIdx = 0;
+			while (true)
+			{
+				TrieIterator & iterator = *leapfrog[leapfrogIdx];
+				if (iterator.key () == maximalKey)
+				{
+					assignedVariables[var] = maximalKey;
+					extend ();
+					assignedVariables.erase (var);
+
+					iterator.next ();
+				}
+				else
+					iterator.seek (maximalKey);
+
+				if (iterator.atEnd ())
+					break;
+				maximalKey = iterator.key ();
+				leapfrogIdx = (leapfrogIdx + 1) % leapfrog.size ();
+			}
+		}
+	}
+
+	for (int preconditionIdx : participants)
+		iterators[preconditionIdx].up ();
+}
+
+
+/**
+ * @brief Joins the given delta state elements, matched to the given precondition, with the other preconditions of an action and appends all resulting groundings to output.
+ *
+ * This is one rule of the semi-naive evaluation: the initially matched precondition ranges over the delta, i.e. the state
+ * elements of the current round, preconditions before it only over the state elements of earlier rounds (those with an index
+ * below roundStart), and preconditions after it over all of them. Thus, every grounding is found exactly once, namely for the
+ * first of its preconditions that is matched to a delta state element.
+ *
+ * Other than gpgMatchPrecondition(), the preconditions are joined set-at-a-time: all partial groundings are extended by one
+ * precondition of the join plan before the next one is considered. A partial grounding is a row of the assigned variables,
+ * followed by the matched state element of each precondition.
+ */
+template<GpgInstance InstanceType>
+void gpgSemiNaiveJoin (
+	const InstanceType & instance,
+	const HierarchyTyping * hierarchyTyping,
+	std::vector<typename InstanceType::ResultType *> & output,
+	const GpgStateMap<InstanceType> & stateMap,
+	size_t actionNo,
+	size_t initiallyMatchedPrecondition,
+	std::span<const int> deltaStateElements,
+	size_t roundStart,
+	GpgMatchStatistics & statistics
+)
+{
+	const typename InstanceType::ActionType & action = instance.getAllActions ()[actionNo];
+	const GpgJoinPlan & joinPlan = stateMap.joinPlans[actionNo][initiallyMatchedPrecondition];
+	const size_t numberOfVariables = action.variableSorts.size ();
+	const size_t rowWidth = numberOfVariables + action.getAntecedents ().size ();
+
+	VariableAssignment assignedVariables (numberOfVariables);
+	std::vector<int> matchedPreconditions (action.getAntecedents ().size (), -1);
+
+	auto loadRow = [&] (const std::vector<int> & rows, size_t rowIdx)
+	{
+		auto row = rows.begin () + rowIdx * rowWidth;
+		assignedVariables.assignments.assign (row, row + numberOfVariables);
+		matchedPreconditions.assign (row + numberOfVariables, row + rowWidth);
+	};
+
+	auto appendRow = [&] (std::vector<int> & rows)
+	{
+		rows.insert (rows.end (), assignedVariables.assignments.begin (), assignedVariables.assignments.end ());
+		rows.insert (rows.end (), matchedPreconditions.begin (), matchedPreconditions.end ());
+	};
+
+	std::vector<int> partialGroundings;
+	for (int stateElementIndex : deltaStateElements)
+	{
+		const typename InstanceType::StateType & stateElement = *stateMap.addedStateElements[stateElementIndex];
+		assignedVariables.assignments.assign (numberOfVariables, VariableAssignment::NOT_ASSIGNED);
+		if (!instance.doesStateFulfillPrecondition (action, &assignedVariables, stateElement, initiallyMatchedPrecondition))
+			continue;
+
+		if (instance.pruneWithHierarchyTyping[actionNo] && hierarchyTyping != nullptr &&
+				!hierarchyTyping->isAssignmentCompatible<typename InstanceType::ActionType> (actionNo, assignedVariables))
+			continue;
+
+		matchedPreconditions.assign (action.getAntecedents ().size (), -1);
+		matchedPreconditions[initiallyMatchedPrecondition] = stateElement.groundedNo;
+		appendRow (partialGroundings);
+	}
+
+	std::vector<int> extendedGroundings;
+	for (size_t stepIdx = 0; stepIdx < joinPlan.order.size () && !partialGroundings.empty (); stepIdx++)
+	{
+		// static preconditions are never initially matched, so their tables are used completely
+		if (joinPlan.staticTableNumbers[stepIdx] == -2)
+			continue;
+
+		if (joinPlan.staticTableNumbers[stepIdx] != -1)
+		{
+			extendedGroundings.clear ();
+			for (size_t rowIdx = 0; rowIdx < partialGroundings.size () / rowWidth; rowIdx++)
+			{
+				loadRow (partialGroundings, rowIdx);
+				gpgProbeStaticTable (instance, hierarchyTyping, stateMap, actionNo, assignedVariables, matchedPreconditions, joinPlan, stepIdx, statistics, [&] () { appendRow (extendedGroundings); });
+			}
+			std::swap (partialGroundings, extendedGroundings);
+			continue;
 		}
 
-		/*if (totalFactTests % 10000 == 0)
-			for (int x = 0; x < instance.getNumberOfActions(); x++)
-				std::cerr << "Action " << x << " (" << instance.getAllActions()[x].name << "): " << futureReject[x] << " / " << futureTests[x] << "    " <<
-				   htReject[x] << " / " << htTests[x] << std::endl;
-*/
+		size_t preconditionIdx = joinPlan.order[stepIdx];
+		const typename InstanceType::PreconditionType & precondition = action.getAntecedents ()[preconditionIdx];
+		size_t stateElementLimit = preconditionIdx < initiallyMatchedPrecondition ? roundStart : stateMap.addedStateElements.size ();
 
-		if (!instance.allFutureSatisfiabilityDisabled && totalFactTests % 1000*1000 == 0 && totalFactTests){
-			//std::cout << getPeakRSS() << " " << getCurrentRSS() << std::endl;
-			size_t currentRSS = getCurrentRSS();
-			if (currentRSS >= 3LL * 1024LL * 1024LL * 1024LL){
-				if (!config.quietMode) std::cout << "Memory usage exceeds 3 GiB, dropping prediction data structures." << std::endl;
-				if (!config.quietMode) std::cout << getPeakRSS() << " " << getCurrentRSS() << std::endl;
-			
-				// disable future precondition checking for all actions
-				const_cast<InstanceType &>(instance).disableAllFutureSatisfiability();
-				
-				// clear the data structure
-				stateMap.dropConsistencyTable();
-				//stateMap.dropEligibleInitialPrecondition();
+		extendedGroundings.clear ();
+		for (size_t rowIdx = 0; rowIdx < partialGroundings.size () / rowWidth; rowIdx++)
+		{
+			loadRow (partialGroundings, rowIdx);
+			for (int stateElementIndex : stateMap.getFacts (actionNo, joinPlan, stepIdx, assignedVariables))
+			{
+				// facts are listed in the order in which they were inserted
+				if (size_t (stateElementIndex) >= stateElementLimit)
+					break;
 
-				if (!config.quietMode) std::cout << getPeakRSS() << " " << getCurrentRSS() << std::endl;
-			}
-		}
-		
-		if (futureTests[actionNo] % 100 == 0 && futureTests[actionNo]){
-			const auto & action = instance.getAllActions()[actionNo];
-			if (instance.pruneWithFutureSatisfiablility[actionNo] && futureReject[actionNo] < futureTests[actionNo] / 10){
-				const_cast<InstanceType &>(instance).disablePruneWithFutureSatisfiablility(actionNo);
-				if (!config.quietMode)
-				   	std::cerr << " ---> Disabling potentially consistent extension checking for action:           " << actionNo << " (" << action.name << ")" << std::endl;
-			}
-		}
+				const typename InstanceType::StateType & stateElement = *stateMap.addedStateElements[stateElementIndex];
+				++statistics.totalFactTests;
+				++statistics.factTests[actionNo][preconditionIdx][initiallyMatchedPrecondition];
 
+				// isCompatible() has already checked the sorts
+				std::vector<int> newlyAssigned;
+				bool factMatches = true;
+				for (size_t argIdx = 0; argIdx < precondition.arguments.size () && factMatches; ++argIdx)
+				{
+					int var = precondition.arguments[argIdx];
+					if (!assignedVariables.isAssigned (var))
+					{
+						assignedVariables[var] = stateElement.arguments[argIdx];
+						newlyAssigned.push_back (var);
+					}
+					else
+						factMatches = assignedVariables[var] == stateElement.arguments[argIdx];
+				}
 
+				for (const VariableConstraint & constraint : action.variableConstraints)
+				{
+					if (!factMatches || !assignedVariables.isAssigned (constraint.var1) || !assignedVariables.isAssigned (constraint.var2))
+						continue;
 
-		if (false && htTests[actionNo] % 100 == 0 && htTests[actionNo]){
-			const auto & action = instance.getAllActions()[actionNo];
-			if (instance.pruneWithHierarchyTyping[actionNo] && htReject[actionNo] < htTests[actionNo] / 10){
-				const_cast<InstanceType &>(instance).disablePruneWithHierarchyTyping(actionNo);
-				if (!config.quietMode)
-				   	std::cerr << " ---> Disabling hierarchy typing checking during match precondition for action: " << actionNo << " (" << action.name << ")" << std::endl;
-			}
-		}
+					bool equal = assignedVariables[constraint.var1] == assignedVariables[constraint.var2];
+					factMatches = equal == (constraint.type == VariableConstraint::Type::EQUAL);
+				}
 
-		//if (config.printTimings && totalFactTests % 100000 == 0)
-		//{
-			// printStatistics(instance);
-		//}
+				if (factMatches && !newlyAssigned.empty () && instance.pruneWithHierarchyTyping[actionNo] && hierarchyTyping != nullptr){
+					statistics.htTests[actionNo]++;
+					if (!hierarchyTyping->isAssignmentCompatible<typename InstanceType::ActionType> (actionNo, assignedVariables)){
+						factMatches = false;
+						statistics.htReject[actionNo]++;
+					}
+				}
 
-		if (factMatches)
-		{
-			foundExtension = true;
-			matchedPreconditions[preconditionIdx] = stateElement.groundedNo;
-			gpgMatchPrecondition (instance, hierarchyTyping, output, toBeProcessedQueue, toBeProcessedSet, processedStates, stateMap, actionNo, assignedVariables, initiallyMatchedPrecondition, initiallyMatchedState, matchedPreconditions, preconditionIdx + 1, config);
+				if (factMatches)
+				{
+					++statistics.totalFactHits;
+					++statistics.factHits[actionNo][preconditionIdx][initiallyMatchedPrecondition];
+					matchedPreconditions[preconditionIdx] = stateElement.groundedNo;
+					appendRow (extendedGroundings);
+				}
+
+				for (int var : newlyAssigned)
+					assignedVariables.erase (var);
+			}
 		}
 
-		for (int newlyAssignedVar : newlyAssigned)
-			assignedVariables.erase (newlyAssignedVar);
+		std::swap (partialGroundings, extendedGroundings);
 	}
 
-	if (! foundExtension)
-		noextensionFound[actionNo][preconditionIdx][initiallyMatchedPrecondition]++;
+	for (size_t rowIdx = 0; rowIdx < partialGroundings.size () / rowWidth; rowIdx++)
+	{
+		loadRow (partialGroundings, rowIdx);
+		gpgAssignVariables (instance, hierarchyTyping, output, actionNo, assignedVariables, matchedPreconditions);
+	}
 }
 
-
 struct GpgTdg
 {
 	using StateType = GroundedTask;
@@ -1199,11 +2739,21 @@ struct GpgTdg
 
 	std::vector<GroundedTask *> & tasks;
 
+	/// Owns the tasks, which are released once they have been read from the initial state
+	ObjectPool<GroundedTask> & taskPool;
+
+	/// Owns the grounded methods found by the GPG
+	ObjectPool<GroundedMethod> & resultPool;
+
 	bool allFutureSatisfiabilityDisabled = false;
 	std::vector<bool> pruneWithHierarchyTyping;
 	std::vector<bool> pruneWithFutureSatisfiablility;
 
-	GpgTdg (const Domain & domain, const Problem & problem, std::vector<GroundedTask *> & tasks) : domain (domain), problem (problem), tasks (tasks) {
+	/// Whether methods may be matched by gpgTriejoin()
+	static const bool triejoinSupported = false;
+
+	GpgTdg (const Domain & domain, const Problem & problem, std::vector<GroundedTask *> & tasks, ObjectPool<GroundedTask> & taskPool, ObjectPool<GroundedMethod> & resultPool) :
+		domain (domain), problem (problem), tasks (tasks), taskPool (taskPool), resultPool (resultPool) {
 		for (size_t i = 0; i < domain.decompositionMethods.size(); i++){
 			pruneWithFutureSatisfiablility.push_back(true);
 			pruneWithHierarchyTyping.push_back(true);
@@ -1219,7 +2769,7 @@ struct GpgTdg
 
 	void getInitialStateNext (int & it) 
 	{
-		delete tasks[it];
+		taskPool.release (tasks[it]);
 		it++;
 	}
 
@@ -1233,6 +2783,11 @@ struct GpgTdg
 		return it == tasks.size();
 	}
 
+	ResultType * createResult (void) const
+	{
+		return resultPool.create ();
+	}
+
 	size_t getNumberOfActions (void) const
 	{
 		return domain.decompositionMethods.size ();
@@ -1243,6 +2798,14 @@ struct GpgTdg
 		return domain.nTotalTasks;
 	}
 
+	/**
+	 * @brief Returns whether no method produces the given task, i.e. whether it is primitive.
+	 */
+	bool isStaticPredicate (int taskNo) const
+	{
+		return taskNo < domain.nPrimitiveTasks;
+	}
+
 	const std::vector<ActionType> & getAllActions (void) const
 	{
 		return domain.decompositionMethods;
@@ -1273,7 +2836,7 @@ struct GpgTdg
 			// Make sure that the argument to the groundedTask matches the task's variable.
 			// E.g. we could have a groundedTask like "+at truck-0 city-loc-0", but this task could have
 			// "+at ?var1 ?var2" as a precondition, where ?var1 must be a package (and not a truck).
-			if (domain.sorts[argumentSort].members.count (groundedTask.arguments[argIdx]) == 0)
+			if (!domain.sorts[argumentSort].contains (groundedTask.arguments[argIdx]))
 				return false;
 	
 			// if the variable has already been assigned, the values must be consistent
@@ -1305,6 +2868,456 @@ struct GpgTdg
 	}
 };
 
+/**
+ * @brief Uses stateElement as the initially matched state element for the given precondition of the given action and appends all resulting groundings to output.
+ */
+template<GpgInstance InstanceType>
+void gpgMatchStateElement (
+	const InstanceType & instance,
+	const HierarchyTyping * hierarchyTyping,
+	std::vector<typename InstanceType::ResultType *> & output,
+	GpgStateMap<InstanceType> & stateMap,
+	int actionIdx,
+	int preconditionIdx,
+	const typename InstanceType::StateType & stateElement,
+	GpgMatchStatistics & statistics,
+	bool inParallelWorker,
+	grounding_configuration & config
+)
+{
+	// static preconditions joined in a table are never matched initially, see gpgCompileStaticPreconditions()
+	if (stateMap.staticTableOfPrecondition[actionIdx][preconditionIdx] != -1 || !stateMap.hasInstanceForAllAntecedants(actionIdx,preconditionIdx))
+		return;
+
+	const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
+
+	assert (action.getAntecedents ()[preconditionIdx].getHeadNo () == stateElement.getHeadNo ());
+
+	VariableAssignment assignedVariables (action.variableSorts.size ());
+	if (!instance.doesStateFulfillPrecondition (action, &assignedVariables, stateElement, preconditionIdx))
+		return;
+
+	if (instance.pruneWithFutureSatisfiablility[actionIdx] && action.getAntecedents().size() != 1 &&
+			!stateMap.hasPotentiallyConsistentExtension(actionIdx, -1, assignedVariables, preconditionIdx))
+		return;
+	
+	if (instance.pruneWithHierarchyTyping[actionIdx] && hierarchyTyping != nullptr &&
+			!hierarchyTyping->isAssignmentCompatible<typename InstanceType::ActionType> (actionIdx, assignedVariables))
+		return;
+
+	std::vector<int> matchedPreconditions (action.getAntecedents ().size (), -1);
+	matchedPreconditions[preconditionIdx] = stateElement.groundedNo;
+
+	if (stateMap.matchWithTriejoin[actionIdx])
+	{
+		std::vector<TrieIterator> iterators;
+		iterators.reserve (action.getAntecedents ().size ());
+		for (size_t otherPreconditionIdx = 0; otherPreconditionIdx < action.getAntecedents ().size (); ++otherPreconditionIdx)
+		{
+			// the initially matched precondition gets a dummy iterator that is never used
+			int trieNumber = std::max (stateMap.triejoinPlans[actionIdx][preconditionIdx].trieNumbers[otherPreconditionIdx], 0);
+			iterators.emplace_back (stateMap.tries[actionIdx][otherPreconditionIdx][trieNumber]);
+		}
+		gpgTriejoin (instance, hierarchyTyping, output, stateMap, actionIdx, assignedVariables, preconditionIdx, stateElement, matchedPreconditions, stateMap.triejoinPlans[actionIdx][preconditionIdx], iterators, 0, statistics);
+		return;
+	}
+
+	gpgMatchPrecondition (instance, hierarchyTyping, output, stateMap, actionIdx, assignedVariables, preconditionIdx, stateElement, matchedPreconditions, stateMap.joinPlans[actionIdx][preconditionIdx], 0, statistics, inParallelWorker, config);
+}
+
+/**
+ * @brief Processes the queue with config.threads threads.
+ *
+ * The queue is processed in batches. All state elements of a batch are inserted into the state map at once. Afterwards, every
+ * combination of a state element of the batch and a precondition it can be matched to is a job for the thread pool. Since
+ * gpgMatchPrecondition() ignores state elements that are numbered higher than the initially matched one, each job finds exactly
+ * the groundings the sequential GPG would find for it. The results of the jobs are registered in the order in which the
+ * sequential GPG would have processed them, so the numbering of results and new state elements does not depend on the number
+ * of threads.
+ */
+template<GpgInstance InstanceType>
+void gpgProcessQueueInParallel (
+	const InstanceType & instance,
+	const HierarchyTyping * hierarchyTyping,
+	const GpgPreprocessedDomain<InstanceType> & preprocessed,
+	GpgStateMap<InstanceType> & stateMap,
+	std::vector<typename InstanceType::ResultType *> & output,
+	std::queue<typename std::unordered_set<typename InstanceType::StateType>::const_iterator> & toBeProcessedQueue,
+	std::unordered_set<typename InstanceType::StateType> & toBeProcessedSet,
+	GpgLiteralSet<typename InstanceType::StateType> & processedStateElements,
+	GpgMemoryController<InstanceType> & memoryController,
+	GpgJoinPlanner<InstanceType> & joinPlanner,
+	grounding_configuration & config
+)
+{
+	struct MatchJob
+	{
+		const typename InstanceType::StateType * stateElement;
+		int actionIdx;
+		int preconditionIdx;
+		std::vector<typename InstanceType::ResultType *> results;
+	};
+
+	ThreadPool threadPool (config.threads);
+	std::vector<GpgMatchStatistics> workerStatistics (threadPool.size ());
+	for (GpgMatchStatistics & statistics : workerStatistics)
+		statistics.reset (instance);
+
+	const size_t maximalBatchSize = 1024 * threadPool.size ();
+	size_t numberOfBatches = 0;
+	size_t numberOfJobs = 0;
+
+	std::vector<MatchJob> jobs;
+	while (!toBeProcessedQueue.empty ())
+	{
+		assert (toBeProcessedQueue.size () == toBeProcessedSet.size ());
+
+		// Insert the next batch of state elements into the state map and collect the jobs in the order of the sequential GPG
+		jobs.clear ();
+		for (size_t batchSize = 0; batchSize < maximalBatchSize && !toBeProcessedQueue.empty (); ++batchSize)
+		{
+			const typename std::unordered_set<typename InstanceType::StateType>::const_iterator stateElementIterator = toBeProcessedQueue.front ();
+			const typename InstanceType::StateType stateElement = *stateElementIterator;
+			toBeProcessedQueue.pop();
+			toBeProcessedSet.erase(stateElementIterator);
+
+			const typename InstanceType::StateType * elementPointer = processedStateElements.insert (stateElement);
+			stateMap.insertState (elementPointer);
+
+			for (const auto & [actionIdx, preconditionIdx] : preprocessed.preconditionsByPredicate[stateElement.getHeadNo ()])
+				jobs.push_back ({elementPointer, actionIdx, preconditionIdx, {}});
+		}
+
+		stateMap.matchingInParallel = true;
+		threadPool.run (jobs.size (), [&] (size_t jobIdx, size_t workerIdx)
+		{
+			MatchJob & job = jobs[jobIdx];
+			gpgMatchStateElement (instance, hierarchyTyping, job.results, stateMap, job.actionIdx, job.preconditionIdx, *job.stateElement, workerStatistics[workerIdx], true, config);
+		});
+		stateMap.matchingInParallel = false;
+
+		for (MatchJob & job : jobs)
+		{
+			size_t firstNewResult = output.size ();
+			output.insert (output.end (), job.results.begin (), job.results.end ());
+			gpgRegisterResults (instance, output, firstNewResult, toBeProcessedQueue, toBeProcessedSet, processedStateElements);
+		}
+
+		// The workers must not change the pruning configuration while matching, so do it now
+		for (GpgMatchStatistics & statistics : workerStatistics)
+			gpgMatchStatistics.moveFrom (statistics);
+
+		memoryController.check (instance, stateMap, hierarchyTyping, gpgMatchStatistics, output, config);
+		joinPlanner.check (instance, stateMap, gpgMatchStatistics, config);
+		for (size_t actionIdx = 0; actionIdx < instance.getNumberOfActions (); ++actionIdx)
+			gpgCheckPruningUsefulness (instance, stateMap, gpgMatchStatistics, actionIdx, config);
+
+		++numberOfBatches;
+		numberOfJobs += jobs.size ();
+	}
+
+	if (!config.quietMode && config.printTimings)
+		std::cerr << "Parallel GPG: " << numberOfBatches << " batches with " << numberOfJobs << " jobs on " << threadPool.size () << " threads, " << threadPool.getNumberOfSteals () << " steals" << std::endl;
+}
+
+/**
+ * @brief Processes the queue in rounds, as a semi-naive evaluation. All state elements in the queue at the start of a round are its delta.
+ *
+ * The delta is inserted into the state map at once and, for every action and precondition, split into chunks that are joined by
+ * gpgSemiNaiveJoin() on config.threads threads. The results are registered in the order of the chunks, and their new state
+ * elements form the delta of the next round. The future satisfiability check is not used.
+ */
+template<GpgInstance InstanceType>
+void gpgProcessQueueSemiNaive (
+	const InstanceType & instance,
+	const HierarchyTyping * hierarchyTyping,
+	const GpgPreprocessedDomain<InstanceType> & preprocessed,
+	GpgStateMap<InstanceType> & stateMap,
+	std::vector<typename InstanceType::ResultType *> & output,
+	std::queue<typename std::unordered_set<typename InstanceType::StateType>::const_iterator> & toBeProcessedQueue,
+	std::unordered_set<typename InstanceType::StateType> & toBeProcessedSet,
+	GpgLiteralSet<typename InstanceType::StateType> & processedStateElements,
+	GpgMemoryController<InstanceType> & memoryController,
+	GpgJoinPlanner<InstanceType> & joinPlanner,
+	grounding_configuration & config
+)
+{
+	struct DeltaJob
+	{
+		int actionIdx;
+		int preconditionIdx;
+		std::span<const int> deltaStateElements;
+		std::vector<typename InstanceType::ResultType *> results;
+	};
+
+	// limits the number of partial groundings held at once
+	const size_t maximalChunkSize = 256;
+
+	ThreadPool threadPool (config.threads);
+	std::vector<GpgMatchStatistics> workerStatistics (threadPool.size ());
+	for (GpgMatchStatistics & statistics : workerStatistics)
+		statistics.reset (instance);
+
+	// delta state elements (indices in the state map) per action and precondition
+	std::vector<std::vector<std::vector<int>>> deltas (instance.getNumberOfActions ());
+	for (size_t actionIdx = 0; actionIdx < instance.getNumberOfActions (); ++actionIdx)
+		deltas[actionIdx].resize (instance.getAllActions ()[actionIdx].getAntecedents ().size ());
+
+	size_t numberOfRounds = 0;
+	size_t numberOfJobs = 0;
+	std::vector<DeltaJob> jobs;
+	while (!toBeProcessedQueue.empty ())
+	{
+		size_t roundStart = stateMap.addedStateElements.size ();
+		while (!toBeProcessedQueue.empty ())
+		{
+			const typename std::unordered_set<typename InstanceType::StateType>::const_iterator stateElementIterator = toBeProcessedQueue.front ();
+			const typename InstanceType::StateType stateElement = *stateElementIterator;
+			toBeProcessedQueue.pop();
+			toBeProcessedSet.erase(stateElementIterator);
+
+			int stateElementIndex = stateMap.addedStateElements.size ();
+			stateMap.insertState (processedStateElements.insert (stateElement));
+			for (const auto & [actionIdx, preconditionIdx] : preprocessed.preconditionsByPredicate[stateElement.getHeadNo ()])
+				deltas[actionIdx][preconditionIdx].push_back (stateElementIndex);
+		}
+
+		jobs.clear ();
+		for (size_t actionIdx = 0; actionIdx < instance.getNumberOfActions (); ++actionIdx)
+			for (size_t preconditionIdx = 0; preconditionIdx < deltas[actionIdx].size (); ++preconditionIdx){
+				const std::vector<int> & delta = deltas[actionIdx][preconditionIdx];
+				if (stateMap.staticTableOfPrecondition[actionIdx][preconditionIdx] != -1 || !stateMap.hasInstanceForAllAntecedants (actionIdx, preconditionIdx))
+					continue;
+
+				for (size_t chunkStart = 0; chunkStart < delta.size (); chunkStart += maximalChunkSize)
+					jobs.push_back ({int (actionIdx), int (preconditionIdx), std::span<const int> (delta).subspan (chunkStart, std::min (maximalChunkSize, delta.size () - chunkStart)), {}});
+			}
+
+		stateMap.matchingInParallel = true;
+		threadPool.run (jobs.size (), [&] (size_t jobIdx, size_t workerIdx)
+		{
+			DeltaJob & job = jobs[jobIdx];
+			gpgSemiNaiveJoin (instance, hierarchyTyping, job.results, stateMap, job.actionIdx, job.preconditionIdx, job.deltaStateElements, roundStart, workerStatistics[workerIdx]);
+		});
+		stateMap.matchingInParallel = false;
+
+		for (DeltaJob & job : jobs)
+		{
+			size_t firstNewResult = output.size ();
+			output.insert (output.end (), job.results.begin (), job.results.end ());
+			gpgRegisterResults (instance, output, firstNewResult, toBeProcessedQueue, toBeProcessedSet, processedStateElements);
+		}
+
+		for (std::vector<std::vector<int>> & actionDeltas : deltas)
+			for (std::vector<int> & delta : actionDeltas)
+				delta.clear ();
+
+		for (GpgMatchStatistics & statistics : workerStatistics)
+			gpgMatchStatistics.moveFrom (statistics);
+
+		memoryController.check (instance, stateMap, hierarchyTyping, gpgMatchStatistics, output, config);
+		joinPlanner.check (instance, stateMap, gpgMatchStatistics, config);
+
+		++numberOfRounds;
+		numberOfJobs += jobs.size ();
+	}
+
+	if (!config.quietMode && config.printTimings)
+		std::cerr << "Semi-naive GPG: " << numberOfRounds << " rounds with " << numberOfJobs << " jobs on " << threadPool.size () << " threads, " << threadPool.getNumberOfSteals () << " steals" << std::endl;
+}
+
+/**
+ * @brief Joins the static preconditions of every action over the initial state into tables, see GpgStaticTable.
+ *
+ * The static preconditions of an action are split into groups connected by shared variables, and every group is joined into a
+ * table of its own, so that unrelated preconditions don't multiply. Rows that violate the variable constraints among the variables
+ * of the table or the hierarchy typing are left out. Actions matched by gpgTriejoin() keep their static preconditions, as do actions
+ * whose tables would have more than maximalRows rows in total.
+ *
+ * Returns the number of actions whose static preconditions are now joined in tables.
+ */
+template<GpgInstance InstanceType>
+size_t gpgCompileStaticPreconditions (
+	const InstanceType & instance,
+	const HierarchyTyping * hierarchyTyping,
+	GpgStateMap<InstanceType> & stateMap,
+	const std::unordered_set<typename InstanceType::StateType> & initialStateElements,
+	size_t maximalRows,
+	grounding_configuration & config
+)
+{
+	// All state elements of static predicates, in the order of their numbers
+	std::vector<std::vector<const typename InstanceType::StateType *>> staticStateElements (instance.getNumberOfPredicates ());
+	for (const typename InstanceType::StateType & stateElement : initialStateElements)
+		if (instance.isStaticPredicate (stateElement.getHeadNo ()))
+			staticStateElements[stateElement.getHeadNo ()].push_back (&stateElement);
+	for (auto & stateElements : staticStateElements)
+		std::sort (stateElements.begin (), stateElements.end (), [] (const auto * element1, const auto * element2) { return element1->groundedNo < element2->groundedNo; });
+
+	size_t numberOfActions = 0;
+	size_t numberOfTables = 0;
+	size_t numberOfRows = 0;
+	for (size_t actionIdx = 0; actionIdx < instance.getNumberOfActions (); ++actionIdx)
+	{
+		const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
+		if (stateMap.matchWithTriejoin[actionIdx])
+			continue;
+
+		// Group the static preconditions by shared variables
+		std::vector<std::vector<int>> groupPreconditions;
+		std::vector<std::set<int>> groupVariables;
+		for (size_t preconditionIdx = 0; preconditionIdx < action.getAntecedents ().size (); preconditionIdx++)
+		{
+			const typename InstanceType::PreconditionType & precondition = action.getAntecedents ()[preconditionIdx];
+			if (!instance.isStaticPredicate (precondition.getHeadNo ()))
+				continue;
+
+			std::vector<int> preconditions = {int (preconditionIdx)};
+			std::set<int> variables (precondition.arguments.begin (), precondition.arguments.end ());
+			for (size_t groupIdx = 0; groupIdx < groupPreconditions.size (); )
+			{
+				bool sharesVariable = std::any_of (variables.begin (), variables.end (), [&] (int var) { return groupVariables[groupIdx].count (var) > 0; });
+				if (!sharesVariable)
+				{
+					groupIdx++;
+					continue;
+				}
+
+				preconditions.insert (preconditions.end (), groupPreconditions[groupIdx].begin (), groupPreconditions[groupIdx].end ());
+				variables.insert (groupVariables[groupIdx].begin (), groupVariables[groupIdx].end ());
+				groupPreconditions.erase (groupPreconditions.begin () + groupIdx);
+				groupVariables.erase (groupVariables.begin () + groupIdx);
+			}
+			std::sort (preconditions.begin (), preconditions.end ());
+			groupPreconditions.push_back (preconditions);
+			groupVariables.push_back (variables);
+		}
+		if (groupPreconditions.empty ())
+			continue;
+
+		std::vector<GpgStaticTable> tables;
+		size_t rowsOfAction = 0;
+		bool tooLarge = false;
+		for (size_t groupIdx = 0; groupIdx < groupPreconditions.size () && !tooLarge; groupIdx++)
+		{
+			const std::vector<int> & preconditions = groupPreconditions[groupIdx];
+			std::vector<int> variables (groupVariables[groupIdx].begin (), groupVariables[groupIdx].end ());
+			tables.push_back ({preconditions, variables, StaticTable (variables.size () + preconditions.size (), std::max<int> (instance.domain.constants.size (), 1) - 1)});
+
+			// For every precondition of the group, its compatible state elements by the values of the variables of the preconditions before it
+			std::vector<std::vector<int>> keyArguments (preconditions.size ());
+			std::vector<std::unordered_map<std::vector<int>, std::vector<const typename InstanceType::StateType *>>> candidates (preconditions.size ());
+			std::set<int> assignedVariables;
+			for (size_t groupPosition = 0; groupPosition < preconditions.size (); groupPosition++)
+			{
+				const typename InstanceType::PreconditionType & precondition = action.getAntecedents ()[preconditions[groupPosition]];
+				keyArguments[groupPosition] = stateMap.getKeyArguments (actionIdx, preconditions[groupPosition], assignedVariables);
+				for (const typename InstanceType::StateType * stateElement : staticStateElements[precondition.getHeadNo ()])
+				{
+					if (!stateMap.isCompatible (actionIdx, preconditions[groupPosition], *stateElement))
+						continue;
+
+					std::vector<int> key;
+					for (int argIdx : keyArguments[groupPosition])
+						key.push_back (stateElement->arguments[argIdx]);
+					candidates[groupPosition][key].push_back (stateElement);
+				}
+				assignedVariables.insert (precondition.arguments.begin (), precondition.arguments.end ());
+			}
+
+			// Join the preconditions of the group in ascending order
+			VariableAssignment assignment (action.variableSorts.size ());
+			std::vector<int> row (variables.size () + preconditions.size ());
+			std::function<void (size_t)> join = [&] (size_t groupPosition)
+			{
+				if (tooLarge)
+					return;
+
+				if (groupPosition == preconditions.size ())
+				{
+					if (instance.pruneWithHierarchyTyping[actionIdx] && hierarchyTyping != nullptr &&
+							!hierarchyTyping->isAssignmentCompatible<typename InstanceType::ActionType> (actionIdx, assignment))
+						return;
+
+					for (size_t column = 0; column < variables.size (); column++)
+						row[column] = assignment[variables[column]];
+					tables.back ().table.addRow (row.data ());
+					tooLarge = ++rowsOfAction > maximalRows;
+					return;
+				}
+
+				const typename InstanceType::PreconditionType & precondition = action.getAntecedents ()[preconditions[groupPosition]];
+				std::vector<int> key;
+				for (int argIdx : keyArguments[groupPosition])
+					key.push_back (assignment[precondition.arguments[argIdx]]);
+				auto candidatesIt = candidates[groupPosition].find (key);
+				if (candidatesIt == candidates[groupPosition].end ())
+					return;
+
+				for (const typename InstanceType::StateType * stateElement : candidatesIt->second)
+				{
+					// repeated variables have been checked by isCompatible()
+					std::vector<int> newlyAssigned;
+					for (size_t argIdx = 0; argIdx < precondition.arguments.size (); argIdx++)
+					{
+						int var = precondition.arguments[argIdx];
+						if (!assignment.isAssigned (var))
+						{
+							assignment[var] = stateElement->arguments[argIdx];
+							newlyAssigned.push_back (var);
+						}
+					}
+
+					bool constraintsHold = true;
+					for (const VariableConstraint & constraint : action.variableConstraints)
+					{
+						if (!constraintsHold || !assignment.isAssigned (constraint.var1) || !assignment.isAssigned (constraint.var2))
+							continue;
+
+						bool equal = assignment[constraint.var1] == assignment[constraint.var2];
+						constraintsHold = equal == (constraint.type == VariableConstraint::Type::EQUAL);
+					}
+
+					if (constraintsHold)
+					{
+						row[variables.size () + groupPosition] = stateElement->groundedNo;
+						join (groupPosition + 1);
+					}
+
+					for (int var : newlyAssigned)
+						assignment.erase (var);
+				}
+			};
+			join (0);
+		}
+
+		if (tooLarge)
+		{
+			if (!config.quietMode && config.printTimings)
+				std::cerr << " ---> Static preconditions of action " << actionIdx << " (" << action.name << ") have more than " << maximalRows << " joined rows, matching them as usual" << std::endl;
+			continue;
+		}
+
+		// the consistency table must know the state elements of the static preconditions, as they are never inserted
+		if (instance.pruneWithFutureSatisfiablility[actionIdx])
+			for (const std::vector<int> & preconditions : groupPreconditions)
+				for (int preconditionIdx : preconditions)
+					for (const typename InstanceType::StateType * stateElement : staticStateElements[action.getAntecedents ()[preconditionIdx].getHeadNo ()])
+						if (stateMap.isCompatible (actionIdx, preconditionIdx, *stateElement))
+							stateMap.insertIntoConsistencyTable (actionIdx, preconditionIdx, *stateElement);
+
+		numberOfActions++;
+		numberOfTables += tables.size ();
+		numberOfRows += rowsOfAction;
+		stateMap.setStaticTables (actionIdx, std::move (tables));
+	}
+
+	if (!config.quietMode)
+		std::cerr << "Joined the static preconditions of " << numberOfActions << " actions into " << numberOfTables << " tables with " << numberOfRows << " rows." << std::endl;
+
+	return numberOfActions;
+}
+
 /**
  * TODO
  */
@@ -1316,10 +3329,29 @@ void runGpg (const InstanceType & instance, std::vector<typename InstanceType::R
 	output.clear ();
 
 	GpgPreprocessedDomain<InstanceType> preprocessed (instance, instance.domain, instance.problem);
-	static GpgStateMap<InstanceType> stateMap (instance, preprocessed, config.futureCachingByPrecondition);
+	GpgStateMap<InstanceType> stateMap (instance, preprocessed, config.futureCachingByPrecondition, config.flatFactIndex, !config.quietMode && config.printTimings);
 
 	GpgLiteralSet<typename InstanceType::StateType> processedStateElements (instance.getNumberOfPredicates ());
 
+	// Select the join engine of every action. Triejoin needs no consistency table, and neither does the semi-naive evaluation, which always uses the fact index.
+	if (config.semiNaive)
+		const_cast<InstanceType &>(instance).disableAllFutureSatisfiability ();
+
+	size_t numberOfTriejoinActions = 0;
+	for (size_t actionIdx = 0; actionIdx < instance.getNumberOfActions (); ++actionIdx)
+	{
+		if (config.semiNaive || !gpgUseTriejoin (instance, actionIdx, config))
+			continue;
+
+		stateMap.enableTriejoin (actionIdx);
+		const_cast<InstanceType &>(instance).disablePruneWithFutureSatisfiablility (actionIdx);
+		numberOfTriejoinActions++;
+		if (!config.quietMode && config.printTimings)
+			std::cerr << " ---> Matching action " << actionIdx << " (" << instance.getAllActions ()[actionIdx].name << ") with leapfrog triejoin" << std::endl;
+	}
+	if (!config.quietMode && numberOfTriejoinActions > 0)
+		std::cerr << "Matching " << numberOfTriejoinActions << " actions with leapfrog triejoin." << std::endl;
+
 	// We need a queue to process new state elements in the correct order (which makes things faster),
 	// and a set to prevent duplicate additions to the queue.
 	std::queue<typename std::unordered_set<typename InstanceType::StateType>::const_iterator> toBeProcessedQueue;
@@ -1355,13 +3387,7 @@ void runGpg (const InstanceType & instance, std::vector<typename InstanceType::R
 
 
 	// Reset counters
-	totalFactTests = 0;
-	totalFactHits = 0;
-	
-	htReject.clear(); htReject.resize(instance.getNumberOfActions());
-	htTests.clear(); htTests.resize(instance.getNumberOfActions());
-	futureReject.clear(); futureReject.resize(instance.getNumberOfActions());
-	futureTests.clear(); futureTests.resize(instance.getNumberOfActions());
+	gpgMatchStatistics.reset (instance);
 	
 	stateElementGroundingTime.clear();
 	stateElementMPTime.clear();
@@ -1371,45 +3397,45 @@ void runGpg (const InstanceType & instance, std::vector<typename InstanceType::R
 	instantiationtime2.clear();
 	
 	liftedGroundingCount.clear();
-	factTests.clear ();
-	factHits.clear ();
-	factFutureRejects.clear ();
-	
-	factTests.resize (instance.getNumberOfActions ());
-	factHits.resize (instance.getNumberOfActions ());
-	factFutureRejects.resize (instance.getNumberOfActions ());
-	noextensionFound.resize (instance.getNumberOfActions ());
 
-	for (size_t i = 0; i < instance.getNumberOfActions (); ++i){
-		factTests[i].resize (instance.getAllActions ()[i].getAntecedents ().size ());
-		factHits[i].resize (instance.getAllActions ()[i].getAntecedents ().size ());
-		factFutureRejects[i].resize (instance.getAllActions ()[i].getAntecedents ().size ());
-		noextensionFound[i].resize (instance.getAllActions ()[i].getAntecedents ().size ());
-		for (size_t j = 0; j < instance.getAllActions()[i].getAntecedents().size(); j++){
-			factTests[i][j].resize (instance.getAllActions ()[i].getAntecedents ().size ());
-			factHits[i][j].resize (instance.getAllActions ()[i].getAntecedents ().size ());
-			factFutureRejects[i][j].resize (instance.getAllActions ()[i].getAntecedents ().size ());
-			noextensionFound[i][j].resize (instance.getAllActions ()[i].getAntecedents ().size ());
-		}
-	}
+	if (config.staticTables)
+		gpgCompileStaticPreconditions (instance, hierarchyTyping, stateMap, toBeProcessedSet, 1 << 20, config);
 
 	if (!config.quietMode) std::cerr << "Process actions without preconditions" << std::endl;
 
-	// First, process all actions without preconditions
+	// First, process all actions without preconditions, and those whose preconditions are all joined in static tables
 	for (int actionIdx = 0; actionIdx < instance.getNumberOfActions (); ++actionIdx)
 	{
 		const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
-		if (action.getAntecedents ().size () != 0)
+		bool onlyStaticPreconditions = std::all_of (stateMap.staticTableOfPrecondition[actionIdx].begin (), stateMap.staticTableOfPrecondition[actionIdx].end (), [] (int staticTableNumber) { return staticTableNumber != -1; });
+		if (action.getAntecedents ().size () != 0 && (!onlyStaticPreconditions || stateMap.numberOfAntecedantsWithoutFact[actionIdx] > 0))
 			continue;
 
 		VariableAssignment assignedVariables (action.variableSorts.size ());
 		typename InstanceType::StateType f;
 		std::vector<int> matchedPreconditions (action.getAntecedents ().size (), -1);
-		gpgMatchPrecondition (instance, hierarchyTyping, output, toBeProcessedQueue, toBeProcessedSet, processedStateElements, stateMap, actionIdx, assignedVariables, 0, f, matchedPreconditions, 0, config);
+		size_t firstNewResult = output.size ();
+		if (action.getAntecedents ().size () == 0)
+			gpgMatchPrecondition (instance, hierarchyTyping, output, stateMap, actionIdx, assignedVariables, 0, f, matchedPreconditions, GpgJoinPlan (), 0, gpgMatchStatistics, false, config);
+		else {
+			// there is no initially matched precondition, which the future satisfiability check can't handle
+			const_cast<InstanceType &>(instance).disablePruneWithFutureSatisfiablility (actionIdx);
+			stateMap.dropConsistencyTable (actionIdx);
+			gpgMatchPrecondition (instance, hierarchyTyping, output, stateMap, actionIdx, assignedVariables, action.getAntecedents ().size (), f, matchedPreconditions, stateMap.getStaticJoinPlan (actionIdx), 0, gpgMatchStatistics, false, config);
+		}
+		gpgRegisterResults (instance, output, firstNewResult, toBeProcessedQueue, toBeProcessedSet, processedStateElements);
 	}
 	
 	if (!config.quietMode) std::cerr << "Done." << std::endl;
 
+	GpgMemoryController<InstanceType> memoryController (config);
+	GpgJoinPlanner<InstanceType> joinPlanner (config);
+
+	if (config.semiNaive)
+		gpgProcessQueueSemiNaive (instance, hierarchyTyping, preprocessed, stateMap, output, toBeProcessedQueue, toBeProcessedSet, processedStateElements, memoryController, joinPlanner, config);
+	else if (config.threads > 1)
+		gpgProcessQueueInParallel (instance, hierarchyTyping, preprocessed, stateMap, output, toBeProcessedQueue, toBeProcessedSet, processedStateElements, memoryController, joinPlanner, config);
+
 	while (!toBeProcessedQueue.empty ())
 	{
 		std::clock_t se_begin;
@@ -1443,31 +3469,14 @@ void runGpg (const InstanceType & instance, std::vector<typename InstanceType::R
 		// Find tasks with this predicate as precondition
 		for (const auto & [actionIdx, preconditionIdx] : preprocessed.preconditionsByPredicate[stateElement.getHeadNo ()])
 		{
-			if (!stateMap.hasInstanceForAllAntecedants(actionIdx,preconditionIdx))
-				continue;
-
-			const typename InstanceType::ActionType & action = instance.getAllActions ()[actionIdx];
-
-			assert (action.getAntecedents ()[preconditionIdx].getHeadNo () == stateElement.getHeadNo ());
-
-			VariableAssignment assignedVariables (action.variableSorts.size ());
-			if (!instance.doesStateFulfillPrecondition (action, &assignedVariables, stateElement, preconditionIdx))
-				continue;
-		
-			if (instance.pruneWithFutureSatisfiablility[actionIdx] && action.getAntecedents().size() != 1 &&
-					!stateMap.hasPotentiallyConsistentExtension(actionIdx, -1, assignedVariables, preconditionIdx))
-				continue;
-			
-			if (instance.pruneWithHierarchyTyping[actionIdx] && hierarchyTyping != nullptr &&
-					!hierarchyTyping->isAssignmentCompatible<typename InstanceType::ActionType> (actionIdx, assignedVariables))
-				continue;
-			
 			std::clock_t cc_begin;
 		   	if (!config.quietMode && config.printTimings) cc_begin = std::clock();
 
-			std::vector<int> matchedPreconditions (action.getAntecedents ().size (), -1);
-			matchedPreconditions[preconditionIdx] = stateElement.groundedNo;
-			gpgMatchPrecondition (instance, hierarchyTyping, output, toBeProcessedQueue, toBeProcessedSet, processedStateElements, stateMap, actionIdx, assignedVariables, preconditionIdx, stateElement, matchedPreconditions, 0, config);
+			size_t firstNewResult = output.size ();
+			gpgMatchStateElement (instance, hierarchyTyping, output, stateMap, actionIdx, preconditionIdx, stateElement, gpgMatchStatistics, false, config);
+			gpgRegisterResults (instance, output, firstNewResult, toBeProcessedQueue, toBeProcessedSet, processedStateElements);
+			memoryController.checkPeriodically (instance, stateMap, hierarchyTyping, gpgMatchStatistics, output, config);
+			joinPlanner.checkPeriodically (instance, stateMap, gpgMatchStatistics, config);
 			
 			if (!config.quietMode && config.printTimings){
 				std::clock_t cc_end = std::clock();
@@ -1495,12 +3504,14 @@ void runGpg (const InstanceType & instance, std::vector<typename InstanceType::R
 
 	outputStateElements = processedStateElements;
 
-	if (!config.quietMode && config.printTimings) printStatistics(instance);
+	if (!config.quietMode && config.printTimings && joinPlanner.enabled)
+		std::cerr << "Join planner: " << joinPlanner.numberOfChangedPlans << " changed plans" << std::endl;
+	if (!config.quietMode && config.printTimings) printStatistics(instance, stateMap);
 	if (!config.quietMode) std::cerr << "Returning from runGpg()." << std::endl;
 }
 
 
-void tdgDfs (std::vector<GroundedTask> & outputTasks, std::vector<GroundedMethod> & outputMethods, std::vector<GroundedTask*> & inputTasks, std::vector<GroundedMethod*> & inputMethods, std::vector<Fact> & reachableFactsList, std::unordered_set<int> & reachableCEGuards, const Domain & domain, const Problem & problem);
+void tdgDfs (std::vector<GroundedTask> & outputTasks, std::vector<GroundedMethod> & outputMethods, std::vector<GroundedTask*> & inputTasks, std::vector<GroundedMethod*> & inputMethods, ObjectPool<GroundedTask> & taskPool, ObjectPool<GroundedMethod> & methodPool, std::vector<Fact> & reachableFactsList, std::unordered_set<int> & reachableCEGuards, const Domain & domain, const Problem & problem);
 
 
 
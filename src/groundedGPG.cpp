@@ -7,10 +7,11 @@
 
 #include "groundedGPG.h"
 #include "debug.h"
+#include "groundedmodel.h"
 #include "model.h"
 
 
-std::pair<size_t, size_t> groundedPg (std::vector<bool> & factReached, std::vector<int> & unfulfilledPreconditions, std::vector<bool> & prunedTasks, std::vector<bool> & prunedFacts, const std::vector<GroundedTask> & inputTasks, const std::vector<Fact> & inputFacts, const Domain & domain, const Problem & problem)
+std::pair<size_t, size_t> groundedPg (std::vector<bool> & factReached, std::vector<int> & unfulfilledPreconditions, std::vector<bool> & prunedTasks, std::vector<bool> & prunedFacts, const std::vector<GroundedTask> & inputTasks, const std::vector<Fact> & inputFacts, const GroundedModel & model, const Domain & domain, const Problem & problem)
 {
 	// Reset output vectors
 	factReached.clear ();
@@ -34,12 +35,12 @@ std::pair<size_t, size_t> groundedPg (std::vector<bool> & factReached, std::vect
 		if (prunedTasks[taskIdx])
 			continue;
 
-		unfulfilledPreconditions[taskIdx] = task.groundedPreconditions.size ();
+		unfulfilledPreconditions[taskIdx] = model.taskPreconditions[taskIdx].size ();
 		if (unfulfilledPreconditions[taskIdx] == 0)
 		{
 			++reachedTasksCount;
 
-			for (int addFact : task.groundedAddEffects)
+			for (int addFact : model.taskAddEffects[taskIdx])
 			{
 				if (!factReached[addFact])
 				{
@@ -64,23 +65,6 @@ std::pair<size_t, size_t> groundedPg (std::vector<bool> & factReached, std::vect
 				<< task.groundedDecompositionMethods.size () << " grounded decomposition methods (vs " << domain.tasks[task.taskNo].decompositionMethods.size () << ")." << std::endl;
 	});
 
-	// Calculate which tasks have a specific fact as a precondition
-	std::vector<std::vector<int>> tasksByPrecondition (inputFacts.size ());
-	for (size_t taskIdx = 0; taskIdx < inputTasks.size (); ++taskIdx)
-	{
-		const GroundedTask & task = inputTasks[taskIdx];
-		if (task.taskNo >= domain.nPrimitiveTasks)
-			continue;
-
-		if (prunedTasks[taskIdx])
-			continue;
-
-		assert (task.groundedNo == taskIdx);
-
-		for (int preconditionIdx : task.groundedPreconditions)
-			tasksByPrecondition[preconditionIdx].push_back (taskIdx);
-	}
-
 	for (size_t initFactIdx = 0; initFactIdx < problem.init.size (); ++initFactIdx)
 	{
 		// Perhaps the init fact was already added by a task without preconditions?
@@ -99,15 +83,16 @@ std::pair<size_t, size_t> groundedPg (std::vector<bool> & factReached, std::vect
 		int factIdx = factsToBeProcessed.front ();
 		factsToBeProcessed.pop ();
 
-		for (int taskIdx : tasksByPrecondition[factIdx])
+		for (int taskIdx : model.tasksByPrecondition[factIdx])
 		{
-			const GroundedTask & task = inputTasks[taskIdx];
+			if (prunedTasks[taskIdx] || inputTasks[taskIdx].taskNo >= domain.nPrimitiveTasks)
+				continue;
 
 			--unfulfilledPreconditions[taskIdx];
 			if (unfulfilledPreconditions[taskIdx] == 0)
 			{
 				++reachedTasksCount;
-				for (int addFact : task.groundedAddEffects)
+				for (int addFact : model.taskAddEffects[taskIdx])
 				{
 					if (!factReached[addFact])
 					{
@@ -131,7 +116,7 @@ std::pair<size_t, size_t> groundedPg (std::vector<bool> & factReached, std::vect
 	return {reachedTasksCount, reachedFactsCount};
 }
 
-std::pair<size_t, size_t> groundedTdg (std::vector<bool> & taskReached, std::vector<int> & unfulfilledPreconditions, std::vector<bool> & prunedMethods, std::vector<bool> & prunedTasks, const std::vector<GroundedMethod> & inputMethods, const std::vector<GroundedTask> & inputTasks, const Domain & domain, const Problem & problem)
+std::pair<size_t, size_t> groundedTdg (std::vector<bool> & taskReached, std::vector<int> & unfulfilledPreconditions, std::vector<bool> & prunedMethods, std::vector<bool> & prunedTasks, const std::vector<GroundedMethod> & inputMethods, const std::vector<GroundedTask> & inputTasks, const GroundedModel & model, const Domain & domain, const Problem & problem)
 {
 	// Reset output vectors
 	taskReached.clear ();
@@ -151,13 +136,12 @@ std::pair<size_t, size_t> groundedTdg (std::vector<bool> & taskReached, std::vec
 		if (prunedMethods[methodIdx])
 			continue;
 
-		const GroundedMethod & method = inputMethods[methodIdx];
-		unfulfilledPreconditions[methodIdx] = method.groundedPreconditions.size ();
+		unfulfilledPreconditions[methodIdx] = model.methodSubtasks[methodIdx].size ();
 		if (unfulfilledPreconditions[methodIdx] == 0)
 		{
 			++reachedMethodsCount;
 
-			for (int addTask : method.groundedAddEffects)
+			for (int addTask : model.methodTasks[methodIdx])
 			{
 				if (!taskReached[addTask])
 				{
@@ -179,20 +163,6 @@ std::pair<size_t, size_t> groundedTdg (std::vector<bool> & taskReached, std::vec
 			std::cerr << "        Subtask " << subtaskNo << std::endl;
 	});
 
-	// Calculate which methods have a specific task as a precondition
-	std::vector<std::vector<int>> methodsByPrecondition (inputTasks.size ());
-	for (size_t methodIdx = 0; methodIdx < inputMethods.size (); ++methodIdx)
-	{
-		if (prunedMethods[methodIdx])
-			continue;
-
-		const GroundedMethod & method = inputMethods[methodIdx];
-		assert (method.groundedNo == methodIdx);
-
-		for (int preconditionIdx : method.groundedPreconditions)
-			methodsByPrecondition[preconditionIdx].push_back (methodIdx);
-	}
-
 	for (size_t initTaskIdx = 0; initTaskIdx < inputTasks.size (); ++initTaskIdx)
 	{
 		const GroundedTask & task = inputTasks[initTaskIdx];
@@ -208,15 +178,16 @@ std::pair<size_t, size_t> groundedTdg (std::vector<bool> & taskReached, std::vec
 		int taskIdx = tasksToBeProcessed.front ();
 		tasksToBeProcessed.pop ();
 
-		for (int methodIdx : methodsByPrecondition[taskIdx])
+		for (int methodIdx : model.methodsBySubtask[taskIdx])
 		{
-			const GroundedMethod & method = inputMethods[methodIdx];
+			if (prunedMethods[methodIdx])
+				continue;
 
 			--unfulfilledPreconditions[methodIdx];
 			if (unfulfilledPreconditions[methodIdx] == 0)
 			{
 				++reachedMethodsCount;
-				for (int addFact : method.groundedAddEffects)
+				for (int addFact : model.methodTasks[methodIdx])
 				{
 					if (!taskReached[addFact])
 					{
@@ -325,19 +296,26 @@ std::pair<size_t, size_t> groundedTdgDfs (std::vector<bool> & prunedTasks, std::
 
 
 void run_grounded_HTN_GPG(const Domain & domain, const Problem & problem,  
-		std::vector<Fact> reachableFacts,
-		std::vector<GroundedTask> reachableTasks,
-		std::vector<GroundedMethod> reachableMethods,
+		const std::vector<Fact> & reachableFacts,
+		const std::vector<GroundedTask> & reachableTasks,
+		const std::vector<GroundedMethod> & reachableMethods,
 		std::vector<bool> & prunedFacts,
 		std::vector<bool> & prunedTasks,
 		std::vector<bool> & prunedMethods,
 		grounding_configuration & config,
-		bool alwaysRunDFS)
+		bool alwaysRunDFS,
+		DecrementalGroundedGpg * decremental)
 {
 	// don't to anything for grounded problems
 	if (problem.initialAbstractTask == -1)
 		return;
 
+	if (decremental != nullptr && decremental->isValid ())
+	{
+		decremental->run (prunedFacts, prunedTasks, prunedMethods, alwaysRunDFS, config);
+		return;
+	}
+
 	size_t remainingFactsCount = reachableTasks.size ();
 	size_t remainingMethodsCount = reachableMethods.size ();
 
@@ -348,13 +326,18 @@ void run_grounded_HTN_GPG(const Domain & domain, const Problem & problem,
 			++remainingPrimitiveTasks;
 	}
 
+	// The lists of the tasks and methods do not change here, only the pruning masks
+	GroundedModel model (reachableFacts, reachableTasks, reachableMethods);
+	if (!config.quietMode && config.printTimings)
+		std::cerr << "Grounded model: " << model.memoryUsage () / 1024 << " KiB" << std::endl;
+
 	// Iterate grounded PG and TDG until convergence
 	while (true)
 	{
 		// Grounded PG
 		std::vector<bool> factReached;
 		std::vector<int> unfulfilledPreconditions;
-		auto [reachedTasksCount, reachedFactsCount] = groundedPg (factReached, unfulfilledPreconditions, prunedTasks, prunedFacts, reachableTasks, reachableFacts, domain, problem);
+		auto [reachedTasksCount, reachedFactsCount] = groundedPg (factReached, unfulfilledPreconditions, prunedTasks, prunedFacts, reachableTasks, reachableFacts, model, domain, problem);
 
 		if (!config.quietMode) std::cerr << "Grounded PG:" << std::endl;
 		if (!config.quietMode) std::cerr << "Input was [" << remainingPrimitiveTasks << ", " << remainingFactsCount << "], output was [" << reachedTasksCount << ", " << reachedFactsCount << "]." << std::endl;
@@ -384,7 +367,7 @@ void run_grounded_HTN_GPG(const Domain & domain, const Problem & problem,
 
 		// Do grounded TDG
 		std::vector<bool> taskReached;
-		auto [reachedMethodsCount, reachedTasksCountTdg] = groundedTdg (taskReached, unfulfilledPreconditions, prunedMethods, prunedTasks, reachableMethods, reachableTasks, domain, problem);
+		auto [reachedMethodsCount, reachedTasksCountTdg] = groundedTdg (taskReached, unfulfilledPreconditions, prunedMethods, prunedTasks, reachableMethods, reachableTasks, model, domain, problem);
 		if (!config.quietMode) std::cerr << "Grounded TDG:" << std::endl;
 		if (!config.quietMode) std::cerr << "Input was [" << remainingMethodsCount << ", " << remainingPrimitiveTasks << "], output was [" << reachedMethodsCount << ", " << reachedTasksCountTdg << "]." << std::endl;
 	
@@ -417,6 +400,8 @@ void run_grounded_HTN_GPG(const Domain & domain, const Problem & problem,
 		remainingPrimitiveTasks = reachedPrimitiveTasksCountDfs;
 	}
 
+	if (decremental != nullptr)
+		decremental->build (domain, problem, reachableFacts, reachableTasks, reachableMethods, prunedFacts, prunedTasks, prunedMethods);
 
 	return;
 }
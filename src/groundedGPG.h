@@ -3,18 +3,20 @@
 
 #include <vector>
 
+#include "decrementalGPG.h"
 #include "model.h"
 #include "grounding.h"
 
 void run_grounded_HTN_GPG(const Domain & domain, const Problem & problem,  
-		std::vector<Fact> reachableFacts,
-		std::vector<GroundedTask> reachableTasks,
-		std::vector<GroundedMethod> reachableMethods,
+		const std::vector<Fact> & reachableFacts,
+		const std::vector<GroundedTask> & reachableTasks,
+		const std::vector<GroundedMethod> & reachableMethods,
 		std::vector<bool> & prunedFacts,
 		std::vector<bool> & prunedTasks,
 		std::vector<bool> & prunedMethods,
 		grounding_configuration & config,
-		bool alwaysRunDFS);
+		bool alwaysRunDFS,
+		DecrementalGroundedGpg * decremental);
 
 
 #endif
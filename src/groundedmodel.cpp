@@ -0,0 +1,77 @@
+#include <cassert>
+
+#include "groundedmodel.h"
+
+CsrAdjacency::CsrAdjacency (void) : offsets (1, 0)
+{
+}
+
+CsrAdjacency CsrAdjacency::reversed (size_t numberOfTargets, bool unique) const
+{
+	// count the entries per target, then place the sources in ascending order
+	CsrAdjacency reverse;
+	reverse.offsets.assign (numberOfTargets + 1, 0);
+	for (int target : targets)
+	{
+		assert (target >= 0 && size_t (target) < numberOfTargets);
+		reverse.offsets[target + 1]++;
+	}
+	for (size_t target = 0; target < numberOfTargets; target++)
+		reverse.offsets[target + 1] += reverse.offsets[target];
+
+	std::vector<size_t> position (reverse.offsets.begin (), reverse.offsets.end () - 1);
+	reverse.targets.resize (targets.size ());
+	for (size_t source = 0; source < size (); source++)
+		for (int target : (*this)[source])
+			reverse.targets[position[target]++] = source;
+
+	if (!unique)
+		return reverse;
+
+	// remove repeated sources, which are adjacent as every list is sorted
+	size_t written = 0;
+	for (size_t target = 0; target < numberOfTargets; target++)
+	{
+		size_t begin = reverse.offsets[target];
+		reverse.offsets[target] = written;
+		for (size_t entry = begin; entry < reverse.offsets[target + 1]; entry++)
+			if (entry == begin || reverse.targets[entry] != reverse.targets[entry - 1])
+				reverse.targets[written++] = reverse.targets[entry];
+	}
+	reverse.offsets[numberOfTargets] = written;
+	reverse.targets.resize (written);
+	reverse.targets.shrink_to_fit ();
+
+	return reverse;
+}
+
+size_t CsrAdjacency::memoryUsage (void) const
+{
+	return sizeof (CsrAdjacency) + offsets.capacity () * sizeof (size_t) + targets.capacity () * sizeof (int);
+}
+
+GroundedModel::GroundedModel (const std::vector<Fact> & facts, const std::vector<GroundedTask> & tasks, const std::vector<GroundedMethod> & methods)
+{
+	taskPreconditions = CsrAdjacency::fromLists (tasks, [] (const GroundedTask & task) -> const std::vector<int> & { return task.groundedPreconditions; });
+	taskAddEffects = CsrAdjacency::fromLists (tasks, [] (const GroundedTask & task) -> const std::vector<int> & { return task.groundedAddEffects; });
+	taskDelEffects = CsrAdjacency::fromLists (tasks, [] (const GroundedTask & task) -> const std::vector<int> & { return task.groundedDelEffects; });
+	taskMethods = CsrAdjacency::fromLists (tasks, [] (const GroundedTask & task) -> const std::vector<int> & { return task.groundedDecompositionMethods; });
+
+	methodSubtasks = CsrAdjacency::fromLists (methods, [] (const GroundedMethod & method) -> const std::vector<int> & { return method.groundedPreconditions; });
+	methodSubtaskOrderings = CsrAdjacency::fromLists (methods, [] (const GroundedMethod & method) -> const std::vector<int> & { return method.preconditionOrdering; });
+	methodTasks = CsrAdjacency::fromLists (methods, [] (const GroundedMethod & method) -> const std::vector<int> & { return method.groundedAddEffects; });
+
+	tasksByPrecondition = taskPreconditions.reversed (facts.size (), false);
+	tasksByAddEffect = taskAddEffects.reversed (facts.size (), false);
+	tasksByDelEffect = taskDelEffects.reversed (facts.size (), false);
+	methodsBySubtask = methodSubtasks.reversed (tasks.size (), false);
+}
+
+size_t GroundedModel::memoryUsage (void) const
+{
+	size_t bytes = 0;
+	for (const CsrAdjacency * adjacency : {&taskPreconditions, &taskAddEffects, &taskDelEffects, &taskMethods, &methodSubtasks, &methodSubtaskOrderings,
+			&methodTasks, &tasksByPrecondition, &tasksByAddEffect, &tasksByDelEffect, &methodsBySubtask})
+		bytes += adjacency->memoryUsage ();
+	return bytes;
+}
@@ -0,0 +1,113 @@
+#ifndef GROUNDEDMODEL_H_INCLUDED
+#define GROUNDEDMODEL_H_INCLUDED
+
+/**
+ * @defgroup groundedmodel Grounded Model
+ * @brief Compressed sparse row adjacency of the grounded facts, tasks and methods.
+ *
+ * @{
+ */
+
+#include <span>
+#include <vector>
+
+#include "model.h"
+
+/**
+ * @brief A list of integers for every source number, stored in two flat arrays.
+ *
+ * The list of source i consists of targets[offsets[i]] to targets[offsets[i + 1] - 1].
+ */
+class CsrAdjacency
+{
+public:
+	CsrAdjacency (void);
+
+	/**
+	 * @brief Collects the list getList (element) of every element.
+	 */
+	template <typename Element, typename ListGetter>
+	static CsrAdjacency fromLists (const std::vector<Element> & elements, ListGetter getList)
+	{
+		CsrAdjacency adjacency;
+		adjacency.offsets.reserve (elements.size () + 1);
+		for (const Element & element : elements)
+		{
+			const auto & list = getList (element);
+			adjacency.targets.insert (adjacency.targets.end (), list.begin (), list.end ());
+			adjacency.offsets.push_back (adjacency.targets.size ());
+		}
+		return adjacency;
+	}
+
+	/**
+	 * @brief Returns the adjacency in the opposite direction, for targets in [0; numberOfTargets).
+	 *
+	 * Every list is sorted by source number. If unique is not set, a source occurs as often in the list of a target as the target
+	 * occurs in the list of the source.
+	 */
+	CsrAdjacency reversed (size_t numberOfTargets, bool unique) const;
+
+	/**
+	 * @brief Returns the number of lists.
+	 */
+	size_t size (void) const
+	{
+		return offsets.size () - 1;
+	}
+
+	std::span<const int> operator[] (size_t source) const
+	{
+		return {targets.data () + offsets[source], targets.data () + offsets[source + 1]};
+	}
+
+	/**
+	 * @brief Returns the number of bytes allocated by the adjacency.
+	 */
+	size_t memoryUsage (void) const;
+
+private:
+	std::vector<size_t> offsets;
+	std::vector<int> targets;
+};
+
+/**
+ * @brief The adjacency of the grounded facts, tasks and methods in both directions.
+ *
+ * This is a snapshot of the lists of the grounded tasks and methods at construction time. Passes that change these lists
+ * must build a new one afterwards. Pruned elements are included, so the pruning masks can change without invalidating it.
+ */
+struct GroundedModel
+{
+	/// Per grounded task
+	CsrAdjacency taskPreconditions;
+	CsrAdjacency taskAddEffects;
+	CsrAdjacency taskDelEffects;
+	CsrAdjacency taskMethods;
+
+	/// Per grounded method
+	CsrAdjacency methodSubtasks;
+	CsrAdjacency methodSubtaskOrderings;
+	CsrAdjacency methodTasks;
+
+	/// Per grounded fact, the tasks having it as a precondition, add effect or delete effect
+	CsrAdjacency tasksByPrecondition;
+	CsrAdjacency tasksByAddEffect;
+	CsrAdjacency tasksByDelEffect;
+
+	/// Per grounded task, the methods containing it as a subtask, once per occurrence
+	CsrAdjacency methodsBySubtask;
+
+	GroundedModel (const std::vector<Fact> & facts, const std::vector<GroundedTask> & tasks, const std::vector<GroundedMethod> & methods);
+
+	/**
+	 * @brief Returns the number of bytes allocated by all adjacencies.
+	 */
+	size_t memoryUsage (void) const;
+};
+
+/**
+ * @}
+ */
+
+#endif
@@ -1,3 +1,4 @@
+#include <sstream>
 #include "grounding.h"
 #include "gpg.h"
 #include "liftedGPG.h"
@@ -9,6 +10,8 @@
 #include "FAMmutexes.h"
 #include "conditional_effects.h"
 #include "duplicate.h"
+#include "rss.h"
+#include "phasegraph.h"
 
 void grounding_configuration::print_options(){
 	if (quietMode) return;
@@ -17,6 +20,7 @@ void grounding_configuration::print_options(){
 	std::cout << std::boolalpha;
 	std::cout << "General Options" << std::endl;
 	std::cout << "  Print timings: " << printTimings << std::endl;
+	std::cout << "  Output benchmark: " << outputBenchmark << std::endl;
 	std::cout << "  Quiet mode: " << quietMode << std::endl;
 	
 	
@@ -40,11 +44,25 @@ void grounding_configuration::print_options(){
 	std::cout << "  Hierarchy Typing: " << enableHierarchyTyping << std::endl;
 	std::cout << "  Future Caching: " << futureCachingByPrecondition << std::endl;
 	std::cout << "  Static Precondition Checking: " << withStaticPreconditionChecking << std::endl;
+	std::cout << "  Threads: " << threads << std::endl;
+	std::cout << "  Flat fact index: " << flatFactIndex << std::endl;
+	std::cout << "  Memory limit [MiB]: " << memoryLimit << std::endl;
+	std::cout << "  Join planner: " << joinPlanner << std::endl;
+	std::cout << "  Semi-naive evaluation: " << semiNaive << std::endl;
+	std::cout << "  Static tables: " << staticTables << std::endl;
+	std::cout << "  Renumber constants: " << renumberConstants << std::endl;
+	std::cout << "  Decremental grounded GPG: " << decrementalGroundedGpg << std::endl;
+	std::cout << "  Parallel hierarchy typing: " << parallelHierarchyTyping << std::endl;
+	std::cout << "  Parallel output: " << parallelOutput << std::endl;
+	std::cout << "  Concurrent phases: " << concurrentPhases << std::endl;
+	std::cout << "  Mapped input: " << mappedInput << std::endl;
+	std::cout << "  Join engine: " << (joinEngine == JOIN_NESTED_LOOP ? "nested-loop" : (joinEngine == JOIN_TRIEJOIN ? "triejoin" : "auto")) << std::endl;
 	
 
 	std::cout << "Output Options" << std::endl;
 	// select output format
 	std::cout << "  Panda planner format: " << outputForPlanner << std::endl;
+	std::cout << "  Binary planner format: " << outputBinaryPlanner << std::endl;
 	std::cout << "  HDDL: " << outputHDDL << std::endl;
 	std::cout << "  SAS for Fast Downward (without hierarchy): " << outputSASPlus << std::endl; 
 
@@ -57,205 +75,284 @@ void grounding_configuration::print_options(){
 		case SAS_ALL: std::cout << "delete all facts of SAS+ group"; break;
 		case SAS_NONE: std::cout << "no deletes"; break;
 	}
-
 	std::cout << std::endl;
+	std::cout << "  Warn about actions with more cover-pruned copies than: " << coverCopiesWarning << std::endl;
+	std::cout << "  Stop at actions with more cover-pruned copies than: " << coverCopiesLimit << std::endl;
 }
 
 
-void run_grounding (const Domain & domain, const Problem & problem, std::ostream & dout, std::ostream & pout, grounding_configuration & config, given_plan_typing_information & given_typing){
-
-  	std::vector<FAMGroup> famGroups;	
-	if (config.computeInvariants){
-		famGroups = compute_FAM_mutexes(domain,problem,config);
-	}
-
-	// if the instance contains conditional effects we have to compile them into additional primitive actions
-	// for this, we need to be able to write to the domain
-	expand_conditional_effects_into_artificial_tasks(const_cast<Domain &>(domain), const_cast<Problem &>(problem));
-	if (!config.quietMode) std::cout << "Conditional Effects expanded" << std::endl;
-
-	// run the lifted GPG to create an initial grounding of the domain
-	auto [initiallyReachableFacts,initiallyReachableTasks,initiallyReachableMethods] = run_lifted_HTN_GPG(domain, problem, config, given_typing);
-	// run the grounded GPG until convergence to get the grounding smaller
-	std::vector<bool> prunedFacts (initiallyReachableFacts.size());
-	std::vector<bool> prunedTasks (initiallyReachableTasks.size());
-	std::vector<bool> prunedMethods (initiallyReachableMethods.size());
-	
-	// do this early
-	applyEffectPriority(domain, prunedTasks, prunedFacts, initiallyReachableTasks, initiallyReachableFacts);
-	
-	run_grounded_HTN_GPG(domain, problem, initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods, 
-			prunedFacts, prunedTasks, prunedMethods,
-			config, false);
+void print_memory_usage (const char * phase, const grounding_configuration & config){
+	if (config.quietMode || !config.printTimings) return;
+	const size_t MiB = 1024 * 1024;
+	// written at once, as phases may run concurrently
+	std::ostringstream line;
+	line << "Memory after " << phase << ": current " << getCurrentRSS() / MiB << " MiB, peak " << getPeakRSS() / MiB << " MiB" << std::endl;
+	std::cerr << line.str();
+}
 
-////////////////////// H2 mutexes
+void run_grounding (const Domain & domain, const Problem & problem, BufferedOutput & dout, BufferedOutput & pout, grounding_configuration & config, given_plan_typing_information & given_typing){
+	// the results of the phases, a phase only uses the results of the phases it depends on
+	std::vector<FAMGroup> famGroups;
+	std::vector<Fact> initiallyReachableFacts;
+	std::vector<GroundedTask> initiallyReachableTasks;
+	std::vector<GroundedMethod> initiallyReachableMethods;
+	std::vector<bool> prunedFacts;
+	std::vector<bool> prunedTasks;
+	std::vector<bool> prunedMethods;
+	// with --decremental-grounded-gpg, keeps the grounded PG/TDG between the calls of run_grounded_HTN_GPG
+	DecrementalGroundedGpg decrementalGpg;
 	std::vector<std::unordered_set<int>> h2_mutexes;
 	std::vector<std::unordered_set<int>> h2_invariants;
-	if (config.h2Mutexes){
-		// remove useless predicates to make the H2 inference easier
-		grounding_configuration temp_configuration = config;
-		temp_configuration.expandChoicelessAbstractTasks = false;
-		temp_configuration.pruneEmptyMethodPreconditions = false;
-		temp_configuration.atMostTwoTasksPerMethod = false;
-		temp_configuration.compactConsecutivePrimitives = false;
-		temp_configuration.outputSASVariablesOnly = true; // -> force SAS+ here. This makes the implementation easier
-
-		bool reachabilityNecessary = false;
-		postprocess_grounding(domain, problem, initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods, prunedFacts, prunedTasks, prunedMethods, reachabilityNecessary, temp_configuration); 
-
-		// H2 mutexes need the maximum amount of information possible, so we have to compute SAS groups at this point
-
-		// prepare data structures that are needed for efficient access
-		std::unordered_set<Fact> reachableFactsSet(initiallyReachableFacts.begin(), initiallyReachableFacts.end());
-		
-		std::unordered_set<int> initFacts; // needed for efficient goal checking
-		std::unordered_set<int> initFactsPruned; // needed for efficient checking of pruned facts in the goal
-
-		for (const Fact & f : problem.init){
-			int groundNo = reachableFactsSet.find(f)->groundedNo;
-			if (prunedFacts[groundNo]){
-				initFactsPruned.insert(groundNo);
-				continue;
-			}
-			initFacts.insert(groundNo);
-		}
-
-
-
-		auto [sas_groups,further_mutex_groups] = compute_sas_groups(domain, problem, 
-				famGroups, h2_mutexes,
-				initiallyReachableFacts,initiallyReachableTasks, initiallyReachableMethods, prunedTasks, prunedFacts, prunedMethods, 
-				initFacts, reachableFactsSet,
-				temp_configuration);
-		
-		
-		bool changedPruned = false;
-		auto [sas_variables_needing_none_of_them,_] = ground_invariant_analysis(domain, problem, 
-				initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods,
-				prunedTasks, prunedFacts, prunedMethods,
-				initFacts,
-				sas_groups,further_mutex_groups,
-				changedPruned,
-				temp_configuration);
-
-
-		// run H2 mutex analysis
-		auto [has_pruned, _h2_mutexes, _h2_invariants] = 
-			compute_h2_mutexes(domain,problem,initiallyReachableFacts,initiallyReachableTasks,
-					prunedFacts, prunedTasks, 
-					sas_groups, sas_variables_needing_none_of_them,
-					temp_configuration);
-		h2_mutexes = _h2_mutexes;
-		h2_invariants = _h2_invariants;
-
-		if (has_pruned || changedPruned){
-			// if we have pruned actions, rerun the PGP and HTN stuff
-			run_grounded_HTN_GPG(domain, problem, initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods, 
-				prunedFacts, prunedTasks, prunedMethods,
-				temp_configuration, false);
-		}
-	}
-//////////////////////// end of H2 mutexes
-
-	// run postprocessing
 	bool reachabilityNecessary = false;
-	postprocess_grounding(domain, problem, initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods, prunedFacts, prunedTasks, prunedMethods, reachabilityNecessary, config);
-
-	DEBUG(	
-	// check integrity of data structures
-	for (int i = 0; i < initiallyReachableMethods.size(); i++){
-		if (prunedMethods[i]) continue;
-		int at = initiallyReachableMethods[i].groundedAddEffects[0];
-		assert(std::count(initiallyReachableTasks[at].groundedDecompositionMethods.begin(),initiallyReachableTasks[at].groundedDecompositionMethods.end(),i));
-	}
 
-	for (int i = 0; i < initiallyReachableTasks.size(); i++){
-		if (prunedTasks[i]) continue;
-		for (int m : initiallyReachableTasks[i].groundedDecompositionMethods)
-			assert(initiallyReachableMethods[m].groundedAddEffects[0] == i);
+	// only needed for the output for the planner
+	std::unordered_set<Fact> reachableFactsSet;
+	std::unordered_set<int> initFacts; // needed for efficient goal checking
+	std::unordered_set<int> initFactsPruned; // needed for efficient checking of pruned facts in the goal
+	std::vector<bool> sas_variables_needing_none_of_them;
+	std::vector<std::unordered_set<int>> sas_groups;
+	std::vector<std::unordered_set<int>> strict_mutexes;
+	std::vector<std::unordered_set<int>> non_strict_mutexes;
+
+	PhaseGraph phases;
+
+	// The FAM inference only reads the lifted model, so with --concurrent-phases it runs alongside the lifted and grounded GPG.
+	// These change the domain, so the inference then works on a copy of the model as it was before. The only change the inference
+	// makes itself, a sort containing all constants, is carried over into the domain once a phase needs the FAM groups.
+	std::unique_ptr<Domain> famDomain;
+	std::unique_ptr<Problem> famProblem;
+	if (config.computeInvariants && config.concurrentPhases){
+		famDomain = std::make_unique<Domain>(domain);
+		famProblem = std::make_unique<Problem>(problem);
+	}
+	auto adoptFamSorts = [&](){
+		if (!famDomain) return;
+		for (size_t s = domain.sorts.size(); s < famDomain->sorts.size(); s++)
+			const_cast<Domain &>(domain).sorts.push_back(std::move(famDomain->sorts[s]));
+		famDomain.reset();
+		famProblem.reset();
+	};
+
+	int fam = -1;
+	if (config.computeInvariants)
+		fam = phases.add("FAM groups", {}, [&](){
+			famGroups = famDomain ? compute_FAM_mutexes(*famDomain, *famProblem, config) : compute_FAM_mutexes(domain, problem, config);
+			print_memory_usage("FAM groups", config);
+		});
+	auto withFam = [&](std::vector<int> dependencies){
+		if (fam != -1) dependencies.push_back(fam);
+		return dependencies;
+	};
+
+	int lifted = phases.add("lifted GPG", {}, [&](){
+		// if the instance contains conditional effects we have to compile them into additional primitive actions
+		// for this, we need to be able to write to the domain
+		expand_conditional_effects_into_artificial_tasks(const_cast<Domain &>(domain), const_cast<Problem &>(problem));
+		if (!config.quietMode) std::cout << "Conditional Effects expanded" << std::endl;
+
+		// run the lifted GPG to create an initial grounding of the domain
+		std::tie(initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods) = run_lifted_HTN_GPG(domain, problem, config, given_typing);
+		print_memory_usage("lifted GPG", config);
 	});
 
+	int last = phases.add("grounded GPG", {lifted}, [&](){
+		// run the grounded GPG until convergence to get the grounding smaller
+		prunedFacts.assign(initiallyReachableFacts.size(), false);
+		prunedTasks.assign(initiallyReachableTasks.size(), false);
+		prunedMethods.assign(initiallyReachableMethods.size(), false);
 
+		// do this early
+		applyEffectPriority(domain, prunedTasks, prunedFacts, initiallyReachableTasks, initiallyReachableFacts);
 
-	if (config.outputSASPlus){
-		write_sasplus(dout, domain,problem,initiallyReachableFacts,initiallyReachableTasks, prunedFacts, prunedTasks, config);
-		return;
-	}
+		run_grounded_HTN_GPG(domain, problem, initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods, 
+				prunedFacts, prunedTasks, prunedMethods,
+				config, false, config.decrementalGroundedGpg ? &decrementalGpg : nullptr);
+		print_memory_usage("grounded GPG", config);
+	});
 
-	if (config.outputHDDL)
-		write_grounded_HTN_to_HDDL(dout, pout, domain, problem, initiallyReachableFacts,initiallyReachableTasks, initiallyReachableMethods, prunedTasks, prunedFacts, prunedMethods, config);
-	else if (config.outputForPlanner) {
-		// prepare data structures that are needed for efficient access
-		std::unordered_set<Fact> reachableFactsSet(initiallyReachableFacts.begin(), initiallyReachableFacts.end());
-		
-		std::unordered_set<int> initFacts; // needed for efficient goal checking
-		std::unordered_set<int> initFactsPruned; // needed for efficient checking of pruned facts in the goal
-
-		for (const Fact & f : problem.init){
-			int groundNo = reachableFactsSet.find(f)->groundedNo;
-			if (prunedFacts[groundNo]){
-				initFactsPruned.insert(groundNo);
-				continue;
+////////////////////// H2 mutexes
+	if (config.h2Mutexes)
+		last = phases.add("H2 mutexes", withFam({last}), [&](){
+			adoptFamSorts();
+
+			// remove useless predicates to make the H2 inference easier
+			grounding_configuration temp_configuration = config;
+			temp_configuration.expandChoicelessAbstractTasks = false;
+			temp_configuration.pruneEmptyMethodPreconditions = false;
+			temp_configuration.atMostTwoTasksPerMethod = false;
+			temp_configuration.compactConsecutivePrimitives = false;
+			temp_configuration.outputSASVariablesOnly = true; // -> force SAS+ here. This makes the implementation easier
+
+			bool reachabilityNecessary = false;
+			postprocess_grounding(domain, problem, initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods, prunedFacts, prunedTasks, prunedMethods, reachabilityNecessary, temp_configuration); 
+			if (postprocessingChangesLists(temp_configuration))
+				decrementalGpg.invalidate();
+
+			// H2 mutexes need the maximum amount of information possible, so we have to compute SAS groups at this point
+
+			// prepare data structures that are needed for efficient access
+			std::unordered_set<Fact> reachableFactsSet(initiallyReachableFacts.begin(), initiallyReachableFacts.end());
+			
+			std::unordered_set<int> initFacts; // needed for efficient goal checking
+			std::unordered_set<int> initFactsPruned; // needed for efficient checking of pruned facts in the goal
+
+			for (const Fact & f : problem.init){
+				int groundNo = reachableFactsSet.find(f)->groundedNo;
+				if (prunedFacts[groundNo]){
+					initFactsPruned.insert(groundNo);
+					continue;
+				}
+				initFacts.insert(groundNo);
 			}
-			initFacts.insert(groundNo);
-		}
 
-		std::vector<bool> sas_variables_needing_none_of_them;
-		std::vector<bool> mutex_groups_needing_none_of_them;
-		std::vector<std::unordered_set<int>> sas_groups;
-		std::vector<std::unordered_set<int>> further_mutex_groups;
 
-		bool first = reachabilityNecessary;
-		while (true){
-			auto [_sas_groups,_further_mutex_groups] = compute_sas_groups(domain, problem, 
+
+			auto [sas_groups,further_mutex_groups] = compute_sas_groups(domain, problem, 
 					famGroups, h2_mutexes,
 					initiallyReachableFacts,initiallyReachableTasks, initiallyReachableMethods, prunedTasks, prunedFacts, prunedMethods, 
 					initFacts, reachableFactsSet,
-					config);
-
+					temp_configuration);
+			
+			
 			bool changedPruned = false;
-			auto [_sas_variables_needing_none_of_them,_mutex_groups_needing_none_of_them] = ground_invariant_analysis(domain, problem, 
+			auto [sas_variables_needing_none_of_them,_] = ground_invariant_analysis(domain, problem, 
 					initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods,
 					prunedTasks, prunedFacts, prunedMethods,
 					initFacts,
-					_sas_groups,_further_mutex_groups,
+					sas_groups,further_mutex_groups,
 					changedPruned,
-					config);
+					temp_configuration);
+
+
+			// run H2 mutex analysis
+			auto [has_pruned, _h2_mutexes, _h2_invariants] = 
+				compute_h2_mutexes(domain,problem,initiallyReachableFacts,initiallyReachableTasks,
+						prunedFacts, prunedTasks, 
+						sas_groups, sas_variables_needing_none_of_them,
+						temp_configuration);
+			h2_mutexes = std::move(_h2_mutexes);
+			h2_invariants = std::move(_h2_invariants);
 
-			if (changedPruned || first){
+			if (has_pruned || changedPruned){
+				// if we have pruned actions, rerun the PGP and HTN stuff
 				run_grounded_HTN_GPG(domain, problem, initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods, 
 					prunedFacts, prunedTasks, prunedMethods,
-					config, first);
-				first = false;
-			} else {
-				sas_variables_needing_none_of_them = _sas_variables_needing_none_of_them;
-				mutex_groups_needing_none_of_them = _mutex_groups_needing_none_of_them;
-				sas_groups = _sas_groups;
-				further_mutex_groups = _further_mutex_groups;
-				break;
+					temp_configuration, false, config.decrementalGroundedGpg ? &decrementalGpg : nullptr);
 			}
-		}
+			print_memory_usage("H2 mutexes", config);
+		});
+//////////////////////// end of H2 mutexes
 
-		// duplicate elemination
-		if (config.removeDuplicateActions)
-			unify_duplicates(domain,problem,initiallyReachableFacts,initiallyReachableTasks, initiallyReachableMethods, prunedTasks, prunedFacts, prunedMethods, config);
-
-		std::vector<std::unordered_set<int>> strict_mutexes;
-		std::vector<std::unordered_set<int>> non_strict_mutexes;
-		for (size_t m = 0; m < further_mutex_groups.size(); m++){
-			if (mutex_groups_needing_none_of_them[m])
-				non_strict_mutexes.push_back(further_mutex_groups[m]);
-			else
-				strict_mutexes.push_back(further_mutex_groups[m]);
+	last = phases.add("postprocessing", {last}, [&](){
+		// run postprocessing
+		postprocess_grounding(domain, problem, initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods, prunedFacts, prunedTasks, prunedMethods, reachabilityNecessary, config);
+		if (postprocessingChangesLists(config))
+			decrementalGpg.invalidate();
+		print_memory_usage("postprocessing", config);
+
+		DEBUG(	
+		// check integrity of data structures
+		for (int i = 0; i < initiallyReachableMethods.size(); i++){
+			if (prunedMethods[i]) continue;
+			int at = initiallyReachableMethods[i].groundedAddEffects[0];
+			assert(std::count(initiallyReachableTasks[at].groundedDecompositionMethods.begin(),initiallyReachableTasks[at].groundedDecompositionMethods.end(),i));
 		}
-		
-		if (!config.quietMode)
-			std::cout << "Further Mutex Groups: " << strict_mutexes.size() <<  " strict " << non_strict_mutexes.size() << " non strict" << std::endl;
 
+		for (int i = 0; i < initiallyReachableTasks.size(); i++){
+			if (prunedTasks[i]) continue;
+			for (int m : initiallyReachableTasks[i].groundedDecompositionMethods)
+				assert(initiallyReachableMethods[m].groundedAddEffects[0] == i);
+		});
+	});
+
+	bool plannerOutput = !config.outputSASPlus && !config.outputHDDL && config.outputForPlanner;
+	if (plannerOutput)
+		phases.add("invariants", withFam({last}), [&](){
+			adoptFamSorts();
+
+			// prepare data structures that are needed for efficient access
+			reachableFactsSet.insert(initiallyReachableFacts.begin(), initiallyReachableFacts.end());
+
+			for (const Fact & f : problem.init){
+				int groundNo = reachableFactsSet.find(f)->groundedNo;
+				if (prunedFacts[groundNo]){
+					initFactsPruned.insert(groundNo);
+					continue;
+				}
+				initFacts.insert(groundNo);
+			}
+
+			std::vector<bool> mutex_groups_needing_none_of_them;
+			std::vector<std::unordered_set<int>> further_mutex_groups;
+
+			bool first = reachabilityNecessary;
+			while (true){
+				auto [_sas_groups,_further_mutex_groups] = compute_sas_groups(domain, problem, 
+						famGroups, h2_mutexes,
+						initiallyReachableFacts,initiallyReachableTasks, initiallyReachableMethods, prunedTasks, prunedFacts, prunedMethods, 
+						initFacts, reachableFactsSet,
+						config);
+
+				bool changedPruned = false;
+				auto [_sas_variables_needing_none_of_them,_mutex_groups_needing_none_of_them] = ground_invariant_analysis(domain, problem, 
+						initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods,
+						prunedTasks, prunedFacts, prunedMethods,
+						initFacts,
+						_sas_groups,_further_mutex_groups,
+						changedPruned,
+						config);
+
+				if (changedPruned || first){
+					run_grounded_HTN_GPG(domain, problem, initiallyReachableFacts, initiallyReachableTasks, initiallyReachableMethods, 
+						prunedFacts, prunedTasks, prunedMethods,
+						config, first, config.decrementalGroundedGpg ? &decrementalGpg : nullptr);
+					first = false;
+				} else {
+					sas_variables_needing_none_of_them = std::move(_sas_variables_needing_none_of_them);
+					mutex_groups_needing_none_of_them = std::move(_mutex_groups_needing_none_of_them);
+					sas_groups = std::move(_sas_groups);
+					further_mutex_groups = std::move(_further_mutex_groups);
+					break;
+				}
+			}
+			print_memory_usage("invariants", config);
+
+			// duplicate elemination
+			if (config.removeDuplicateActions)
+				unify_duplicates(domain,problem,initiallyReachableFacts,initiallyReachableTasks, initiallyReachableMethods, prunedTasks, prunedFacts, prunedMethods, config);
+
+			for (size_t m = 0; m < further_mutex_groups.size(); m++){
+				if (mutex_groups_needing_none_of_them[m])
+					non_strict_mutexes.push_back(std::move(further_mutex_groups[m]));
+				else
+					strict_mutexes.push_back(std::move(further_mutex_groups[m]));
+			}
+			
+			if (!config.quietMode)
+				std::cout << "Further Mutex Groups: " << strict_mutexes.size() <<  " strict " << non_strict_mutexes.size() << " non strict" << std::endl;
+		});
+
+	phases.run(config.concurrentPhases);
+	// the other output formats do not use the FAM groups, but the domain gets the same sorts as without --concurrent-phases
+	adoptFamSorts();
+	// the output is written outside of the phases, as writing the planner output does not return
+	if (!config.quietMode && config.printTimings)
+		phases.printTimings(std::cerr);
+
+
+	if (config.outputSASPlus){
+		write_sasplus(dout, domain,problem,initiallyReachableFacts,initiallyReachableTasks, prunedFacts, prunedTasks, config);
+		print_memory_usage("output", config);
+		return;
+	}
+
+	if (config.outputHDDL)
+		write_grounded_HTN_to_HDDL(dout, pout, domain, problem, initiallyReachableFacts,initiallyReachableTasks, initiallyReachableMethods, prunedTasks, prunedFacts, prunedMethods, config);
+	else if (plannerOutput)
 		write_grounded_HTN(dout, domain, problem, initiallyReachableFacts,initiallyReachableTasks, initiallyReachableMethods, prunedTasks, prunedFacts, prunedMethods,
 			initFacts, initFactsPruned, reachableFactsSet,
 			sas_groups, strict_mutexes, non_strict_mutexes, h2_invariants,
 			sas_variables_needing_none_of_them,
 			config);
-	}
+	print_memory_usage("output", config);
 }
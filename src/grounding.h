@@ -1,17 +1,36 @@
 #ifndef GROUNDING_H_INCLUDED
 #define GROUNDING_H_INCLUDED
 
-#include <ostream>
+#include "bufferedoutput.h"
 #include "main.h"
 #include "model.h"
 #include "givenPlan.h"
 
 
+enum gpg_join_engine{
+	JOIN_NESTED_LOOP,
+	JOIN_TRIEJOIN,
+	JOIN_AUTO
+};
+
 struct grounding_configuration{
 	// runtime optimisations
 	bool enableHierarchyTyping = true;
 	bool futureCachingByPrecondition = false;
 	bool withStaticPreconditionChecking = false;
+	int threads = 1;
+	bool flatFactIndex = false;
+	int memoryLimit = 3072;
+	bool joinPlanner = false;
+	gpg_join_engine joinEngine = JOIN_NESTED_LOOP;
+	bool semiNaive = false;
+	bool staticTables = false;
+	bool renumberConstants = false;
+	bool decrementalGroundedGpg = false;
+	bool parallelHierarchyTyping = false;
+	bool parallelOutput = false;
+	bool concurrentPhases = false;
+	bool mappedInput = false;
 	
 	// inference of additional information
 	bool h2Mutexes = false;
@@ -19,6 +38,7 @@ struct grounding_configuration{
 
 	// select output format
 	bool outputForPlanner = true;
+	bool outputBinaryPlanner = false;
 	bool outputHDDL = false;
 	bool outputSASPlus = false; 
 
@@ -26,6 +46,8 @@ struct grounding_configuration{
 	bool outputSASVariablesOnly = false;
 	sas_delete_output_mode sas_mode = SAS_AS_INPUT;
 	bool noopForEmptyMethods = false;
+	int coverCopiesWarning = 0;
+	int coverCopiesLimit = 0;
 	
 	// compilations to apply
 	bool compileNegativeSASVariables = false;
@@ -39,13 +61,18 @@ struct grounding_configuration{
 	
 	// program output behaviour	
 	bool printTimings = false;
+	bool outputBenchmark = false;
 	bool quietMode = false;
 
 	void print_options();
 };
 
+/**
+ * @brief Prints the current and peak resident set size after the given phase of the grounding, if timings are printed.
+ */
+void print_memory_usage (const char * phase, const grounding_configuration & config);
 
-void run_grounding (const Domain & domain, const Problem & problem, std::ostream & dout, std::ostream & pout, grounding_configuration & config, given_plan_typing_information & given_typing);
+void run_grounding (const Domain & domain, const Problem & problem, BufferedOutput & dout, BufferedOutput & pout, grounding_configuration & config, given_plan_typing_information & given_typing);
 
 #endif
 
@@ -1,6 +1,8 @@
 #include <algorithm>
+#include <chrono>
 #include <iostream>
-#include <set>
+#include <mutex>
+#include <numeric>
 #include <vector>
 #include <ctime>
 
@@ -9,59 +11,7 @@
 #include "debug.h"
 #include "model.h"
 #include "hierarchy-typing.h"
-
-template<typename T>
-static std::set<T> intersect (const std::set<T> & a, const std::set<T> & b)
-{
-	std::set<T> result;
-	std::set_intersection (a.begin (), a.end (), b.begin (), b.end (), std::inserter (result, result.begin ()));
-	return result;
-}
-
-void intersect (std::set<int> & a, std::set<int> & bParameter, const Domain & domain){
-	int sort = -1;
-	if (bParameter.size() == 1 && *(bParameter.begin()) < 0)
-		sort = -(*(bParameter.begin())) - 1;
-	
-	const std::set<int> & b = (sort == -1)? bParameter : domain.sorts[sort].members;
-	
-	if (a.size() == 1 && *(a.begin()) < 0){
-		int sort = -(*(a.begin())) - 1;
-		a.clear();
-		for (const int & i : b)
-			if (domain.sorts[sort].members.count(i))
-				a.insert(i);
-	} else {
-		if (a.size() > 10 * b.size()){ // b is significantly smaller
-			std::set<int> newA;
-			for (const int & i : b)
-				if (a.count(i))
-					newA.insert(i);
-			a = newA;
-		} else if (b.size() > 10 * a.size()){  // a is significantly smaller
-			std::set<int> newA;
-			for (const int & i : a)
-				if (b.count(i))
-					newA.insert(i);
-			a = newA;
-		} else { // a and b have roughly the same size
-			auto itA = a.begin();
-			auto itB = b.begin();
-
-			while (itA != a.end() && itB != b.end()){
-				if (*itA < *itB){
-					a.erase(itA++);
-				} else if (*itA > *itB){
-					itB++;
-				} else {
-					itA++;
-					itB++;
-				}
-			}
-		}
-	}
-}
-
+#include "threadpool.h"
 
 /**
  * @brief Reduces the set of possible constants for a task/method by applying variable constraints.
@@ -82,7 +32,8 @@ static void applyConstraints (PossibleConstants & possibleConstants, const std::
 			if (constraint.type == VariableConstraint::Type::EQUAL)
 			{
 				// Both variables must be equal; reduce the set of possible constants to the intersection.
-				const auto & intersection = intersect (possibleConstants[constraint.var1], possibleConstants[constraint.var2]);
+				ConstantSet intersection = possibleConstants[constraint.var1];
+				intersection.intersectWith (possibleConstants[constraint.var2]);
 
 				// Comparing the size of the sets is faster than comparing the sets themselves
 				if (intersection.size () < possibleConstants[constraint.var1].size () || intersection.size () < possibleConstants[constraint.var2].size ())
@@ -96,9 +47,9 @@ static void applyConstraints (PossibleConstants & possibleConstants, const std::
 				// Both variables may not be equal; if any of them only has one possible value, remove it from the other.
 				size_t erased = 0;
 				if (possibleConstants[constraint.var1].size () == 1)
-					erased += possibleConstants[constraint.var2].erase (*possibleConstants[constraint.var1].begin ());
+					erased += possibleConstants[constraint.var2].erase (possibleConstants[constraint.var1].front ());
 				if (possibleConstants[constraint.var2].size () == 1)
-					erased += possibleConstants[constraint.var1].erase (*possibleConstants[constraint.var2].begin ());
+					erased += possibleConstants[constraint.var1].erase (possibleConstants[constraint.var2].front ());
 
 				if (erased > 0)
 					changed = true;
@@ -108,11 +59,282 @@ static void applyConstraints (PossibleConstants & possibleConstants, const std::
 	while (changed);
 }
 
+/**
+ * @brief Returns the possible constants of a method's variables given the possible constants of its task's variables.
+ */
+static PossibleConstants initialMethodConstants (const Domain & domain, int methodNo, const PossibleConstants & possibleConstants)
+{
+	const DecompositionMethod & method = domain.decompositionMethods[methodNo];
+
+	// Determine possible constants for this method
+	//
+	//   -> full sorts are copies of their member bitsets, which is cheap (saves a lot of runtime in certain domains, especially Minecraft)
+	//
+	PossibleConstants possibleMethodConstants (method.variableSorts.size ());
+	for (size_t methodVarIdx = 0; methodVarIdx < method.variableSorts.size (); ++methodVarIdx)
+	{
+		// Initially, we can use all constants from the method variable's sort.
+		int sort = method.variableSorts[methodVarIdx];
+		possibleMethodConstants[methodVarIdx] = ConstantSet::fromBits (domain.sorts[sort].memberBits);
+	}
+	for (size_t taskVarIdx = 0; taskVarIdx < method.taskParameters.size (); ++taskVarIdx)
+	{
+		// For method variables that correspond to task variables, we intersect the possible constants.
+		int methodVarIdx = method.taskParameters[taskVarIdx];
+		possibleMethodConstants[methodVarIdx].intersectWith(possibleConstants[taskVarIdx]);
+	}
+
+	DEBUG(
+		std::cout << "Starting on method" << methodNo << " " << method.name;
+   		std::cout << "[";
+   		bool first = true;
+		for (auto p : possibleMethodConstants){
+			if (!first) std::cout << ",";
+			std::cout << "{";
+   			bool ffirst = true;
+			for (auto v : p){
+				if (!ffirst) std::cout << ",";
+				std::cout << domain.constants[v];
+				ffirst = false;	
+			}
+			std::cout << "}";
+			first = false;
+		}	
+		std::cout << "]";
+		std::cout << std::endl;
+	);
+
+	return possibleMethodConstants;
+}
+
+/**
+ * @brief Restricts the possible constants of a method by the static preconditions of its primitive subtasks and its constraints.
+ *
+ * Returns false if some variable has no possible constant left, i.e. the method cannot be instantiated.
+ */
+static bool restrictMethodConstants (const Domain & domain, const Problem & problem, bool withStaticPreconditionChecking, const std::vector<bool> & staticPredicates,
+		const std::vector<std::vector<std::map<int,std::vector<int>>>> & factsPerPredicate, const DecompositionMethod & method, PossibleConstants & possibleMethodConstants)
+{
+	// checking static preconditions of subtasks
+	// TODO optimise this ordering ... start with subtasks that are likely to prune something
+	// TODO also prefer preconditions that are likely to prune something
+	if (withStaticPreconditionChecking) for (const auto & subtask : method.subtasks)
+	{
+		// can only check preconditions for primitive tasks
+		if (subtask.taskNo >= domain.nPrimitiveTasks) continue;
+
+		//PossibleConstants possibleSubtaskConstants (subtask.arguments.size ());
+		//for (size_t subtaskVarIdx = 0; subtaskVarIdx < subtask.arguments.size (); ++subtaskVarIdx)
+		//{
+		//	int methodVarIdx = subtask.arguments[subtaskVarIdx];
+		//	possibleSubtaskConstants[subtaskVarIdx] = possibleMethodConstants[methodVarIdx];
+		//}
+
+		for (size_t precID = 0; precID < domain.tasks[subtask.taskNo].preconditions.size(); precID++){
+			if (!staticPredicates[domain.tasks[subtask.taskNo].preconditions[precID].predicateNo])
+				continue;
+			const int & predicate = domain.tasks[subtask.taskNo].preconditions[precID].predicateNo;
+			const std::vector<int> & arguments = domain.tasks[subtask.taskNo].preconditions[precID].arguments;
+			
+			if (arguments.size() == 0) continue; // too buggy
+			
+			DEBUG(
+			   	std::cout << "Subtask " << subtask.taskNo << " " << domain.tasks[subtask.taskNo].name << " has a static precondition on predicate " << predicate << " " << domain.predicates[predicate].name << std::endl;
+			);
+
+			// we have a static precondition, so we can prune along it
+			//PossibleConstants possiblePreconditionConstants (arguments.size());
+			//for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
+			//	int taskVarIndex = arguments[predicateVarIdx];
+			//	possiblePreconditionConstants[predicateVarIdx] = possibleSubtaskConstants[taskVarIndex];
+			//}
+			
+			DEBUG(
+				std::cout << "starting with ";
+			   	bool first = true;
+				for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
+					auto & p = possibleMethodConstants[subtask.arguments[arguments[predicateVarIdx]]];
+					if (!first) std::cout << ",";
+					std::cout << subtask.arguments[arguments[predicateVarIdx]] << "  {";
+			   		bool ffirst = true;
+					for (auto v : p){
+						if (!ffirst) std::cout << ",";
+						std::cout << domain.constants[v];
+						ffirst = false;	
+					}
+					std::cout << "}";
+					first = false;
+				}	
+				std::cout << std::endl;
+					);
+
+			
+			// only do facts that are actually useful
+			int smallestNumberOfInstances = 0x3f3f3f3f;
+			int indexOfSmallest = 0x3f3f3f3f;
+			for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
+				int size = possibleMethodConstants[subtask.arguments[arguments[predicateVarIdx]]].size();
+				if (size < smallestNumberOfInstances){
+					smallestNumberOfInstances = size;
+					indexOfSmallest = predicateVarIdx;
+				}
+			}
+
+			assert(smallestNumberOfInstances != 0x3f3f3f3f);
+
+			DEBUG(std::cout << "Selected variable " << subtask.arguments[arguments[indexOfSmallest]] << " of size " << smallestNumberOfInstances << std::endl);
+
+			// let's check whether we violate something
+			PossibleConstants newPossiblePreconditionConstants (arguments.size());
+			for (const int & val : possibleMethodConstants[subtask.arguments[arguments[indexOfSmallest]]]){
+				auto factsIt = factsPerPredicate[predicate][indexOfSmallest].find(val);
+				if (factsIt == factsPerPredicate[predicate][indexOfSmallest].end()) continue;
+
+				for (int factNo : factsIt->second){
+				  	const Fact & f = problem.init[factNo];
+					// check whether all are ok
+					bool possible = true;
+					for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
+						const ConstantSet & vals = possibleMethodConstants[subtask.arguments[arguments[predicateVarIdx]]];
+						if (!vals.contains(f.arguments[predicateVarIdx])){
+							possible = false;
+							break;
+						}
+					}
+					
+					if (!possible) continue;
+					
+					for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++)
+						newPossiblePreconditionConstants[predicateVarIdx].insert(f.arguments[predicateVarIdx]);
+				}
+			}
+		
+			
+			// writing back the information to the overall arguments of the task
+			for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
+				int taskVarIndex = arguments[predicateVarIdx];
+				int methodVarIndex = subtask.arguments[taskVarIndex];
+			
+				if (possibleMethodConstants[methodVarIndex].size() == newPossiblePreconditionConstants[predicateVarIdx].size())
+					continue; // nothing changed
+
+				possibleMethodConstants[methodVarIndex].intersectWith(newPossiblePreconditionConstants[predicateVarIdx]);
+			}
+
+
+			DEBUG(
+				std::cout << "Pruned arguments to ";
+			   	bool first = true;
+				for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
+					auto & p = possibleMethodConstants[subtask.arguments[arguments[predicateVarIdx]]];
+					if (!first) std::cout << ",";
+					std::cout << "{";
+			   		bool ffirst = true;
+					for (auto v : p){
+						if (!ffirst) std::cout << ",";
+						std::cout << domain.constants[v];
+						ffirst = false;	
+					}
+					std::cout << "}";
+					first = false;
+				}	
+				std::cout << std::endl;
+					);
+		}
+	}
+
+	applyConstraints (possibleMethodConstants, method.variableConstraints);
+
+	// If we have no valid assignment for a variable, we cannot instantiate this method.
+	return std::none_of (possibleMethodConstants.begin (), possibleMethodConstants.end (), [](const auto & possibleValues) { return possibleValues.size () == 0; });
+}
+
+/**
+ * @brief Returns the possible constants of a subtask's variables given the possible constants of the method's variables.
+ */
+static PossibleConstants subtaskConstants (const Domain & domain, const TaskWithArguments & subtask, const PossibleConstants & possibleMethodConstants)
+{
+	PossibleConstants possibleSubtaskConstants (subtask.arguments.size ());
+	for (size_t subtaskVarIdx = 0; subtaskVarIdx < subtask.arguments.size (); ++subtaskVarIdx)
+	{
+		int methodVarIdx = subtask.arguments[subtaskVarIdx];
+		possibleSubtaskConstants[subtaskVarIdx] = possibleMethodConstants[methodVarIdx];
+	}
+	applyConstraints (possibleSubtaskConstants, domain.tasks[subtask.taskNo].variableConstraints);
+
+	return possibleSubtaskConstants;
+}
+
 double contains = 0;
 double restrict = 0;
 double mprep = 0;
 
 
+VisitedTypingIndex::VisitedTypingIndex (size_t numberOfVariables, bool useIncludes) : numberOfVariables (numberOfVariables), useIncludes (useIncludes)
+{
+}
+
+size_t VisitedTypingIndex::hashOf (const PossibleConstants & possibleConstants)
+{
+	size_t h = possibleConstants.size ();
+	for (const ConstantSet & constants : possibleConstants)
+		h = h * 601 + constants.hash ();
+	return h;
+}
+
+int VisitedTypingIndex::find (const std::vector<PossibleConstants> & visited, const PossibleConstants & possibleConstants) const
+{
+	assert (visited.size () == numberOfEntries);
+	assert (possibleConstants.size () == numberOfVariables);
+
+	if (!useIncludes){
+		// the visited entries are pairwise different, so there is at most one equal entry
+		auto [begin, end] = entriesByHash.equal_range (hashOf (possibleConstants));
+		for (auto it = begin; it != end; ++it)
+			if (visited[it->second] == possibleConstants)
+				return it->second;
+		return -1;
+	}
+
+	std::vector<uint64_t> ownSignatures (numberOfVariables);
+	for (size_t varIdx = 0; varIdx < numberOfVariables; varIdx++)
+		ownSignatures[varIdx] = possibleConstants[varIdx].signature ();
+
+	for (size_t entry = 0; entry < numberOfEntries; entry++){
+		const uint64_t * entrySignatures = signatures.data () + entry * numberOfVariables;
+		bool candidate = true;
+		for (size_t varIdx = 0; varIdx < numberOfVariables; varIdx++)
+			if (ownSignatures[varIdx] & ~entrySignatures[varIdx]){
+				candidate = false;
+				break;
+			}
+		if (!candidate) continue;
+
+		const PossibleConstants & visitedConstants = visited[entry];
+		bool included = true;
+		for (size_t varIdx = 0; varIdx < numberOfVariables; varIdx++)
+			if (!possibleConstants[varIdx].isSubsetOf (visitedConstants[varIdx])){
+				included = false;
+				break;
+			}
+		if (included)
+			return entry;
+	}
+	return -1;
+}
+
+void VisitedTypingIndex::add (const PossibleConstants & possibleConstants)
+{
+	assert (possibleConstants.size () == numberOfVariables);
+	if (useIncludes){
+		for (const ConstantSet & constants : possibleConstants)
+			signatures.push_back (constants.signature ());
+	} else
+		entriesByHash.emplace (hashOf (possibleConstants), numberOfEntries);
+	numberOfEntries++;
+}
+
+
 HierarchyTyping::HierarchyTyping (const Domain & domain, const Problem & problem,
 			grounding_configuration & config, given_plan_typing_information & given_typing, bool pruneIfIncluded, bool generateFullGraph) : 
 				domain(&domain),
@@ -124,26 +346,19 @@ HierarchyTyping::HierarchyTyping (const Domain & domain, const Problem & problem
 {
 	useIncludesForContainsTest = pruneIfIncluded;
 	createWholeGraph = generateFullGraph;
+
+	for (size_t taskID = 0; taskID < domain.nTotalTasks; taskID++)
+		visitedTypingsPerTask.emplace_back (domain.tasks[taskID].variableSorts.size (), useIncludesForContainsTest);
 	
 	assert(domain.tasks.size() > problem.initialAbstractTask);
 	
-	std::vector<bool> staticPredicates;
+	// predicates that are definitely static s.t. we can already prune using them here, determined along with the domain
+	const std::vector<bool> & staticPredicates = domain.staticPredicates;
 	std::vector<std::vector<std::map<int,std::vector<int>>>> factsPerPredicate (domain.predicates.size());
 	
 	if (config.withStaticPreconditionChecking){
 		if (!config.quietMode) std::cout << "Starting Preparations for Hierarchy Typing" << std::endl;
 	
-		// determine predicates that are definitely static s.t. we can already prune using them here
-		for (size_t predicateID = 0; predicateID < domain.predicates.size(); predicateID++)
-			staticPredicates.push_back(true);
-		
-		for (size_t taskID = 0; taskID < domain.nPrimitiveTasks; taskID++){
-			for (size_t addID = 0; addID < domain.tasks[taskID].effectsAdd.size(); addID++)
-				staticPredicates[domain.tasks[taskID].effectsAdd[addID].predicateNo] = false;
-			for (size_t delID = 0; delID < domain.tasks[taskID].effectsDel.size(); delID++)
-				staticPredicates[domain.tasks[taskID].effectsDel[delID].predicateNo] = false;
-		}
-	
 		DEBUG(
 			for (size_t predicateID = 0; predicateID < domain.predicates.size(); predicateID++)
 				std::cout << "Predicate " << predicateID << " " << domain.predicates[predicateID].name << " is static" << std::endl;
@@ -169,7 +384,7 @@ HierarchyTyping::HierarchyTyping (const Domain & domain, const Problem & problem
 	// Initially determine possible constants for the top task
 	PossibleConstants topTaskPossibleConstants (topTask.variableSorts.size ());
 	for (size_t varIdx = 0; varIdx < topTask.variableSorts.size (); ++varIdx)
-		topTaskPossibleConstants[varIdx] = domain.sorts[varIdx].members;
+		topTaskPossibleConstants[varIdx] = ConstantSet::fromBits (domain.sorts[varIdx].memberBits);
 	applyConstraints (topTaskPossibleConstants, topTask.variableConstraints);
 	
 	if (!config.quietMode) std::cout << "done." << std::endl;
@@ -177,15 +392,26 @@ HierarchyTyping::HierarchyTyping (const Domain & domain, const Problem & problem
 	if (!config.quietMode) std::cout << "Starting Hierarchy Typing" << std::endl;
 	// Start the DFS at the top task
 			
+	// the parallel exploration only gives the same results if typings included in others are skipped
+	bool parallel = config.parallelHierarchyTyping && useIncludesForContainsTest && !createWholeGraph;
 	std::clock_t ht_start = std::clock();
-	taskDfs (domain, problem, config.withStaticPreconditionChecking, staticPredicates, factsPerPredicate, problem.initialAbstractTask, topTaskPossibleConstants);
+	if (parallel)
+		parallelTaskDfs (domain, problem, config.withStaticPreconditionChecking, staticPredicates, factsPerPredicate, topTaskPossibleConstants, config.threads, config.quietMode);
+	else
+		taskDfs (domain, problem, config.withStaticPreconditionChecking, staticPredicates, factsPerPredicate, problem.initialAbstractTask, topTaskPossibleConstants);
 	std::clock_t ht_end = std::clock();
+	// the index is only needed during the DFS
+	visitedTypingsPerTask.clear ();
+	visitedTypingsPerTask.shrink_to_fit ();
 	double time_elapsed_ms = 1000.0 * (ht_end-ht_start) / CLOCKS_PER_SEC;
 	if (!config.quietMode){
 		std::cout << "Total " << time_elapsed_ms << "ms" << std::endl;
-		std::cout << "Contains " << contains	<< "ms" << std::endl;
-		std::cout << "Restrict " << restrict << "ms" << std::endl;
-		std::cout << "MPrep " << mprep << "ms" << std::endl;
+		// the parallel exploration does not measure its parts
+		if (!parallel){
+			std::cout << "Contains " << contains	<< "ms" << std::endl;
+			std::cout << "Restrict " << restrict << "ms" << std::endl;
+			std::cout << "MPrep " << mprep << "ms" << std::endl;
+		}
 	}
 	if (!config.quietMode) std::cout << "Finished Hierarchy Typing" << std::endl;
 
@@ -199,65 +425,27 @@ HierarchyTyping::HierarchyTyping (const Domain & domain, const Problem & problem
 	);
 
 	// splitting
-	possibleConstantsSplitted.resize(domain.nTotalTasks);
-	for (size_t taskID = 0; taskID < domain.nTotalTasks; taskID++){
-		possibleConstantsSplitted[taskID].resize(domain.tasks[taskID].variableSorts.size());
-		for (size_t pc = 0; pc < possibleConstantsPerTask[taskID].size(); pc++){
-			for (size_t varIDX = 0; varIDX < domain.tasks[taskID].variableSorts.size(); varIDX++){
-				for (int e : possibleConstantsPerTask[taskID][pc][varIDX])
-					possibleConstantsSplitted[taskID][varIDX][e].push_back(pc);
-			}
-		}
-	}
+	possibleConstantsSplitted.reserve(domain.nTotalTasks);
+	for (size_t taskID = 0; taskID < domain.nTotalTasks; taskID++)
+		possibleConstantsSplitted.emplace_back(possibleConstantsPerTask[taskID], domain.tasks[taskID].variableSorts.size());
 
-	
-	possibleConstantsPerMethodSplitted.resize(domain.decompositionMethods.size());
-	for (size_t methodID = 0; methodID < domain.decompositionMethods.size(); methodID++){
-		possibleConstantsPerMethodSplitted[methodID].resize(domain.decompositionMethods[methodID].variableSorts.size());
-		
-		for (size_t pc = 0; pc < possibleConstantsPerMethod[methodID].size(); pc++){
-			for (size_t varIDX = 0; varIDX < domain.decompositionMethods[methodID].variableSorts.size(); varIDX++){
-				for (int e : possibleConstantsPerMethod[methodID][pc][varIDX])
-					possibleConstantsPerMethodSplitted[methodID][varIDX][e].push_back(pc);
-			}
-		}
-	}
+	possibleConstantsPerMethodSplitted.reserve(domain.decompositionMethods.size());
+	for (size_t methodID = 0; methodID < domain.decompositionMethods.size(); methodID++)
+		possibleConstantsPerMethodSplitted.emplace_back(possibleConstantsPerMethod[methodID], domain.decompositionMethods[methodID].variableSorts.size());
 }
 
 
-int HierarchyTyping::taskDfs (const Domain & domain, const Problem & problem, bool withStaticPreconditionChecking, const std::vector<bool> & staticPredicates, std::vector<std::vector<std::map<int,std::vector<int>>>> & factsPerPredicate, size_t taskNo, PossibleConstants possibleConstants)
+int HierarchyTyping::taskDfs (const Domain & domain, const Problem & problem, bool withStaticPreconditionChecking, const std::vector<bool> & staticPredicates, const std::vector<std::vector<std::map<int,std::vector<int>>>> & factsPerPredicate, size_t taskNo, PossibleConstants possibleConstants)
 {
 	const Task & task = domain.tasks[taskNo];
 
 	// Stop recursion if we already found this set of possible constants
 	std::clock_t ht_start = std::clock();
-	for (size_t i = 0; i < possibleConstantsPerTask[taskNo].size(); i++)
-	{
-		PossibleConstants & visitedConstants = possibleConstantsPerTask[taskNo][i];
-		assert (visitedConstants.size () == task.variableSorts.size ());
-
-		bool visited = true;
-		for (size_t varIdx = 0; varIdx < task.variableSorts.size (); ++varIdx)
-		{
-			if (useIncludesForContainsTest) {
-				// this one is new if it is not included in the other one 
-				if (!std::includes (visitedConstants[varIdx].begin (), visitedConstants[varIdx].end (), possibleConstants[varIdx].begin (), possibleConstants[varIdx].end ()))
-				{
-					visited = false;
-					break;
-				}
-			} else {
-				if (visitedConstants[varIdx] != possibleConstants[varIdx]){
-					visited = false;
-					break;
-				}
-			}
-		}
-
-		if (visited){
-			DEBUG(std::cout << "Already visited" << std::endl);
-			return i;
-		}
+	// with useIncludesForContainsTest, this one is new if it is not included in another one
+	int visitedIndex = visitedTypingsPerTask[taskNo].find (possibleConstantsPerTask[taskNo], possibleConstants);
+	if (visitedIndex != -1){
+		DEBUG(std::cout << "Already visited" << std::endl);
+		return visitedIndex;
 	}
 	std::clock_t ht_end = std::clock();
 	double time_elapsed_ms = 1000.0 * (ht_end-ht_start) / CLOCKS_PER_SEC;
@@ -273,8 +461,7 @@ int HierarchyTyping::taskDfs (const Domain & domain, const Problem & problem, bo
 	   		bool ffirst = true;
 			for (auto v : p){
 				if (!ffirst) std::cout << ",";
-				if (v >= 0) std::cout << domain.constants[v];
-				else std::cout << domain.sorts[-v-1].name;
+				std::cout << domain.constants[v];
 				ffirst = false;	
 			}
 			std::cout << "}";
@@ -290,6 +477,7 @@ int HierarchyTyping::taskDfs (const Domain & domain, const Problem & problem, bo
 		possibleTasksToApplicablePossibleMethods[taskNo].push_back(_empty);
 	}
 
+	visitedTypingsPerTask[taskNo].add (possibleConstants);
 	possibleConstantsPerTask[taskNo].push_back (possibleConstants);
 
 	for (int methodNo : task.decompositionMethods)
@@ -298,220 +486,20 @@ int HierarchyTyping::taskDfs (const Domain & domain, const Problem & problem, bo
 		const DecompositionMethod & method = domain.decompositionMethods[methodNo];
 		assert (task.variableSorts.size () == method.taskParameters.size ());
 
-		// Determine possible constants for this method
-		//
-		//   -> we put a -s-1 into variables that have the full variable type (saves a lot of runtime in certain domains, especially Minecraft)
-		//
-		PossibleConstants possibleMethodConstants (method.variableSorts.size ());
-		for (size_t methodVarIdx = 0; methodVarIdx < method.variableSorts.size (); ++methodVarIdx)
-		{
-			// Initially, we can use all constants from the method variable's sort.
-			int sort = method.variableSorts[methodVarIdx];
-			possibleMethodConstants[methodVarIdx].insert(-sort-1);
-			//  	= domain.sorts[sort].members;
-		}
-		for (size_t taskVarIdx = 0; taskVarIdx < method.taskParameters.size (); ++taskVarIdx)
-		{
-			// For method variables that correspond to task variables, we intersect the possible constants.
-			int methodVarIdx = method.taskParameters[taskVarIdx];
-			// either this already an expanded sort or not ...
-			intersect(possibleMethodConstants[methodVarIdx], possibleConstants[taskVarIdx], domain);
-		}
-	
-		DEBUG(
-			std::cout << "Starting on method" << methodNo << " " << method.name;
-	   		std::cout << "[";
-	   		bool first = true;
-			for (auto p : possibleMethodConstants){
-				if (!first) std::cout << ",";
-				std::cout << "{";
-	   			bool ffirst = true;
-				for (auto v : p){
-					if (!ffirst) std::cout << ",";
-					if (v >= 0) std::cout << domain.constants[v];
-					else std::cout << domain.sorts[-v-1].name;
-					ffirst = false;	
-				}
-				std::cout << "}";
-				first = false;
-			}	
-			std::cout << "]";
-			std::cout << std::endl;
-		);
-	
+		PossibleConstants possibleMethodConstants = initialMethodConstants (domain, methodNo, possibleConstants);
+
 		std::clock_t r_start = std::clock();
 		double time_elapsed_ms = 1000.0 * (r_start-m_start) / CLOCKS_PER_SEC;
 		mprep += time_elapsed_ms;	
 
-		// checking static preconditions of subtasks
-		// TODO optimise this ordering ... start with subtasks that are likely to prune something
-		// TODO also prefer preconditions that are likely to prune something
-		if (withStaticPreconditionChecking) for (const auto & subtask : method.subtasks)
-		{
-			// can only check preconditions for primitive tasks
-			if (subtask.taskNo >= domain.nPrimitiveTasks) continue;
-
-			//PossibleConstants possibleSubtaskConstants (subtask.arguments.size ());
-			//for (size_t subtaskVarIdx = 0; subtaskVarIdx < subtask.arguments.size (); ++subtaskVarIdx)
-			//{
-			//	int methodVarIdx = subtask.arguments[subtaskVarIdx];
-			//	possibleSubtaskConstants[subtaskVarIdx] = possibleMethodConstants[methodVarIdx];
-			//}
+		bool instantiable = restrictMethodConstants (domain, problem, withStaticPreconditionChecking, staticPredicates, factsPerPredicate, method, possibleMethodConstants);
 
-			for (size_t precID = 0; precID < domain.tasks[subtask.taskNo].preconditions.size(); precID++){
-				if (!staticPredicates[domain.tasks[subtask.taskNo].preconditions[precID].predicateNo])
-					continue;
-				const int & predicate = domain.tasks[subtask.taskNo].preconditions[precID].predicateNo;
-				const std::vector<int> & arguments = domain.tasks[subtask.taskNo].preconditions[precID].arguments;
-				
-				if (arguments.size() == 0) continue; // too buggy
-				
-				DEBUG(
-				   	std::cout << "Subtask " << subtask.taskNo << " " << domain.tasks[subtask.taskNo].name << " has a static precondition on predicate " << predicate << " " << domain.predicates[predicate].name << std::endl;
-				);
-
-				// we have a static precondition, so we can prune along it
-				//PossibleConstants possiblePreconditionConstants (arguments.size());
-				//for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
-				//	int taskVarIndex = arguments[predicateVarIdx];
-				//	possiblePreconditionConstants[predicateVarIdx] = possibleSubtaskConstants[taskVarIndex];
-				//}
-				
-				DEBUG(
-					std::cout << "starting with ";
-				   	bool first = true;
-					for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
-						auto & p = possibleMethodConstants[subtask.arguments[arguments[predicateVarIdx]]];
-						if (!first) std::cout << ",";
-						std::cout << subtask.arguments[arguments[predicateVarIdx]] << "  {";
-				   		bool ffirst = true;
-						for (auto v : p){
-							if (!ffirst) std::cout << ",";
-							if (v >= 0) std::cout << domain.constants[v];
-							else std::cout << domain.sorts[-v-1].name;
-							ffirst = false;	
-						}
-						std::cout << "}";
-						first = false;
-					}	
-					std::cout << std::endl;
-						);
-	
-				
-				// only do facts that are actually useful
-				int smallestNumberOfInstances = 0x3f3f3f3f;
-				int indexOfSmallest = 0x3f3f3f3f;
-				for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
-					int size = possibleMethodConstants[subtask.arguments[arguments[predicateVarIdx]]].size();
-					if (size == 1 && *(possibleMethodConstants[subtask.arguments[arguments[predicateVarIdx]]].begin()) < 0)
-						continue;
-					if (size < smallestNumberOfInstances){
-						smallestNumberOfInstances = size;
-						indexOfSmallest = predicateVarIdx;
-					}
-				}
-
-				if (smallestNumberOfInstances == 0x3f3f3f3f){
-					// everything is a full sort ...
-					for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
-						int sort = *(possibleMethodConstants[subtask.arguments[arguments[predicateVarIdx]]].begin());
-						sort = -sort - 1;
-						int size = domain.sorts[sort].members.size();
-						if (size < smallestNumberOfInstances){
-							smallestNumberOfInstances = size;
-							indexOfSmallest = predicateVarIdx;
-						}
-					}
-					assert(smallestNumberOfInstances != 0x3f3f3f3f);
-					int sort = *(possibleMethodConstants[subtask.arguments[arguments[indexOfSmallest]]].begin());
-					sort = -sort - 1;
-					possibleMethodConstants[subtask.arguments[arguments[indexOfSmallest]]] = domain.sorts[sort].members;
-
-				}
-
-				assert(smallestNumberOfInstances != 0x3f3f3f3f);
-
-				DEBUG(std::cout << "Selected variable " << subtask.arguments[arguments[indexOfSmallest]] << " of size " << smallestNumberOfInstances << std::endl);
-
-				// let's check whether we violate something
-				PossibleConstants newPossiblePreconditionConstants (arguments.size());
-				for (const int & val : possibleMethodConstants[subtask.arguments[arguments[indexOfSmallest]]])
-					for (int factNo : factsPerPredicate[predicate][indexOfSmallest][val]){
-					  	const Fact & f = problem.init[factNo];
-						// check whether all are ok
-						bool possible = true;
-						for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
-							std::set<int> & vals = possibleMethodConstants[subtask.arguments[arguments[predicateVarIdx]]];
-							int constant = f.arguments[predicateVarIdx];
-							if (vals.size() == 1 && *(vals.begin()) < 0){
-								if (domain.sorts[-(*(vals.begin())) - 1].members.count(constant) == 0){
-									possible = false;
-									break;
-								}
-							} else if (vals.count(constant) == 0){
-								possible = false;
-								break;
-							}
-						}
-						
-						if (!possible) continue;
-						
-						for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++)
-							newPossiblePreconditionConstants[predicateVarIdx].insert(f.arguments[predicateVarIdx]);
-					}
-			
-				
-				// writing back the information to the overall arguments of the task
-				for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
-					int taskVarIndex = arguments[predicateVarIdx];
-					int methodVarIndex = subtask.arguments[taskVarIndex];
-				
-					if (possibleMethodConstants[methodVarIndex].size() != 1 || *(possibleMethodConstants[methodVarIndex].begin()) >= 0)	
-						if (possibleMethodConstants[methodVarIndex].size() == newPossiblePreconditionConstants[predicateVarIdx].size())
-							continue; // nothing changed
-
-					intersect(possibleMethodConstants[methodVarIndex], newPossiblePreconditionConstants[predicateVarIdx], domain);
-				}
-
-
-				DEBUG(
-					std::cout << "Pruned arguments to ";
-				   	bool first = true;
-					for (size_t predicateVarIdx = 0; predicateVarIdx < arguments.size(); predicateVarIdx++){
-						auto & p = possibleMethodConstants[subtask.arguments[arguments[predicateVarIdx]]];
-						if (!first) std::cout << ",";
-						std::cout << "{";
-				   		bool ffirst = true;
-						for (auto v : p){
-							if (!ffirst) std::cout << ",";
-							if (v >= 0) std::cout << domain.constants[v];
-							else std::cout << domain.sorts[-v-1].name;
-							ffirst = false;	
-						}
-						std::cout << "}";
-						first = false;
-					}	
-					std::cout << std::endl;
-						);
-			}
-		}
-
-		// expand yet unexpanded arguments
-		for (size_t methodVarIdx = 0; methodVarIdx < method.variableSorts.size (); ++methodVarIdx)
-		{
-			// For method variables that correspond to task variables, we intersect the possible constants.
-			if (possibleMethodConstants[methodVarIdx].size() == 1 && *(possibleMethodConstants[methodVarIdx].begin()) < 0){
-				int sort = -(*(possibleMethodConstants[methodVarIdx].begin())) - 1;
-				possibleMethodConstants[methodVarIdx] = domain.sorts[sort].members;
-			}
-		}
-	
-		applyConstraints (possibleMethodConstants, method.variableConstraints);
-
-		//if (taskNo == 14) exit(0);
+		std::clock_t r_end = std::clock();
+		time_elapsed_ms = 1000.0 * (r_end-r_start) / CLOCKS_PER_SEC;
+		restrict += time_elapsed_ms;	
 
 		// If we have no valid assignment for a variable, we cannot instantiate this method.
-		if (std::any_of (possibleMethodConstants.begin (), possibleMethodConstants.end (), [](const auto & possibleValues) { return possibleValues.size () == 0; }))
+		if (!instantiable)
 			continue;
 
 		int methodTypingIndex = possibleConstantsPerMethod[methodNo].size();
@@ -523,26 +511,12 @@ int HierarchyTyping::taskDfs (const Domain & domain, const Problem & problem, bo
 		}
 
 		possibleConstantsPerMethod[methodNo].push_back (possibleMethodConstants);
-		
-
-
-		std::clock_t r_end = std::clock();
-		time_elapsed_ms = 1000.0 * (r_end-r_start) / CLOCKS_PER_SEC;
-		restrict += time_elapsed_ms;	
-		
-		
 
 		for (const auto & subtask : method.subtasks)
 		{
 			assert (subtask.arguments.size () == domain.tasks[subtask.taskNo].variableSorts.size ());
 
-			PossibleConstants possibleSubtaskConstants (subtask.arguments.size ());
-			for (size_t subtaskVarIdx = 0; subtaskVarIdx < subtask.arguments.size (); ++subtaskVarIdx)
-			{
-				int methodVarIdx = subtask.arguments[subtaskVarIdx];
-				possibleSubtaskConstants[subtaskVarIdx] = possibleMethodConstants[methodVarIdx];
-			}
-			applyConstraints (possibleSubtaskConstants, domain.tasks[subtask.taskNo].variableConstraints);
+			PossibleConstants possibleSubtaskConstants = subtaskConstants (domain, subtask, possibleMethodConstants);
 
 			DEBUG(
 				std::cout << "Coming from " << taskNo << " " << domain.tasks[taskNo].name;
@@ -560,28 +534,160 @@ int HierarchyTyping::taskDfs (const Domain & domain, const Problem & problem, bo
 	return taskTypingIndex;
 }
 
-static bool isAssignmentCompatibleSplitted (const std::vector<PossibleConstants> & allConstants, const std::vector<int> & actuallyPossibleConstants, const VariableAssignment & assignedVariables)
+/**
+ * @brief Returns the typings that are not included in another one, ordered by decreasing number of constants and then canonically.
+ */
+static std::vector<PossibleConstants> maximalTypings (std::vector<PossibleConstants> typings)
+{
+	if (typings.empty ()) return typings;
+
+	std::vector<size_t> numberOfConstants;
+	for (const PossibleConstants & typing : typings)
+		numberOfConstants.push_back (std::accumulate (typing.begin (), typing.end (), size_t (0), [] (size_t sum, const ConstantSet & constants) { return sum + constants.size (); }));
+
+	std::vector<size_t> order (typings.size ());
+	std::iota (order.begin (), order.end (), 0);
+	std::sort (order.begin (), order.end (), [&] (size_t a, size_t b) {
+		if (numberOfConstants[a] != numberOfConstants[b]) return numberOfConstants[a] > numberOfConstants[b];
+		return typings[a] < typings[b];
+	});
+
+	// a typing can only be included in one with at least as many constants, which comes earlier
+	VisitedTypingIndex index (typings[0].size (), true);
+	std::vector<PossibleConstants> result;
+	for (size_t typing : order)
+		if (index.find (result, typings[typing]) == -1){
+			index.add (typings[typing]);
+			result.push_back (std::move (typings[typing]));
+		}
+	return result;
+}
+
+void HierarchyTyping::parallelTaskDfs (const Domain & domain, const Problem & problem, bool withStaticPreconditionChecking, const std::vector<bool> & staticPredicates, const std::vector<std::vector<std::map<int,std::vector<int>>>> & factsPerPredicate, const PossibleConstants & topTaskPossibleConstants, int threads, bool quietMode)
 {
-	for (const int & possibleID : actuallyPossibleConstants)
-	{
-		const auto & possibleConstants = allConstants[possibleID];
-		bool valid = true;
-		for (size_t varIdx = 0; varIdx < possibleConstants.size (); ++varIdx)
-		{
-			int varValue = assignedVariables[varIdx];
-			if (assignedVariables.NOT_ASSIGNED != varValue && possibleConstants[varIdx].count (varValue) == 0)
-			{
-				valid = false;
-				break;
+	auto start = std::chrono::steady_clock::now ();
+
+	std::vector<std::mutex> taskMutexes (domain.nTotalTasks);
+	std::vector<std::mutex> methodMutexes (domain.decompositionMethods.size ());
+
+	// stores a typing of a task unless it is included in a stored one, and returns whether it was stored
+	auto visit = [&] (int taskNo, const PossibleConstants & possibleConstants) {
+		std::lock_guard<std::mutex> lock (taskMutexes[taskNo]);
+		if (visitedTypingsPerTask[taskNo].find (possibleConstantsPerTask[taskNo], possibleConstants) != -1)
+			return false;
+		visitedTypingsPerTask[taskNo].add (possibleConstants);
+		possibleConstantsPerTask[taskNo].push_back (possibleConstants);
+		return true;
+	};
+
+	// typings of tasks stored in the last round, whose methods have yet to be explored
+	std::vector<std::pair<int, PossibleConstants>> frontier;
+	visit (problem.initialAbstractTask, topTaskPossibleConstants);
+	frontier.emplace_back (problem.initialAbstractTask, topTaskPossibleConstants);
+
+	ThreadPool threadPool (threads);
+	std::vector<std::vector<std::pair<int, PossibleConstants>>> nextFrontiers (threadPool.size ());
+	size_t numberOfRounds = 0;
+	size_t numberOfJobs = 0;
+
+	while (!frontier.empty ()){
+		// one job per typing and decomposition method of its task
+		std::vector<std::pair<size_t, int>> jobs;
+		for (size_t typing = 0; typing < frontier.size (); typing++)
+			for (int methodNo : domain.tasks[frontier[typing].first].decompositionMethods)
+				jobs.emplace_back (typing, methodNo);
+
+		if (!jobs.empty ()) threadPool.run (jobs.size (), [&] (size_t jobIdx, size_t workerIdx) {
+			auto [typing, methodNo] = jobs[jobIdx];
+			const DecompositionMethod & method = domain.decompositionMethods[methodNo];
+
+			PossibleConstants possibleMethodConstants = initialMethodConstants (domain, methodNo, frontier[typing].second);
+			if (!restrictMethodConstants (domain, problem, withStaticPreconditionChecking, staticPredicates, factsPerPredicate, method, possibleMethodConstants))
+				return;
+
+			for (const auto & subtask : method.subtasks){
+				PossibleConstants possibleSubtaskConstants = subtaskConstants (domain, subtask, possibleMethodConstants);
+				if (visit (subtask.taskNo, possibleSubtaskConstants))
+					nextFrontiers[workerIdx].emplace_back (subtask.taskNo, std::move (possibleSubtaskConstants));
 			}
+
+			std::lock_guard<std::mutex> lock (methodMutexes[methodNo]);
+			possibleConstantsPerMethod[methodNo].push_back (std::move (possibleMethodConstants));
+		});
+
+		numberOfRounds++;
+		numberOfJobs += jobs.size ();
+		frontier.clear ();
+		for (auto & nextFrontier : nextFrontiers){
+			std::move (nextFrontier.begin (), nextFrontier.end (), std::back_inserter (frontier));
+			nextFrontier.clear ();
 		}
-		if (valid)
-			return true;
+	}
+
+	// which of the typings of a task or method are stored depends on the timing, but the ones not included in another one do not
+	for (auto & typings : possibleConstantsPerTask)
+		typings = maximalTypings (std::move (typings));
+	for (auto & typings : possibleConstantsPerMethod)
+		typings = maximalTypings (std::move (typings));
 
+	double time_elapsed_ms = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+	if (!quietMode)
+		std::cout << "Parallel hierarchy typing: " << numberOfRounds << " rounds with " << numberOfJobs << " jobs on " << threadPool.size () << " threads, "
+			<< threadPool.getNumberOfSteals () << " steals, " << time_elapsed_ms << "ms" << std::endl;
+}
+
+TypingMatrix::TypingMatrix (const std::vector<PossibleConstants> & typings, size_t numberOfVariables) : wordsPerRow ((typings.size () + 63) / 64), rowOfConstant (numberOfVariables)
+{
+	for (size_t varIdx = 0; varIdx < numberOfVariables; varIdx++)
+		for (size_t typing = 0; typing < typings.size (); typing++)
+			for (int constant : typings[typing][varIdx]){
+				std::vector<int> & rowOf = rowOfConstant[varIdx];
+				if (size_t (constant) >= rowOf.size ())
+					rowOf.resize (constant + 1, -1);
+				if (rowOf[constant] == -1){
+					rowOf[constant] = rows.size () / wordsPerRow;
+					rows.resize (rows.size () + wordsPerRow, 0);
+				}
+				rows[rowOf[constant] * wordsPerRow + typing / 64] |= uint64_t (1) << (typing % 64);
+			}
+
+	for (std::vector<int> & rowOf : rowOfConstant)
+		rowOf.shrink_to_fit ();
+	rows.shrink_to_fit ();
+}
+
+bool TypingMatrix::isAssignmentCompatible (const VariableAssignment & assignedVariables) const
+{
+	bool anyAssigned = false;
+	for (size_t varIdx = 0; varIdx < rowOfConstant.size (); ++varIdx){
+		int e = assignedVariables[varIdx];
+		if (e == assignedVariables.NOT_ASSIGNED) continue;
+		if (size_t (e) >= rowOfConstant[varIdx].size () || rowOfConstant[varIdx][e] == -1) return false;
+		anyAssigned = true;
+	}
+	if (!anyAssigned) return wordsPerRow > 0; // nothing constrained yet, so any typing will do, if there is one
+
+	// AND the rows of all assigned variables, one word of typings at a time
+	for (size_t word = 0; word < wordsPerRow; ++word){
+		uint64_t typings = ~uint64_t (0);
+		for (size_t varIdx = 0; varIdx < rowOfConstant.size (); ++varIdx){
+			int e = assignedVariables[varIdx];
+			if (e != assignedVariables.NOT_ASSIGNED)
+				typings &= rows[rowOfConstant[varIdx][e] * wordsPerRow + word];
+		}
+		if (typings) return true;
 	}
 	return false;
 }
 
+size_t TypingMatrix::memoryUsage (void) const
+{
+	size_t bytes = sizeof (TypingMatrix) + rowOfConstant.capacity () * sizeof (std::vector<int>) + rows.capacity () * sizeof (uint64_t);
+	for (const std::vector<int> & rowOf : rowOfConstant)
+		bytes += rowOf.capacity () * sizeof (int);
+	return bytes;
+}
+
 
 static bool isAssignmentCompatible (const std::vector<PossibleConstants> & possibleConstants, const VariableAssignment & assignedVariables)
 {
@@ -591,7 +697,7 @@ static bool isAssignmentCompatible (const std::vector<PossibleConstants> & possi
 		for (size_t varIdx = 0; varIdx < possibleConstants.size (); ++varIdx)
 		{
 			int varValue = assignedVariables[varIdx];
-			if (assignedVariables.NOT_ASSIGNED != varValue && possibleConstants[varIdx].count (varValue) == 0)
+			if (assignedVariables.NOT_ASSIGNED != varValue && !possibleConstants[varIdx].contains (varValue))
 			{
 				valid = false;
 				break;
@@ -611,8 +717,13 @@ bool HierarchyTyping::isAssignmentCompatible<Task> (int taskNo, const VariableAs
 
 	if (given_typing.info.size() != 0){
 		if (given_typing.artificialTasks.count(taskNo) == 0){
+			// tasks without any given typing can't be executed. Don't insert them here, the parallel GPG calls this concurrently
+			auto typingIt = given_typing.info.find(taskNo);
+			if (typingIt == given_typing.info.end())
+				return false;
+
 			bool okAssignment = false;
-			for (std::vector<int> const & possible : const_cast<HierarchyTyping*>(this)->given_typing.info[taskNo]){
+			for (std::vector<int> const & possible : typingIt->second){
 				bool thisOK = true;
 				for (unsigned int i = 0; i < possible.size(); i++){
 
@@ -634,51 +745,72 @@ bool HierarchyTyping::isAssignmentCompatible<Task> (int taskNo, const VariableAs
 		}
 	}
 
-	int best = -1;
-	int bestSize = 0x3f3f3f3f;
-	for (size_t varIdx = 0; varIdx < assignedVariables.assignments.size (); ++varIdx){
-		int e = assignedVariables[varIdx]; 
-		if (e == assignedVariables.NOT_ASSIGNED) continue;
-		auto it = possibleConstantsSplitted[taskNo][varIdx].find(e);
-		if (it == possibleConstantsSplitted[taskNo][varIdx].end()) return false;
-		if (bestSize > it->second.size()){
-			best = varIdx;
-			bestSize = it->second.size();
-		}
-	}
-	if (best != -1){
-		int e = assignedVariables[best]; 
-		return ::isAssignmentCompatibleSplitted(possibleConstantsPerTask[taskNo], possibleConstantsSplitted[taskNo][best].at(e), assignedVariables);
-	}
-
-	if (best == -1 && assignedVariables.assignments.size()) return true; // nothing constrained yet
+	// the splitted possible constants may have been dropped to save memory, tasks without variables have none
+	if (possibleConstantsSplitted[taskNo].rowOfConstant.empty())
+		return ::isAssignmentCompatible (possibleConstantsPerTask[taskNo], assignedVariables);
 
-	return ::isAssignmentCompatible (possibleConstantsPerTask[taskNo], assignedVariables);
+	return possibleConstantsSplitted[taskNo].isAssignmentCompatible (assignedVariables);
 }
 
 template<>
 bool HierarchyTyping::isAssignmentCompatible<DecompositionMethod> (int methodNo, const VariableAssignment & assignedVariables) const
 {
-	int best = -1;
-	int bestSize = 0x3f3f3f3f;
-	for (size_t varIdx = 0; varIdx < assignedVariables.assignments.size (); ++varIdx){
-		int e = assignedVariables[varIdx]; 
-		if (e == assignedVariables.NOT_ASSIGNED) continue;
-		auto it = possibleConstantsPerMethodSplitted[methodNo][varIdx].find(e);
-		if (it == possibleConstantsPerMethodSplitted[methodNo][varIdx].end()) return false;
-		if (bestSize > it->second.size()){
-			best = varIdx;
-			bestSize = it->second.size();
-		}
-	}
-	if (best != -1){
-		int e = assignedVariables[best]; 
-		return ::isAssignmentCompatibleSplitted(possibleConstantsPerMethod[methodNo], possibleConstantsPerMethodSplitted[methodNo][best].at(e), assignedVariables);
+	// the splitted possible constants may have been dropped to save memory, methods without variables have none
+	if (possibleConstantsPerMethodSplitted[methodNo].rowOfConstant.empty())
+		return ::isAssignmentCompatible (possibleConstantsPerMethod[methodNo], assignedVariables);
+
+	return possibleConstantsPerMethodSplitted[methodNo].isAssignmentCompatible (assignedVariables);
+}
+
+
+static size_t possibleConstantsMemoryUsage (const std::vector<PossibleConstants> & allPossibleConstants)
+{
+	size_t bytes = allPossibleConstants.capacity () * sizeof (PossibleConstants);
+	for (const PossibleConstants & possibleConstants : allPossibleConstants)
+	{
+		bytes += (possibleConstants.capacity () - possibleConstants.size ()) * sizeof (ConstantSet);
+		for (const ConstantSet & constants : possibleConstants)
+			bytes += constants.memoryUsage ();
 	}
+	return bytes;
+}
 
-	if (best == -1 && assignedVariables.assignments.size()) return true; // nothing constrained yet
+template<>
+size_t HierarchyTyping::getSplittedMemoryUsage<Task> (int taskNo) const
+{
+	return possibleConstantsSplitted[taskNo].memoryUsage ();
+}
+
+template<>
+size_t HierarchyTyping::getSplittedMemoryUsage<DecompositionMethod> (int methodNo) const
+{
+	return possibleConstantsPerMethodSplitted[methodNo].memoryUsage ();
+}
+
+template<>
+void HierarchyTyping::dropSplitted<Task> (int taskNo)
+{
+	possibleConstantsSplitted[taskNo] = TypingMatrix ();
+}
+
+template<>
+void HierarchyTyping::dropSplitted<DecompositionMethod> (int methodNo)
+{
+	possibleConstantsPerMethodSplitted[methodNo] = TypingMatrix ();
+}
 
-	return ::isAssignmentCompatible (possibleConstantsPerMethod[methodNo], assignedVariables);
+size_t HierarchyTyping::getMemoryUsage (void) const
+{
+	size_t bytes = 0;
+	for (const auto & possibleConstants : possibleConstantsPerTask)
+		bytes += possibleConstantsMemoryUsage (possibleConstants);
+	for (const auto & possibleConstants : possibleConstantsPerMethod)
+		bytes += possibleConstantsMemoryUsage (possibleConstants);
+	for (const auto & splitted : possibleConstantsSplitted)
+		bytes += splitted.memoryUsage ();
+	for (const auto & splitted : possibleConstantsPerMethodSplitted)
+		bytes += splitted.memoryUsage ();
+	return bytes;
 }
 
 
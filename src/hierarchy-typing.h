@@ -20,17 +20,84 @@
  * @{
  */
 
-#include <set>
+#include <cstdint>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 
+#include "constantset.h"
 #include "model.h"
 #include "util.h"
 #include "grounding.h"
 #include "givenPlan.h"
 
 /// Contains a set of possible constants for each variable of a task/method.
-using PossibleConstants = std::vector<std::set<int>>;
+using PossibleConstants = std::vector<ConstantSet>;
+
+/**
+ * @brief For every variable and constant, the bitset of the typings (indices into the PossibleConstants of a task or method) allowing it.
+ *
+ * An assignment is compatible with some typing if the AND of the rows of the assigned variables and their values is not zero.
+ */
+struct TypingMatrix
+{
+	/// Number of 64 bit words per row
+	size_t wordsPerRow = 0;
+
+	/// Per variable, the row of every constant, or -1 if no typing allows the constant. Empty if the matrix was not built or dropped.
+	std::vector<std::vector<int>> rowOfConstant;
+
+	std::vector<uint64_t> rows;
+
+	TypingMatrix (void) = default;
+	TypingMatrix (const std::vector<PossibleConstants> & typings, size_t numberOfVariables);
+
+	/**
+	 * @brief Returns whether some typing allows the values of all assigned variables. Needs at least one variable.
+	 */
+	bool isAssignmentCompatible (const VariableAssignment & assignedVariables) const;
+
+	/**
+	 * @brief Returns the number of bytes used by the matrix.
+	 */
+	size_t memoryUsage (void) const;
+};
+
+/**
+ * @brief Index over the PossibleConstants visited for one task, to find a visited one that is equal to or includes a new one.
+ *
+ * Equality is looked up via a hash of the sets. For inclusion, every visited PossibleConstants has a 64 bit signature per variable
+ * (ConstantSet::signature()). Only entries whose signatures are a superset of the new signatures are compared in full.
+ */
+class VisitedTypingIndex
+{
+public:
+	VisitedTypingIndex (void) = default;
+	VisitedTypingIndex (size_t numberOfVariables, bool useIncludes);
+
+	/**
+	 * @brief Returns the first index into visited that is equal to (or includes, if useIncludes is set) possibleConstants, or -1.
+	 *
+	 * visited must contain exactly the PossibleConstants added so far, in the same order.
+	 */
+	int find (const std::vector<PossibleConstants> & visited, const PossibleConstants & possibleConstants) const;
+
+	/**
+	 * @brief Adds the PossibleConstants that are appended to visited as the next entry.
+	 */
+	void add (const PossibleConstants & possibleConstants);
+
+private:
+	size_t numberOfVariables = 0;
+	bool useIncludes = false;
+	size_t numberOfEntries = 0;
+
+	std::unordered_multimap<size_t, int> entriesByHash;
+	/// numberOfVariables signatures per entry
+	std::vector<uint64_t> signatures;
+
+	static size_t hashOf (const PossibleConstants & possibleConstants);
+};
 
 struct HierarchyTyping
 {
@@ -45,14 +112,20 @@ struct HierarchyTyping
 	std::vector<std::vector<PossibleConstants>> possibleConstantsPerTask;
 
 
-	std::vector<std::vector<std::map<int,std::vector<int>>>> possibleConstantsSplitted;
+	/**
+	 * @brief For each task, the possible constants as a TypingMatrix.
+	 */
+	std::vector<TypingMatrix> possibleConstantsSplitted;
 
 	/**
 	 * @brief Contains a list of PossibleConstants instances for each decomposition method in the domain.
 	 */
 	std::vector<std::vector<PossibleConstants>> possibleConstantsPerMethod;
 	
-	std::vector<std::vector<std::map<int,std::vector<int>>>> possibleConstantsPerMethodSplitted;
+	/**
+	 * @brief For each decomposition method, the possible constants as a TypingMatrix.
+	 */
+	std::vector<TypingMatrix> possibleConstantsPerMethodSplitted;
 
 	/**
 	 * @brief for every HT task, the methods it can be decomposed into
@@ -77,6 +150,28 @@ struct HierarchyTyping
 	template<typename>
 	bool isAssignmentCompatible (int taskNo, const VariableAssignment & assignedVariables) const;
 
+	/**
+	 * @brief Returns an estimate of the bytes used by the splitted possible constants of a task or method.
+	 *
+	 * This templated function is only defined for the Task and DecompositionMethod types.
+	 */
+	template<typename>
+	size_t getSplittedMemoryUsage (int taskNo) const;
+
+	/**
+	 * @brief Frees the splitted possible constants of a task or method.
+	 *
+	 * isAssignmentCompatible() then checks all possible constants of the task or method, which is slower but gives the same result.
+	 * This templated function is only defined for the Task and DecompositionMethod types.
+	 */
+	template<typename>
+	void dropSplitted (int taskNo);
+
+	/**
+	 * @brief Returns an estimate of the bytes used by all tables of the hierarchy typing.
+	 */
+	size_t getMemoryUsage (void) const;
+
 
 	std::string graphToDotString(const Domain & domain);
 
@@ -85,7 +180,20 @@ struct HierarchyTyping
 	/**
 	 * @brief Perform the depth-first search.
 	 */
-	int taskDfs (const Domain & domain, const Problem & problem, bool withStaticPreconditionChecking, const std::vector<bool> & staticPredicates, std::vector<std::vector<std::map<int,std::vector<int>>>> & factsPerPredicate, size_t taskNo, PossibleConstants possibleConstants);
+	int taskDfs (const Domain & domain, const Problem & problem, bool withStaticPreconditionChecking, const std::vector<bool> & staticPredicates, const std::vector<std::vector<std::map<int,std::vector<int>>>> & factsPerPredicate, size_t taskNo, PossibleConstants possibleConstants);
+
+	/**
+	 * @brief Explores the same typings as taskDfs() from the top task, in rounds of parallel jobs on the given number of threads.
+	 *
+	 * Each job takes one typing of a task found in the previous round and one of the task's decomposition methods. The typings are
+	 * stored as they are found, so which typings of a task are included in others depends on the timing. In the end, only the typings
+	 * that are not included in another one are kept, in a canonical order. isAssignmentCompatible() therefore gives the same
+	 * results as after taskDfs(). Only for the inclusion test and without the full graph.
+	 */
+	void parallelTaskDfs (const Domain & domain, const Problem & problem, bool withStaticPreconditionChecking, const std::vector<bool> & staticPredicates, const std::vector<std::vector<std::map<int,std::vector<int>>>> & factsPerPredicate, const PossibleConstants & topTaskPossibleConstants, int threads, bool quietMode);
+
+	/// For each task, the index over its entries in possibleConstantsPerTask
+	std::vector<VisitedTypingIndex> visitedTypingsPerTask;
 
 	// members storing private information
 	bool useIncludesForContainsTest;
@@ -32,8 +32,12 @@ std::tuple<std::vector<Fact>, std::vector<GroundedTask>, std::vector<GroundedMet
 	if (problem.initialAbstractTask != -1 && config.enableHierarchyTyping)
 		hierarchyTyping = std::make_unique<HierarchyTyping> (domain, problem, config, given_typing, true, false);
 
+	// All grounded tasks and methods are allocated in these pools, which free them when grounding is done
+	ObjectPool<GroundedTask> taskPool;
+	ObjectPool<GroundedMethod> methodPool;
+
 	if (!config.quietMode) std::cerr << "Running PG." << std::endl;
-	GpgPlanningGraph pg (domain, problem);
+	GpgPlanningGraph pg (domain, problem, taskPool);
 	std::vector<GpgPlanningGraph::ResultType *> groundedTasksPg;
 	std::set<Fact> reachableFacts;
 	runGpg (pg, groundedTasksPg, reachableFacts, hierarchyTyping.get (), config);
@@ -68,13 +72,10 @@ std::tuple<std::vector<Fact>, std::vector<GroundedTask>, std::vector<GroundedMet
 	
 		std::vector<GroundedMethod> no_methods;
 		
-		std::vector<GpgPlanningGraph::ResultType> returnTasks;
-		for (size_t i = 0; i < groundedTasksPg.size(); i++){
-			returnTasks.push_back(*groundedTasksPg[i]);
-			delete groundedTasksPg[i];
-		}
+		// frees the memory of the pool while the tasks are moved out of it
+		std::vector<GpgPlanningGraph::ResultType> returnTasks = taskPool.drain(groundedTasksPg);
 
-		return std::make_tuple(reachableFactsList, returnTasks, no_methods);
+		return std::make_tuple(std::move(reachableFactsList), std::move(returnTasks), std::move(no_methods));
 	}
 
 	DEBUG(std::cerr << "After lifted PG:" << std::endl;
@@ -129,7 +130,7 @@ std::tuple<std::vector<Fact>, std::vector<GroundedTask>, std::vector<GroundedMet
 	}
 
 	if (!config.quietMode) std::cerr << "Running TDG." << std::endl;
-	GpgTdg tdg (domain, problem, groundedTasksPg);
+	GpgTdg tdg (domain, problem, groundedTasksPg, taskPool, methodPool);
 	std::vector<GpgTdg::ResultType *> groundedMethods;
 	std::set<GpgTdg::StateType> groundedTaskSetTdg;
 	runGpg (tdg, groundedMethods, groundedTaskSetTdg, hierarchyTyping.get (), config);
@@ -140,12 +141,11 @@ std::tuple<std::vector<Fact>, std::vector<GroundedTask>, std::vector<GroundedMet
 
 	// Order grounded tasks correctly
 	std::vector<GroundedTask *> groundedTasksTdg (groundedTaskSetTdg.size ());
-	auto it = groundedTaskSetTdg.begin();
-	while (it != groundedTaskSetTdg.end()){
-		GroundedTask * t = new GroundedTask();
-		*t = *it;
-		groundedTasksTdg[it->groundedNo] = t;
-		it = groundedTaskSetTdg.erase(it);
+	while (!groundedTaskSetTdg.empty()){
+		auto node = groundedTaskSetTdg.extract(groundedTaskSetTdg.begin());
+		GroundedTask * t = taskPool.create();
+		*t = std::move(node.value());
+		groundedTasksTdg[t->groundedNo] = t;
 	}
 
 	// Add grounded decomposition methods to the abstract tasks
@@ -200,7 +200,7 @@ std::tuple<std::vector<Fact>, std::vector<GroundedTask>, std::vector<GroundedMet
 	std::vector<GroundedTask> reachableTasksDfs;
 	std::vector<GroundedMethod> reachableMethodsDfs;
 	std::unordered_set<int> reachableCEGuards;
-	tdgDfs (reachableTasksDfs, reachableMethodsDfs, groundedTasksTdg, groundedMethods, reachableFactsList, reachableCEGuards, domain, problem);
+	tdgDfs (reachableTasksDfs, reachableMethodsDfs, groundedTasksTdg, groundedMethods, taskPool, methodPool, reachableFactsList, reachableCEGuards, domain, problem);
 
 	// add primitive tasks from conditional effects as reachable
 	for (GroundedTask * gt : groundedTasksTdg){
@@ -231,5 +231,5 @@ std::tuple<std::vector<Fact>, std::vector<GroundedTask>, std::vector<GroundedMet
 	validateGroundedList (reachableFactsList);
 
 
-	return std::make_tuple(reachableFactsList, reachableTasksDfs, reachableMethodsDfs);
+	return std::make_tuple(std::move(reachableFactsList), std::move(reachableTasksDfs), std::move(reachableMethodsDfs));
 }
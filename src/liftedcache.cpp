@@ -0,0 +1,500 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "liftedcache.h"
+
+namespace
+{
+	const char cacheMagic[8] = {'P', 'G', 'L', 'I', 'F', 'T', 'E', 'D'};
+	/// Increase whenever the layout of the data or the parsed model changes
+	const uint32_t cacheVersion = 1;
+	/// Stored as written, so a cache from a machine with another byte order does not match
+	const uint32_t byteOrderMark = 0x01020304;
+
+	struct CacheHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t byteOrder;
+		uint64_t inputHash;
+		uint64_t dataSize;
+		uint64_t dataHash;
+	};
+
+	/**
+	 * @brief Appends the binary representation of the model to a string.
+	 */
+	struct CacheWriter
+	{
+		std::string data;
+
+		void raw (const void * bytes, size_t size)
+		{
+			data.append (static_cast<const char *> (bytes), size);
+		}
+	};
+
+	/**
+	 * @brief Reads the binary representation of the model from memory, throwing a BadInputException if it ends early.
+	 */
+	struct CacheReader
+	{
+		const char * position;
+		const char * end;
+
+		void raw (void * bytes, size_t size)
+		{
+			if (size_t (end - position) < size)
+				throw BadInputException ("The lifted cache ends unexpectedly");
+			memcpy (bytes, position, size);
+			position += size;
+		}
+	};
+}
+
+// Every type is stored and loaded by a pair of overloads, which have to be declared before the templates for vectors use them
+
+static void store (CacheWriter & out, int value);
+static void store (CacheWriter & out, const std::string & value);
+static void store (CacheWriter & out, const std::vector<int> & value);
+static void store (CacheWriter & out, const std::pair<int, int> & value);
+static void store (CacheWriter & out, const std::variant<PredicateWithArguments, int> & value);
+static void store (CacheWriter & out, const std::pair<std::vector<PredicateWithArguments>, PredicateWithArguments> & value);
+static void store (CacheWriter & out, const std::pair<Fact, int> & value);
+static void store (CacheWriter & out, const Sort & value);
+static void store (CacheWriter & out, const Predicate & value);
+static void store (CacheWriter & out, const PredicateWithArguments & value);
+static void store (CacheWriter & out, const Fact & value);
+static void store (CacheWriter & out, const TaskWithArguments & value);
+static void store (CacheWriter & out, const VariableConstraint & value);
+static void store (CacheWriter & out, const Task & value);
+static void store (CacheWriter & out, const DecompositionMethod & value);
+
+static void load (CacheReader & in, int & value);
+static void load (CacheReader & in, std::string & value);
+static void load (CacheReader & in, std::vector<int> & value);
+static void load (CacheReader & in, std::pair<int, int> & value);
+static void load (CacheReader & in, std::variant<PredicateWithArguments, int> & value);
+static void load (CacheReader & in, std::pair<std::vector<PredicateWithArguments>, PredicateWithArguments> & value);
+static void load (CacheReader & in, std::pair<Fact, int> & value);
+static void load (CacheReader & in, Sort & value);
+static void load (CacheReader & in, Predicate & value);
+static void load (CacheReader & in, PredicateWithArguments & value);
+static void load (CacheReader & in, Fact & value);
+static void load (CacheReader & in, TaskWithArguments & value);
+static void load (CacheReader & in, VariableConstraint & value);
+static void load (CacheReader & in, Task & value);
+static void load (CacheReader & in, DecompositionMethod & value);
+
+static void storeSize (CacheWriter & out, size_t size)
+{
+	uint32_t value = size;
+	out.raw (&value, sizeof (value));
+}
+
+static size_t loadSize (CacheReader & in)
+{
+	uint32_t value;
+	in.raw (&value, sizeof (value));
+	// every element takes at least one byte, so this catches sizes that cannot be right before allocating anything
+	if (value > size_t (in.end - in.position))
+		throw BadInputException ("The lifted cache contains an invalid size");
+	return value;
+}
+
+template <typename T>
+static void store (CacheWriter & out, const std::vector<T> & value)
+{
+	storeSize (out, value.size ());
+	for (const T & element : value)
+		store (out, element);
+}
+
+template <typename T>
+static void load (CacheReader & in, std::vector<T> & value)
+{
+	value.resize (loadSize (in));
+	for (T & element : value)
+		load (in, element);
+}
+
+static void store (CacheWriter & out, int value)
+{
+	int32_t stored = value;
+	out.raw (&stored, sizeof (stored));
+}
+
+static void load (CacheReader & in, int & value)
+{
+	int32_t stored;
+	in.raw (&stored, sizeof (stored));
+	value = stored;
+}
+
+static void store (CacheWriter & out, const std::string & value)
+{
+	storeSize (out, value.size ());
+	out.raw (value.data (), value.size ());
+}
+
+static void load (CacheReader & in, std::string & value)
+{
+	value.resize (loadSize (in));
+	in.raw (value.data (), value.size ());
+}
+
+// vectors of integers are copied as a whole
+static void store (CacheWriter & out, const std::vector<int> & value)
+{
+	static_assert (sizeof (int) == sizeof (int32_t));
+	storeSize (out, value.size ());
+	out.raw (value.data (), value.size () * sizeof (int));
+}
+
+static void load (CacheReader & in, std::vector<int> & value)
+{
+	value.resize (loadSize (in));
+	in.raw (value.data (), value.size () * sizeof (int));
+}
+
+static void store (CacheWriter & out, const std::pair<int, int> & value)
+{
+	store (out, value.first);
+	store (out, value.second);
+}
+
+static void load (CacheReader & in, std::pair<int, int> & value)
+{
+	load (in, value.first);
+	load (in, value.second);
+}
+
+static void store (CacheWriter & out, const std::variant<PredicateWithArguments, int> & value)
+{
+	store (out, int (value.index ()));
+	if (value.index () == 0)
+		store (out, std::get<PredicateWithArguments> (value));
+	else
+		store (out, std::get<int> (value));
+}
+
+static void load (CacheReader & in, std::variant<PredicateWithArguments, int> & value)
+{
+	int index;
+	load (in, index);
+	if (index == 0)
+		load (in, value.emplace<PredicateWithArguments> ());
+	else
+		load (in, value.emplace<int> ());
+}
+
+static void store (CacheWriter & out, const std::pair<std::vector<PredicateWithArguments>, PredicateWithArguments> & value)
+{
+	store (out, value.first);
+	store (out, value.second);
+}
+
+static void load (CacheReader & in, std::pair<std::vector<PredicateWithArguments>, PredicateWithArguments> & value)
+{
+	load (in, value.first);
+	load (in, value.second);
+}
+
+static void store (CacheWriter & out, const std::pair<Fact, int> & value)
+{
+	store (out, value.first);
+	store (out, value.second);
+}
+
+static void load (CacheReader & in, std::pair<Fact, int> & value)
+{
+	load (in, value.first);
+	load (in, value.second);
+}
+
+// the member bitsets are rebuilt after reading
+static void store (CacheWriter & out, const Sort & value)
+{
+	store (out, value.name);
+	store (out, std::vector<int> (value.members.begin (), value.members.end ()));
+}
+
+static void load (CacheReader & in, Sort & value)
+{
+	load (in, value.name);
+	std::vector<int> members;
+	load (in, members);
+	for (int member : members)
+		value.members.insert (value.members.end (), member);
+}
+
+static void store (CacheWriter & out, const Predicate & value)
+{
+	store (out, value.name);
+	store (out, value.argumentSorts);
+	store (out, int (value.guard_for_conditional_effect));
+}
+
+static void load (CacheReader & in, Predicate & value)
+{
+	load (in, value.name);
+	load (in, value.argumentSorts);
+	int guard;
+	load (in, guard);
+	value.guard_for_conditional_effect = guard;
+}
+
+static void store (CacheWriter & out, const PredicateWithArguments & value)
+{
+	store (out, value.predicateNo);
+	store (out, value.arguments);
+}
+
+static void load (CacheReader & in, PredicateWithArguments & value)
+{
+	load (in, value.predicateNo);
+	load (in, value.arguments);
+}
+
+// the numbers of the grounding are not assigned yet
+static void store (CacheWriter & out, const Fact & value)
+{
+	store (out, value.predicateNo);
+	store (out, value.arguments);
+}
+
+static void load (CacheReader & in, Fact & value)
+{
+	load (in, value.predicateNo);
+	load (in, value.arguments);
+}
+
+static void store (CacheWriter & out, const TaskWithArguments & value)
+{
+	store (out, value.taskNo);
+	store (out, value.arguments);
+}
+
+static void load (CacheReader & in, TaskWithArguments & value)
+{
+	load (in, value.taskNo);
+	load (in, value.arguments);
+}
+
+static void store (CacheWriter & out, const VariableConstraint & value)
+{
+	store (out, int (value.type));
+	store (out, value.var1);
+	store (out, value.var2);
+}
+
+static void load (CacheReader & in, VariableConstraint & value)
+{
+	int type;
+	load (in, type);
+	value.type = type == VariableConstraint::EQUAL ? VariableConstraint::EQUAL : VariableConstraint::NOT_EQUAL;
+	load (in, value.var1);
+	load (in, value.var2);
+}
+
+static void store (CacheWriter & out, const Task & value)
+{
+	store (out, value.name);
+	store (out, value.variableSorts);
+	store (out, value.variableConstraints);
+	store (out, int (value.type));
+	store (out, value.number_of_original_variables);
+	store (out, int (value.isCompiledConditionalEffect));
+	store (out, value.costs);
+	store (out, value.preconditions);
+	store (out, value.effectsDel);
+	store (out, value.effectsAdd);
+	store (out, value.conditionalAdd);
+	store (out, value.conditionalDel);
+	store (out, value.decompositionMethods);
+}
+
+static void load (CacheReader & in, Task & value)
+{
+	load (in, value.name);
+	load (in, value.variableSorts);
+	load (in, value.variableConstraints);
+	int type;
+	load (in, type);
+	value.type = type == Task::PRIMITIVE ? Task::PRIMITIVE : Task::ABSTRACT;
+	load (in, value.number_of_original_variables);
+	int compiled;
+	load (in, compiled);
+	value.isCompiledConditionalEffect = compiled;
+	load (in, value.costs);
+	load (in, value.preconditions);
+	load (in, value.effectsDel);
+	load (in, value.effectsAdd);
+	load (in, value.conditionalAdd);
+	load (in, value.conditionalDel);
+	load (in, value.decompositionMethods);
+}
+
+static void store (CacheWriter & out, const DecompositionMethod & value)
+{
+	store (out, value.name);
+	store (out, value.variableSorts);
+	store (out, value.variableConstraints);
+	store (out, value.taskNo);
+	store (out, value.taskParameters);
+	store (out, value.subtasks);
+	store (out, value.orderingConstraints);
+}
+
+static void load (CacheReader & in, DecompositionMethod & value)
+{
+	load (in, value.name);
+	load (in, value.variableSorts);
+	load (in, value.variableConstraints);
+	load (in, value.taskNo);
+	load (in, value.taskParameters);
+	load (in, value.subtasks);
+	load (in, value.orderingConstraints);
+}
+
+uint64_t hashLiftedInput (std::string_view input)
+{
+	// a multiplicative hash over words of eight bytes, which is fast enough to be computed for every run
+	const uint64_t multiplier = 0xff51afd7ed558ccdULL;
+	uint64_t hash = 0x9e3779b97f4a7c15ULL ^ input.size ();
+	size_t position = 0;
+	for (; position + 8 <= input.size (); position += 8)
+	{
+		uint64_t word;
+		memcpy (&word, input.data () + position, 8);
+		hash = (hash ^ word) * multiplier;
+		hash ^= hash >> 32;
+	}
+	uint64_t tail = 0;
+	memcpy (&tail, input.data () + position, input.size () - position);
+	hash = (hash ^ tail) * multiplier;
+	hash ^= hash >> 29;
+	return hash;
+}
+
+bool writeLiftedCache (const std::string & filename, const Domain & domain, const Problem & problem, uint64_t inputHash)
+{
+	CacheWriter out;
+	store (out, domain.constants);
+	store (out, domain.sorts);
+	store (out, domain.predicates);
+	store (out, domain.predicateMutexes);
+	store (out, domain.functions);
+	store (out, domain.nPrimitiveTasks);
+	store (out, domain.nAbstractTasks);
+	store (out, domain.nTotalTasks);
+	store (out, domain.tasks);
+	store (out, domain.decompositionMethods);
+
+	store (out, problem.init);
+	store (out, problem.goal);
+	store (out, problem.init_functions);
+	store (out, problem.initialAbstractTask);
+
+	CacheHeader header;
+	memcpy (header.magic, cacheMagic, sizeof (cacheMagic));
+	header.version = cacheVersion;
+	header.byteOrder = byteOrderMark;
+	header.inputHash = inputHash;
+	header.dataSize = out.data.size ();
+	header.dataHash = hashLiftedInput (out.data);
+
+	std::ofstream file (filename, std::ios::binary);
+	file.write (reinterpret_cast<const char *> (&header), sizeof (header));
+	file.write (out.data.data (), out.data.size ());
+	file.close ();
+	return !file.fail ();
+}
+
+bool readLiftedCache (const std::string & filename, uint64_t inputHash, Domain & domain, Problem & problem, bool quietMode)
+{
+	auto reject = [&] (const std::string & reason) {
+		if (!quietMode)
+			std::cerr << "Not using the lifted cache " << filename << ": " << reason << "." << std::endl;
+		return false;
+	};
+
+	int fd = open (filename.c_str (), O_RDONLY);
+	if (fd < 0)
+		return reject (strerror (errno));
+	struct stat status;
+	if (fstat (fd, &status) != 0 || size_t (status.st_size) < sizeof (CacheHeader))
+	{
+		close (fd);
+		return reject ("it is too short");
+	}
+	size_t size = status.st_size;
+	void * mapping = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (mapping == MAP_FAILED)
+		return reject (strerror (errno));
+	madvise (mapping, size, MADV_SEQUENTIAL);
+
+	const char * bytes = static_cast<const char *> (mapping);
+	CacheHeader header;
+	memcpy (&header, bytes, sizeof (header));
+	std::string_view data (bytes + sizeof (header), size - sizeof (header));
+
+	bool valid = false;
+	if (memcmp (header.magic, cacheMagic, sizeof (cacheMagic)) != 0)
+		reject ("it is not a lifted cache");
+	else if (header.version != cacheVersion || header.byteOrder != byteOrderMark)
+		reject ("it was written by another version or on another machine");
+	else if (header.inputHash != inputHash)
+		reject ("it was written for another input");
+	else if (header.dataSize != data.size () || header.dataHash != hashLiftedInput (data))
+		reject ("it is damaged");
+	else
+		valid = true;
+
+	if (!valid)
+	{
+		munmap (mapping, size);
+		return false;
+	}
+
+	Domain cachedDomain;
+	Problem cachedProblem;
+	CacheReader in {data.data (), data.data () + data.size ()};
+	try
+	{
+		load (in, cachedDomain.constants);
+		load (in, cachedDomain.sorts);
+		load (in, cachedDomain.predicates);
+		load (in, cachedDomain.predicateMutexes);
+		load (in, cachedDomain.functions);
+		load (in, cachedDomain.nPrimitiveTasks);
+		load (in, cachedDomain.nAbstractTasks);
+		load (in, cachedDomain.nTotalTasks);
+		load (in, cachedDomain.tasks);
+		load (in, cachedDomain.decompositionMethods);
+
+		load (in, cachedProblem.init);
+		load (in, cachedProblem.goal);
+		load (in, cachedProblem.init_functions);
+		load (in, cachedProblem.initialAbstractTask);
+	}
+	catch (BadInputException & e)
+	{
+		munmap (mapping, size);
+		return reject (e.message);
+	}
+	munmap (mapping, size);
+
+	cachedDomain.buildSortMemberBits ();
+	cachedDomain.computeStaticPredicates ();
+	domain = std::move (cachedDomain);
+	problem = std::move (cachedProblem);
+	return true;
+}
@@ -0,0 +1,46 @@
+#ifndef LIFTEDCACHE_H_INCLUDED
+#define LIFTEDCACHE_H_INCLUDED
+
+/**
+ * @defgroup liftedcache Lifted Model Cache
+ * @brief A binary snapshot of the parsed Domain and Problem, so that repeated runs on the same input skip the parser.
+ *
+ * @{
+ */
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "model.h"
+
+/**
+ * @brief Returns a 64 bit hash of the given input, which identifies it in a cache file.
+ */
+uint64_t hashLiftedInput (std::string_view input);
+
+/**
+ * @brief Writes the domain and problem as they are after parsing to the given cache file.
+ *
+ * The file starts with a header containing a magic number, the format version, the hash of the input the model was parsed from,
+ * and the size and hash of the remaining data. All numbers are stored in the byte order of the machine writing the file.
+ *
+ * @return Returns false if the file could not be written.
+ */
+bool writeLiftedCache (const std::string & filename, const Domain & domain, const Problem & problem, uint64_t inputHash);
+
+/**
+ * @brief Reads the domain and problem from the given cache file, which is memory-mapped.
+ *
+ * The cache is rejected if it cannot be read, was written by another version of the format or on a machine with another byte order,
+ * is damaged, or was written for an input with another hash. The reason is printed unless quietMode is set.
+ *
+ * @return Returns true if the cache was loaded. Otherwise, domain and problem are unchanged.
+ */
+bool readLiftedCache (const std::string & filename, uint64_t inputHash, Domain & domain, Problem & problem, bool quietMode);
+
+/**
+ * @}
+ */
+
+#endif
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -15,7 +16,11 @@
 #include "hierarchy-typing.h"
 #include "model.h"
 #include "parser.h"
+#include "renumbering.h"
 #include "givenPlan.h"
+#include "liftedcache.h"
+#include "daemon.h"
+#include "plannerformat.h"
 
 
 #include "cmdline.h"
@@ -25,6 +30,20 @@ int main (int argc, char * argv[])
 	gengetopt_args_info args_info;
 	if (cmdline_parser(argc, argv, &args_info) != 0) return 1;
 
+	// in daemon mode, only the child processes serving the requests get past this point, each with the arguments and lifted model of its request
+	Domain domain;
+	Problem problem;
+	bool modelFromDaemon = false;
+	if (args_info.daemon_flag || args_info.daemon_socket_given)
+	{
+		gengetopt_args_info request_args_info;
+		int exitCode;
+		if (!runDaemon (args_info, request_args_info, domain, problem, exitCode))
+			return exitCode;
+		args_info = request_args_info;
+		modelFromDaemon = true;
+	}
+
 	// set debug mode
 	if (args_info.debug_given) setDebugMode(true);
 
@@ -38,6 +57,7 @@ int main (int argc, char * argv[])
 
 	config.quietMode = args_info.quiet_flag;
 	config.printTimings = args_info.print_timings_flag;
+	config.outputBenchmark = args_info.output_benchmark_flag;
 
 	config.computeInvariants = args_info.invariants_flag;
 	config.h2Mutexes = args_info.h2_flag;
@@ -48,12 +68,15 @@ int main (int argc, char * argv[])
 	if (args_info.all_sas_deletes_given) config.sas_mode = SAS_ALL;
 
 	// type of output (default is for planner)
+	if (args_info.binary_planner_given) config.outputBinaryPlanner = true;
 	if (args_info.sasplus_given) config.outputSASPlus = true, config.outputForPlanner = false;
 	if (args_info.hddl_given) config.outputHDDL = true, config.outputForPlanner = false;
 	if (args_info.no_output_given) config.outputForPlanner = false;
 	
 	config.outputSASVariablesOnly = args_info.force_sas_flag;
 	config.compileNegativeSASVariables = args_info.compile_negative_flag;
+	config.coverCopiesWarning = args_info.cover_copies_warning_arg;
+	config.coverCopiesLimit = args_info.cover_copies_limit_arg;
 
 	// transformations
 	config.removeDuplicateActions = args_info.dont_remove_duplicates_flag;
@@ -70,6 +93,30 @@ int main (int argc, char * argv[])
 	config.enableHierarchyTyping = args_info.no_hierarchy_typing_flag;
 	config.futureCachingByPrecondition = args_info.future_caching_by_initially_matched_precondition_flag;
 	config.withStaticPreconditionChecking = args_info.static_precondition_checking_in_hierarchy_typing_flag;	
+	config.threads = args_info.threads_arg;
+	config.flatFactIndex = args_info.flat_fact_index_flag;
+	config.memoryLimit = args_info.memory_limit_arg;
+	config.joinPlanner = args_info.join_planner_flag;
+	if (std::string (args_info.join_engine_arg) == "triejoin") config.joinEngine = JOIN_TRIEJOIN;
+	if (std::string (args_info.join_engine_arg) == "auto") config.joinEngine = JOIN_AUTO;
+	config.semiNaive = args_info.semi_naive_flag;
+	config.staticTables = args_info.static_tables_flag;
+	config.renumberConstants = args_info.renumber_constants_flag;
+	config.decrementalGroundedGpg = args_info.decremental_grounded_gpg_flag;
+	config.parallelHierarchyTyping = args_info.parallel_hierarchy_typing_flag;
+	config.parallelOutput = args_info.parallel_output_flag;
+	config.concurrentPhases = args_info.concurrent_phases_flag;
+	config.mappedInput = args_info.mapped_input_flag;
+
+	if (config.threads < 1){
+		std::cerr << "The number of threads must be at least 1." << std::endl;
+		return 1;
+	}
+
+	if (config.memoryLimit < 0){
+		std::cerr << "The memory limit must not be negative." << std::endl;
+		return 1;
+	}
 
 	config.print_options();	
 
@@ -101,80 +148,153 @@ int main (int argc, char * argv[])
 			outputFilename2 = inputFiles[2];
 	}
 
-	std::istream * inputStream;
-	if (inputFilename == "-")
+	if (args_info.binary_to_text_flag)
+	{
+		BinaryPlannerFile binaryInput;
+		std::string error;
+		if (!binaryInput.open (inputFilename, error))
+		{
+			std::cerr << "Unable to read the binary planner file " << inputFilename << ": " << error << std::endl;
+			return 1;
+		}
+
+		BufferedOutput * textOutput = BufferedOutput::open (outputFilename);
+		if (textOutput == nullptr)
+		{
+			std::cerr << "Unable to open output file " << outputFilename << ": " << strerror (errno) << std::endl;
+			return 1;
+		}
+
+		TextPlannerWriter writer (*textOutput);
+		binaryInput.replay (writer);
+		if (!textOutput->flush ())
+		{
+			std::cerr << "Unable to write output file " << outputFilename << "." << std::endl;
+			return 1;
+		}
+		delete textOutput;
+		if (!config.quietMode)
+			std::cerr << "Converted " << inputFilename << " into the text format." << std::endl;
+		return 0;
+	}
+
+	// a lifted cache is only valid for the input it was written for, which is identified by the hash of the mapped input
+	bool liftedCache = args_info.load_lifted_cache_given || args_info.save_lifted_cache_given;
+	if (liftedCache)
+		config.mappedInput = true;
+
+	// with --mapped-input, the input is opened by an InputTokenizer below
+	std::istream * inputStream = nullptr;
+	if (modelFromDaemon)
+	{
+		if (!config.quietMode)
+			std::cerr << "Using the lifted domain kept by the daemon for " << inputFilename << "." << std::endl;
+	}
+	else if (inputFilename == "-")
 	{
 		if (!config.quietMode)
 			std::cerr << "Reading input from standard input." << std::endl;
 
-		inputStream = &std::cin;
+		if (!config.mappedInput)
+			inputStream = &std::cin;
 	}
 	else
 	{
 		if (!config.quietMode)
 			std::cerr << "Reading input from " << inputFilename << "." << std::endl;
 
-		std::ifstream * fileInput  = new std::ifstream(inputFilename);
-		if (!fileInput->good())
+		if (!config.mappedInput)
+		{
+			std::ifstream * fileInput  = new std::ifstream(inputFilename);
+			if (!fileInput->good())
+			{
+				std::cerr << "Unable to open input file " << inputFilename << ": " << strerror (errno) << std::endl;
+				return 1;
+			}
+
+			inputStream = fileInput;
+		}
+	}
+
+
+	auto parseStart = std::chrono::steady_clock::now ();
+	bool success;
+	if (modelFromDaemon)
+		success = true;
+	else if (!config.mappedInput)
+		success = readInput (*inputStream, domain, problem);
+	else
+	{
+		// the input is unmapped again at the end of this block
+		InputTokenizer mappedInput;
+		if (!mappedInput.open (inputFilename))
 		{
 			std::cerr << "Unable to open input file " << inputFilename << ": " << strerror (errno) << std::endl;
 			return 1;
 		}
 
-		inputStream = fileInput;
+		if (!liftedCache)
+			success = readInput (mappedInput, domain, problem);
+		else
+		{
+			uint64_t inputHash = hashLiftedInput (mappedInput.contents ());
+			bool loaded = args_info.load_lifted_cache_given && readLiftedCache (args_info.load_lifted_cache_arg, inputHash, domain, problem, config.quietMode);
+			if (loaded && !config.quietMode)
+				std::cerr << "Lifted model loaded from " << args_info.load_lifted_cache_arg << "." << std::endl;
+
+			success = loaded || readInput (mappedInput, domain, problem);
+			if (success && !loaded && args_info.save_lifted_cache_given)
+			{
+				if (!writeLiftedCache (args_info.save_lifted_cache_arg, domain, problem, inputHash))
+					std::cerr << "Unable to write the lifted cache " << args_info.save_lifted_cache_arg << ": " << strerror (errno) << std::endl;
+				else if (!config.quietMode)
+					std::cerr << "Lifted model written to " << args_info.save_lifted_cache_arg << "." << std::endl;
+			}
+		}
 	}
+	if (success && !modelFromDaemon && !config.quietMode && config.printTimings)
+		std::cerr << "Reading the input took " << std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - parseStart).count () << " ms" << std::endl;
 
-
-	Domain domain;
-	Problem problem;
-	bool success = readInput (*inputStream, domain, problem);
-
-	std::ostream * outputStream;
+	BufferedOutput * outputStream;
 	if (outputFilename == "-")
 	{
 		if (!config.quietMode)
 			std::cerr << "Writing output to standard output." << std::endl;
-
-		outputStream = &std::cout;
 	}
 	else
 	{
 		if (!config.quietMode)
 			std::cerr << "Writing output to " << outputFilename << "." << std::endl;
+	}
 
-		std::ofstream * fileOutput  = new std::ofstream(outputFilename);
-
-		if (!fileOutput->good ())
-		{
-			std::cerr << "Unable to open output file " << outputFilename << ": " << strerror (errno) << std::endl;
-			return 1;
-		}
-
-		outputStream = fileOutput;
+	outputStream = BufferedOutput::open (outputFilename);
+	if (outputStream == nullptr)
+	{
+		std::cerr << "Unable to open output file " << outputFilename << ": " << strerror (errno) << std::endl;
+		return 1;
 	}
 
-	std::ostream * outputStream2;
+	BufferedOutput * outputStream2;
 	if (outputFilename2 == "-")
 	{
 		if (!config.quietMode)
 			std::cerr << "Writing output to standard output." << std::endl;
-
-		outputStream2 = &std::cout;
 	}
 	else
 	{
 		if (!config.quietMode)
 			std::cerr << "Writing output to " << outputFilename2 << "." << std::endl;
+	}
 
-		std::ofstream * fileOutput  = new std::ofstream(outputFilename2);
-
-		if (!fileOutput->good ())
-		{
-			std::cerr << "Unable to open output file " << outputFilename << ": " << strerror (errno) << std::endl;
-			return 1;
-		}
-
-		outputStream2 = fileOutput;
+	// both outputs on standard output have to share their buffer to keep the order of what is written
+	if (outputFilename2 == "-" && outputFilename == "-")
+		outputStream2 = outputStream;
+	else
+		outputStream2 = BufferedOutput::open (outputFilename2);
+	if (outputStream2 == nullptr)
+	{
+		std::cerr << "Unable to open output file " << outputFilename2 << ": " << strerror (errno) << std::endl;
+		return 1;
 	}
 
 	if (!success)
@@ -185,6 +305,9 @@ int main (int argc, char * argv[])
 	if (!config.quietMode)
 		std::cerr << "Parsing done." << std::endl;
 
+	if (config.renumberConstants)
+		renumberConstants (domain, problem, config);
+
 	if (outputDomain)
 	{
 		printDomainAndProblem (domain, problem);
@@ -213,6 +336,8 @@ int main (int argc, char * argv[])
 	else
 	{
 		run_grounding (domain, problem, *outputStream, *outputStream2, config, given_typing_info);
+		outputStream->flush ();
+		outputStream2->flush ();
 	}
 
 }
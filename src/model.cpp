@@ -17,6 +17,52 @@ const char * BadInputException::what () const throw ()
 	return message.c_str ();
 }
 
+void Sort::buildMemberBits (size_t numberOfConstants)
+{
+	memberBits.assign ((numberOfConstants + 63) / 64, 0);
+	for (int member : members)
+		memberBits[member >> 6] |= uint64_t (1) << (member & 63);
+
+	contiguousMembers = !members.empty () && size_t (*members.rbegin () - *members.begin () + 1) == members.size ();
+	if (contiguousMembers)
+	{
+		firstMember = *members.begin ();
+		lastMember = *members.rbegin ();
+	}
+}
+
+void intersectMemberBits (std::vector<uint64_t> & a, const std::vector<uint64_t> & b)
+{
+	assert (a.size () == b.size ());
+	uint64_t * aWords = a.data ();
+	const uint64_t * bWords = b.data ();
+	for (size_t word = 0; word < a.size (); ++word)
+		aWords[word] &= bWords[word];
+}
+
+void Domain::buildSortMemberBits (void)
+{
+	for (Sort & sort : sorts)
+		sort.buildMemberBits (constants.size ());
+}
+
+void Domain::computeStaticPredicates (void)
+{
+	staticPredicates.assign (predicates.size (), true);
+	for (int taskNo = 0; taskNo < nPrimitiveTasks; ++taskNo)
+	{
+		const Task & task = tasks[taskNo];
+		for (const PredicateWithArguments & effect : task.effectsAdd)
+			staticPredicates[effect.predicateNo] = false;
+		for (const PredicateWithArguments & effect : task.effectsDel)
+			staticPredicates[effect.predicateNo] = false;
+		for (const auto & effect : task.conditionalAdd)
+			staticPredicates[effect.second.predicateNo] = false;
+		for (const auto & effect : task.conditionalDel)
+			staticPredicates[effect.second.predicateNo] = false;
+	}
+}
+
 void Fact::setHeadNo (int headNo)
 {
 	predicateNo = headNo;
@@ -77,7 +123,7 @@ bool Task::doesFactFulfilPrecondition (VariableAssignment * outputVariableAssign
 		// Make sure that the argument to the fact matches the task's variable.
 		// E.g. we could have a fact like "+at truck-0 city-loc-0", but this task could have
 		// "+at ?var1 ?var2" as a precondition, where ?var1 must be a package (and not a truck).
-		if (domain.sorts[argumentSort].members.count (fact.arguments[argIdx]) == 0)
+		if (!domain.sorts[argumentSort].contains (fact.arguments[argIdx]))
 			return false;
 
 		// if the variable has already been assigned, the values must be consistent
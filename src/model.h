@@ -8,6 +8,7 @@
  * @{
  */
 
+#include <cstdint>
 #include <map>
 #include <set>
 #include <string>
@@ -25,8 +26,42 @@ struct Sort
 
 	/// Vector of members of this sort. Every element of this vector is the index of a constant in the Domain.constants vector.
 	std::set<int> members;
+
+	/// The members as a bitset over the constants, one bit per constant. Built by buildMemberBits() once all members are known.
+	std::vector<uint64_t> memberBits;
+
+	/// Whether the members are exactly the constants from the first to the last member. Set by buildMemberBits().
+	bool contiguousMembers = false;
+
+	/// The first and the last member, only valid if contiguousMembers is set.
+	int firstMember = 0;
+	int lastMember = -1;
+
+	/**
+	 * @brief Fills memberBits and the range of members from members. Must be called again whenever members changes.
+	 */
+	void buildMemberBits (size_t numberOfConstants);
+
+	/**
+	 * @brief Returns whether the given constant is a member of this sort. Needs buildMemberBits().
+	 */
+	bool contains (int constant) const
+	{
+		if (contiguousMembers)
+			return constant >= firstMember && constant <= lastMember;
+
+		size_t word = size_t (constant) >> 6;
+		return constant >= 0 && word < memberBits.size () && ((memberBits[word] >> (constant & 63)) & 1);
+	}
 };
 
+/**
+ * @brief Intersects the member bitset a with b in place. Both must be built for the same constants.
+ *
+ * Works on whole words without branches, so the compiler vectorises the loop.
+ */
+void intersectMemberBits (std::vector<uint64_t> & a, const std::vector<uint64_t> & b);
+
 /**
  * @brief A predicate with parameters.
  */
@@ -301,6 +336,19 @@ struct Domain
 
 	/// Decomposition methods
 	std::vector<DecompositionMethod> decompositionMethods;
+
+	/// For every predicate, whether no primitive task adds or deletes it, not even conditionally. Only depends on the tasks, not on the problem.
+	std::vector<bool> staticPredicates;
+
+	/**
+	 * @brief Builds the member bitsets of all sorts, see Sort::buildMemberBits().
+	 */
+	void buildSortMemberBits (void);
+
+	/**
+	 * @brief Determines the static predicates, see Domain#staticPredicates.
+	 */
+	void computeStaticPredicates (void);
 };
 
 struct Problem
@@ -0,0 +1,166 @@
+#ifndef OBJECTPOOL_H_INCLUDED
+#define OBJECTPOOL_H_INCLUDED
+
+/**
+ * @defgroup objectpool Object Pool
+ * @brief Slab allocation of many objects of the same type.
+ *
+ * @{
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Allocates objects of type T in slabs of a fixed number of objects instead of one heap allocation per object.
+ *
+ * Pointers returned by create() stay valid until the pool is destroyed, which destroys all objects that are still in it.
+ * release() frees the heap memory owned by an object right away and reuses its slot for the next create().
+ *
+ * create() and release() may be called concurrently.
+ */
+template <typename T>
+class ObjectPool
+{
+public:
+	explicit ObjectPool (size_t objectsPerSlab = 4096) : objectsPerSlab (objectsPerSlab), usedInLastSlab (objectsPerSlab)
+	{
+		assert (objectsPerSlab > 0);
+	}
+
+	~ObjectPool ()
+	{
+		std::allocator<T> allocator;
+		for (size_t slabIdx = 0; slabIdx < slabs.size (); slabIdx++)
+		{
+			size_t used = (slabIdx + 1 == slabs.size ()) ? usedInLastSlab : objectsPerSlab;
+			std::destroy_n (slabs[slabIdx], used);
+			allocator.deallocate (slabs[slabIdx], objectsPerSlab);
+		}
+	}
+
+	ObjectPool (const ObjectPool &) = delete;
+	ObjectPool & operator= (const ObjectPool &) = delete;
+
+	/**
+	 * @brief Returns a pointer to a default constructed object owned by the pool.
+	 */
+	T * create (void)
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		numberOfObjects++;
+
+		if (!freeObjects.empty ())
+		{
+			T * object = freeObjects.back ();
+			freeObjects.pop_back ();
+			return object;
+		}
+
+		if (usedInLastSlab == objectsPerSlab)
+		{
+			slabs.push_back (std::allocator<T> ().allocate (objectsPerSlab));
+			usedInLastSlab = 0;
+		}
+
+		return std::construct_at (slabs.back () + usedInLastSlab++);
+	}
+
+	/**
+	 * @brief Resets the given object, which must have been created by this pool, and makes its slot available again.
+	 */
+	void release (T * object)
+	{
+		*object = T ();
+
+		std::lock_guard<std::mutex> lock (mutex);
+		assert (numberOfObjects > 0);
+		numberOfObjects--;
+		freeObjects.push_back (object);
+	}
+
+	/**
+	 * @brief Moves the given objects, which must be all objects that have not been released, into a vector in the given order.
+	 *
+	 * Every slab is freed as soon as its last object has been moved out, so that the objects never take their memory twice. The
+	 * pool is empty afterwards. Must not be called concurrently with create() or release().
+	 */
+	std::vector<T> drain (const std::vector<T *> & objects)
+	{
+		assert (objects.size () == numberOfObjects);
+		std::allocator<T> allocator;
+
+		// the slab of an object is the one with the largest address not above the object's
+		std::vector<std::pair<uintptr_t, size_t>> slabsByAddress;
+		for (size_t slabIdx = 0; slabIdx < slabs.size (); slabIdx++)
+			slabsByAddress.emplace_back (reinterpret_cast<uintptr_t> (slabs[slabIdx]), slabIdx);
+		std::sort (slabsByAddress.begin (), slabsByAddress.end ());
+
+		std::vector<size_t> objectsInSlab (slabs.size (), objectsPerSlab);
+		if (!slabs.empty ())
+			objectsInSlab.back () = usedInLastSlab;
+
+		auto remove = [&] (T * object)
+		{
+			std::destroy_at (object);
+			auto slab = std::upper_bound (slabsByAddress.begin (), slabsByAddress.end (), std::make_pair (reinterpret_cast<uintptr_t> (object), SIZE_MAX));
+			size_t slabIdx = std::prev (slab)->second;
+			if (--objectsInSlab[slabIdx] == 0)
+				allocator.deallocate (slabs[slabIdx], objectsPerSlab);
+		};
+
+		for (T * object : freeObjects)
+			remove (object);
+		freeObjects.clear ();
+
+		std::vector<T> result;
+		result.reserve (objects.size ());
+		for (T * object : objects)
+		{
+			result.push_back (std::move (*object));
+			remove (object);
+		}
+
+		slabs.clear ();
+		usedInLastSlab = objectsPerSlab;
+		numberOfObjects = 0;
+		return result;
+	}
+
+	/**
+	 * @brief Returns the number of objects that have been created and not yet released.
+	 */
+	size_t size (void) const
+	{
+		return numberOfObjects;
+	}
+
+	/**
+	 * @brief Returns the number of bytes allocated for the slabs, not counting the heap memory owned by the objects.
+	 */
+	size_t memoryUsage (void) const
+	{
+		return sizeof (ObjectPool) + slabs.size () * objectsPerSlab * sizeof (T) + slabs.capacity () * sizeof (T *) + freeObjects.capacity () * sizeof (T *);
+	}
+
+private:
+	size_t objectsPerSlab;
+	std::vector<T *> slabs;
+	/// Number of constructed objects in the last slab. All objects in the other slabs are constructed.
+	size_t usedInLastSlab;
+	/// Released objects, in their default constructed state
+	std::vector<T *> freeObjects;
+	size_t numberOfObjects = 0;
+	std::mutex mutex;
+};
+
+/**
+ * @}
+ */
+
+#endif
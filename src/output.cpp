@@ -2,40 +2,87 @@
 #include <iostream>
 #include <ostream>
 #include <map>
+#include <memory>
 #include <algorithm>
 #include <unistd.h>
 #include <cassert>
+#include <climits>
+#include <cstdint>
 
 #include "output.h"
+#include "plannerformat.h"
 #include "debug.h"
 #include "util.h"
 
 
-void instantiate_cover_pruned_dfs(std::map<int,int> & cover_pruned_precs, std::map<int,std::vector<int>> & cover_pruned, std::vector<int> & cover_pruned_facts, int curpos, std::vector<int> & current_assignment, std::vector<std::vector<int>> & all_assignments){
-	if (curpos == cover_pruned_facts.size()){
-		all_assignments.push_back(current_assignment);
-		return;
-	}
+/**
+ * @brief The copies of an action with cover-pruned preconditions, each of which is replaced by one of the facts covering it.
+ *
+ * The copies are the Cartesian product of the replacements. They are not stored, but enumerated by a CoverPrunedOdometer.
+ */
+struct CoverPrunedCopies{
+	/// For every cover-pruned precondition, in the order of the fact numbers: its position in an assignment and its replacements
+	std::vector<std::pair<int,const std::vector<int> *>> digits;
 
-	int cur_f = cover_pruned_facts[curpos];
-	for (const int & v : cover_pruned[cur_f]){
-		current_assignment[cover_pruned_precs[cur_f]] = v;
-		instantiate_cover_pruned_dfs(cover_pruned_precs,cover_pruned,cover_pruned_facts,curpos+1, current_assignment, all_assignments);
-	}
-}
+	CoverPrunedCopies() = default;
 
-std::vector<std::vector<int>> instantiate_cover_pruned(std::map<int,int> & cover_pruned_precs, std::map<int,std::vector<int>> & cover_pruned){
-
-	std::vector<int> cover_pruned_facts;
-	for (const auto & entry : cover_pruned_precs) cover_pruned_facts.push_back(entry.first);
+	CoverPrunedCopies(const std::map<int,int> & cover_pruned_precs, const std::map<int,std::vector<int>> & cover_pruned){
+		for (const auto & [fact, position] : cover_pruned_precs)
+			digits.emplace_back(position, &cover_pruned.at(fact));
+	}
 
-	std::vector<int> current_assignment (cover_pruned_facts.size());
-	std::vector<std::vector<int>> all_assignments;
+	/// Returns the number of copies, at most SIZE_MAX
+	size_t size() const {
+		size_t result = 1;
+		for (const auto & [_position, values] : digits){
+			if (values->empty()) return 0;
+			if (result > SIZE_MAX / values->size()) return SIZE_MAX;
+			result *= values->size();
+		}
+		return result;
+	}
 
-	instantiate_cover_pruned_dfs(cover_pruned_precs,cover_pruned,cover_pruned_facts,0,current_assignment, all_assignments);
+	/// Formats a number of copies returned by size(), which only is a lower bound if it is SIZE_MAX
+	static std::string count(size_t copies){
+		return (copies == SIZE_MAX ? "at least " : "") + std::to_string(copies);
+	}
+};
+
+/**
+ * @brief Enumerates the assignments of the copies of an action like an odometer, the replacements of the last cover-pruned precondition
+ * changing fastest. Can be reused for all actions, such that enumerating them does not allocate.
+ */
+struct CoverPrunedOdometer{
+	/// The current assignment, indexed by the positions of the cover-pruned preconditions
+	std::vector<int> assignment;
+	/// The index of the current replacement of every digit
+	std::vector<size_t> counters;
+
+	/// Moves to the first copy. Returns false if there is none.
+	bool start(const CoverPrunedCopies & copies){
+		assignment.resize(copies.digits.size());
+		counters.assign(copies.digits.size(), 0);
+		for (const auto & [position, values] : copies.digits){
+			if (values->empty()) return false;
+			assignment[position] = values->front();
+		}
+		return true;
+	}
 
-	return all_assignments;
-}
+	/// Moves to the next copy. Returns false after the last one.
+	bool next(const CoverPrunedCopies & copies){
+		for (size_t digit = copies.digits.size(); digit-- > 0; ){
+			const auto & [position, values] = copies.digits[digit];
+			if (++counters[digit] < values->size()){
+				assignment[position] = (*values)[counters[digit]];
+				return true;
+			}
+			counters[digit] = 0;
+			assignment[position] = values->front();
+		}
+		return false;
+	}
+};
 
 
 void write_task_name(std::ostream & pout, const Domain & domain, GroundedTask & task){
@@ -50,20 +97,20 @@ void write_task_name(std::ostream & pout, const Domain & domain, GroundedTask &
 
 
 
-void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Problem & problem,
+void write_grounded_HTN(BufferedOutput & pout, const Domain & domain, const Problem & problem,
 		std::vector<Fact> & reachableFacts,
 		std::vector<GroundedTask> & reachableTasks,
 		std::vector<GroundedMethod> & reachableMethods,
 		std::vector<bool> & prunedTasks,
 		std::vector<bool> & prunedFacts,
 		std::vector<bool> & prunedMethods,
-		std::unordered_set<int> initFacts,
-		std::unordered_set<int> initFactsPruned,
-		std::unordered_set<Fact> reachableFactsSet,
-		std::vector<std::unordered_set<int>> sas_groups,
-		std::vector<std::unordered_set<int>> further_strict_mutex_groups,
-		std::vector<std::unordered_set<int>> further_mutex_groups,
-		std::vector<std::unordered_set<int>> invariants,
+		const std::unordered_set<int> & initFacts,
+		const std::unordered_set<int> & initFactsPruned,
+		const std::unordered_set<Fact> & reachableFactsSet,
+		const std::vector<std::unordered_set<int>> & sas_groups,
+		const std::vector<std::unordered_set<int>> & further_strict_mutex_groups,
+		const std::vector<std::unordered_set<int>> & further_mutex_groups,
+		const std::vector<std::unordered_set<int>> & invariants,
 		std::vector<bool> & sas_variables_needing_none_of_them,
 		grounding_configuration & config
 		){
@@ -254,33 +301,43 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 
 
 
-	pout << ";; #state features" << std::endl;
-	pout << fn << std::endl;
-	for (int factID : orderedFacts){
+	std::unique_ptr<PlannerWriter> writer;
+	if (config.outputBinaryPlanner)
+		writer = std::make_unique<BinaryPlannerWriter> (pout);
+	else
+		writer = std::make_unique<TextPlannerWriter> (pout);
+
+	// the names and the entries of the large sections are formatted in parallel, once all output numbers are known
+	std::unique_ptr<ThreadPool> pool;
+	if (config.parallelOutput && config.threads > 1)
+		pool = std::make_unique<ThreadPool> (config.threads);
+	OutputBenchmark benchmark (pout, config.outputBenchmark);
+
+	benchmark.begin("state features");
+	writer->stateFeatures(fn);
+	writeParallel(*writer, pool.get(), orderedFacts.size(), [&](PlannerWriter & part, size_t i){
+		int factID = orderedFacts[i];
 		// artificial member for SAS groups
 		if (factID < 0){
-			pout << "none-of-them" << std::endl;
-			continue;
+			part.stateFeature("none-of-them");
+			return;
 		}
 		// real fact
-		Fact & fact = reachableFacts[factID];
-		if (prunedFacts[fact.groundedNo]) continue;
-		if (domain.predicates[fact.predicateNo].guard_for_conditional_effect) continue;
+		const Fact & fact = reachableFacts[factID];
+		if (prunedFacts[fact.groundedNo]) return;
+		if (domain.predicates[fact.predicateNo].guard_for_conditional_effect) return;
 
 		DEBUG(std::cout << fact.outputNo << " ");
 
-		pout << domain.predicates[fact.predicateNo].name << "[";
-		for (unsigned int i = 0; i < fact.arguments.size(); i++){
-			if (i) pout << ",";
-			pout << domain.constants[fact.arguments[i]];
-		}
-		pout << "]" << std::endl;
-	}
-	pout << std::endl;
+		thread_local std::string name;
+		NameTable::buildFact(name, domain, fact);
+		part.stateFeature(name);
+	});
+	benchmark.end();
 
 
-	pout << ";; Mutex Groups" << std::endl;
-	pout << number_of_sas_groups << std::endl;
+	benchmark.begin("mutex groups");
+	writer->mutexGroups(number_of_sas_groups);
 	
 	int current_fact_position = 0;
 	int variable_number = 0;
@@ -293,38 +350,32 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 		else
 			none_of_them_per_sas_group[sas_g] = -1;
 
-		pout << current_fact_position << " ";
-		pout << current_fact_position + group_size - 1;
-	   	pout << " var" << std::to_string(++variable_number) << std::endl;
+		writer->mutexGroup(current_fact_position, current_fact_position + group_size - 1, "var" + std::to_string(++variable_number));
 		current_fact_position += group_size;
 	}
 	
 	
 	// these are the facts, that do not belong to a SAS+ group, we have to output them on their own.
-	for (int factID : orderedFacts){
-		if (factID < 0) continue;
-		Fact & fact = reachableFacts[factID];
-		if (prunedFacts[fact.groundedNo]) continue;
-		if (domain.predicates[fact.predicateNo].guard_for_conditional_effect) continue;
+	writeParallel(*writer, pool.get(), orderedFacts.size(), [&](PlannerWriter & part, size_t i){
+		int factID = orderedFacts[i];
+		if (factID < 0) return;
+		const Fact & fact = reachableFacts[factID];
+		if (prunedFacts[fact.groundedNo]) return;
+		if (domain.predicates[fact.predicateNo].guard_for_conditional_effect) return;
 		// is part of mutex group? or pruned? Then it will still have -1
-		if (fact.outputNo < current_fact_position) continue;
+		if (fact.outputNo < current_fact_position) return;
 		
-		pout << fact.outputNo << " ";
-		pout << fact.outputNo << " ";
-		pout << domain.predicates[fact.predicateNo].name << "[";
-		for (unsigned int i = 0; i < fact.arguments.size(); i++){
-			if (i) pout << ",";
-			pout << domain.constants[fact.arguments[i]];
-		}
-		pout << "]" << std::endl;
-	}
-	pout << std::endl;
+		thread_local std::string name;
+		NameTable::buildFact(name, domain, fact);
+		part.mutexGroup(fact.outputNo, fact.outputNo, name);
+	});
+	benchmark.end();
 
 	// further known mutex groups
 	std::vector<std::unordered_set<int>> out_strict_mutexes;
 	std::vector<std::unordered_set<int>> out_non_strict_mutexes;
 	for (int mutexType = 0; mutexType < 2; mutexType++){
-		std::vector<std::unordered_set<int>> & mutex_groups = (mutexType == 0) ? further_strict_mutex_groups : further_mutex_groups;
+		const std::vector<std::unordered_set<int>> & mutex_groups = (mutexType == 0) ? further_strict_mutex_groups : further_mutex_groups;
 		std::vector<std::unordered_set<int>> & out_mutexes = (mutexType == 0) ? out_strict_mutexes : out_non_strict_mutexes;
 		for (const auto & mgroup : mutex_groups){
 			std::unordered_set<int> mutex;
@@ -370,28 +421,20 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 	}
 	
 	
+	benchmark.begin("further mutexes");
 	for (int mutexType = 0; mutexType < 2; mutexType++){
-		if (mutexType == 0)
-			pout << ";; further strict Mutex Groups" << std::endl;
-		else
-			pout << ";; further non strict Mutex Groups" << std::endl;
-		
 		std::vector<std::unordered_set<int>> & out_mutexes = (mutexType == 0) ? out_strict_mutexes : out_non_strict_mutexes;
 
-		pout << out_mutexes.size() << std::endl;
+		writer->furtherMutexes(mutexType == 0, out_mutexes.size());
 		for (const auto & mutex : out_mutexes){
-			for (const int & elem : mutex){
-				assert(elem >= 0);
-				pout << elem << " ";
-			}
-			pout << -1 << std::endl;
+			for (const int & elem : mutex) assert(elem >= 0);
+			writer->furtherMutex(std::vector<int>(mutex.begin(), mutex.end()));
 		}
-		pout << std::endl;
 	}
+	benchmark.end();
 
 
 	// further known mutex groups
-	pout << ";; known invariants" << std::endl;
 
 	std::vector<std::unordered_set<int>> out_invariants;
 	for (const auto & inv : invariants){
@@ -464,13 +507,11 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 	}
 
 
-	pout << out_invariants.size() << std::endl;
-	for (const auto & inv : out_invariants){
-		for (const int & elem : inv)
-			pout << elem << " ";
-		pout << -1 << std::endl;
-	}
-	pout << std::endl;
+	benchmark.begin("invariants");
+	writer->invariants(out_invariants.size());
+	for (const auto & inv : out_invariants)
+		writer->invariant(std::vector<int>(inv.begin(), inv.end()));
+	benchmark.end();
 
 
 	////// OUTPUT OF ACTIONS
@@ -505,14 +546,21 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 	std::vector<std::tuple<int,int,std::vector<int>,
 						   std::vector<std::pair<std::vector<int>,int>>,
 						   std::vector<std::pair<std::vector<int>,int>>,
-						   std::vector<std::vector<int>>
+						   CoverPrunedCopies
 							   >> output_actions;
-	int number_of_actions_in_output = 0;
+	// reserved at once, the pages of the unused rest are never touched
+	output_actions.reserve(reachableTasks.size());
+	// counted exactly, as cover pruning can multiply the actions beyond what the output can number
+	size_t number_of_actions_in_output = 0;
 	for (GroundedTask & task : reachableTasks){
 		if (domain.tasks[task.taskNo].isCompiledConditionalEffect) continue;
 		if (task.taskNo >= domain.nPrimitiveTasks || prunedTasks[task.groundedNo]) continue;
 		
-		DEBUG( std::cout << "Processing task " << domain.tasks[task.taskNo].name << " for output" << std::endl);
+		DEBUG( std::cout << "Processing task " << domain.tasks[task.taskNo].name << " for output" << std::endl;
+			// output raw for debugging
+			for (int p : task.groundedPreconditions) std::cout << p << " "; std::cout << std::endl;
+			for (int p : task.groundedAddEffects) std::cout << p << " "; std::cout << std::endl;
+			for (int p : task.groundedDelEffects) std::cout << p << " "; std::cout << std::endl);
 		
 		int costs = domain.tasks[task.taskNo].computeGroundCost(task,init_functions_map);
 		
@@ -652,17 +700,43 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 		}
 
 		
-		std::vector<std::vector<int>> instances = instantiate_cover_pruned(cover_pruned_precs, cover_pruned);
+		CoverPrunedCopies instances (cover_pruned_precs, cover_pruned);
+		size_t number_of_copies = instances.size();
+		if (config.coverCopiesWarning > 0 && number_of_copies > size_t(config.coverCopiesWarning) && !config.quietMode){
+			std::cerr << "Warning: cover pruning writes the action ";
+			write_task_name(std::cerr, domain, task);
+			std::cerr << " " << CoverPrunedCopies::count(number_of_copies) << " times, once for every combination of the facts replacing its " << instances.digits.size() << " cover-pruned preconditions." << std::endl;
+		}
+		if (config.coverCopiesLimit > 0 && number_of_copies > size_t(config.coverCopiesLimit)){
+			std::cerr << "Cover pruning would write the action ";
+			write_task_name(std::cerr, domain, task);
+			std::cerr << " " << CoverPrunedCopies::count(number_of_copies) << " times, more than the limit of " << config.coverCopiesLimit << " copies given by --cover-copies-limit." << std::endl;
+			exit(1);
+		}
 
-		number_of_actions_in_output += instances.size();
-		output_actions.push_back(std::make_tuple(task.groundedNo,costs,prec_out,add_out,del_out,instances));
+		number_of_actions_in_output = number_of_copies > SIZE_MAX - number_of_actions_in_output ? SIZE_MAX : number_of_actions_in_output + number_of_copies;
+		output_actions.push_back(std::make_tuple(task.groundedNo,costs,std::move(prec_out),std::move(add_out),std::move(del_out),std::move(instances)));
+
+		// only the name of the task is output from now on, so release its preconditions and effects right away instead of
+		// holding every action twice until the end
+		std::vector<int>().swap(task.groundedPreconditions);
+		std::vector<int>().swap(task.groundedAddEffects);
+		std::vector<int>().swap(task.groundedDelEffects);
+		std::vector<int>().swap(task.noneOfThoseEffect);
 	}
 	
 
 	// actual output of actions
 
-	pout << ";; Actions" << std::endl;
-	pout << number_of_actions_in_output + (contains_empty_method ? 1 : 0) << std::endl; 
+	// actions and tasks are numbered by ints in the output, which must not silently wrap around. Besides the copies of the actions, there
+	// are at most one abstract task for every grounded task, one for every action with several copies, and the no-op.
+	if (number_of_actions_in_output > size_t(INT_MAX) || 2 * reachableTasks.size() + 1 > size_t(INT_MAX) - number_of_actions_in_output){
+		std::cerr << "Cover pruning expands the actions to " << CoverPrunedCopies::count(number_of_actions_in_output) << " copies, too many to be numbered in the output. Use --cover-copies-warning to find the actions causing this." << std::endl;
+		exit(1);
+	}
+
+	benchmark.begin("actions");
+	writer->actions(number_of_actions_in_output + (contains_empty_method ? 1 : 0));
 	int ac = 0;
 	int number_of_additional_abstracts = 0;
 	int number_of_output_primitives = 0;
@@ -670,43 +744,43 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 
 	// if necessary, we add a no-op, s.t. methods are non-empty. This task will always have cost 0
 	if (contains_empty_method){
-		pout << 0 << std::endl;
-		pout << -1 << std::endl;
-		pout << -1 << std::endl;
-		pout << -1 << std::endl;
+		writer->action(0, {}, {}, {});
 
 		ac++;
 		number_of_output_artificial_primitives++;
 	}
 
+	// first number all actions, then write them
 	for (const auto & [tID, costs, prec_out, add_out, del_out, instances] : output_actions){
 		DEBUG(std::cout << "Task " << tID << " gets outputID " << ac << std::endl);
 		
 		GroundedTask & task = reachableTasks[tID];
-		if (instances.size() == 1)
+		size_t number_of_copies = instances.size();
+		if (number_of_copies == 1)
 			task.outputNo = ac;
 		else {
 			number_of_additional_abstracts++;
 			task.outputNo = -2; // marker for additionally needed task
 		}
 
-		for (const std::vector<int> & cover_assignment : instances){
-			///////////////////////////// ACTUAL OUTPUT
+		for (size_t copy = 0; copy < number_of_copies; copy++){
 			task.outputNosForCover.push_back(ac++);
 			if (domain.tasks[task.taskNo].name[0] == '_')
 				number_of_output_artificial_primitives++;
 			else
 				number_of_output_primitives++;
 			
-			DEBUG(write_task_name(std::cout,domain,task); std::cout << std::endl;
-			// output raw for debugging
-			for (int p : task.groundedPreconditions) std::cout << p << " "; std::cout << std::endl;
-			for (int p : task.groundedAddEffects) std::cout << p << " "; std::cout << std::endl;
-			for (int p : task.groundedDelEffects) std::cout << p << " "; std::cout << std::endl);
+			DEBUG(write_task_name(std::cout,domain,task); std::cout << std::endl);
+		}
+	}
 
+	writeParallel(*writer, pool.get(), output_actions.size(), [&](PlannerWriter & part, size_t i){
+		const auto & [tID, costs, prec_out, add_out, del_out, instances] = output_actions[i];
 
+		thread_local CoverPrunedOdometer odometer;
+		for (bool more = odometer.start(instances); more; more = odometer.next(instances)){
+			const std::vector<int> & cover_assignment = odometer.assignment;
 			// ACTUAL
-			pout << costs << std::endl;
 			// preconditions
 			std::unordered_set<int> p_out;
 			for (const int & prec : prec_out)
@@ -720,9 +794,7 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 						p_out.insert(none_of_them_per_sas_group[-alternate-1]);
 				}
 
-			for (const int & x : p_out)
-				pout << x << " ";
-			pout << -1 << std::endl;
+			std::vector<int> preconditions (p_out.begin(), p_out.end());
 
 
 			std::unordered_set<std::pair<std::unordered_set<int>,int>> a_out;
@@ -744,13 +816,12 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 			}
 
 			// output add effects
+			std::vector<int> addEffects;
 			for (const auto & add : a_out){
-				pout << add.first.size() << " ";
-				for (const int & p : add.first) 
-					pout << p << " ";
-				pout << add.second << "  ";
+				addEffects.push_back(add.first.size());
+				addEffects.insert(addEffects.end(), add.first.begin(), add.first.end());
+				addEffects.push_back(add.second);
 			}
-			pout << -1 << std::endl;
 
 			// output del effects
 			std::unordered_set<std::pair<std::unordered_set<int>,int>> d_out;
@@ -770,17 +841,20 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 				d_out.insert(op);
 			}
 
+			std::vector<int> deleteEffects;
 			for (const auto & del : d_out){
-				pout << del.first.size() << " " ;
-				for (const int & p : del.first)
-					pout << p << " ";
-				pout << del.second << "  ";
+				deleteEffects.push_back(del.first.size());
+				deleteEffects.insert(deleteEffects.end(), del.first.begin(), del.first.end());
+				deleteEffects.push_back(del.second);
 			}
-			pout << -1 << std::endl;
+
+			part.action(costs, preconditions, addEffects, deleteEffects);
 		}
-	}
+	});
+	benchmark.end();
 
-	pout << std::endl << ";; initial state" << std::endl;
+	benchmark.begin("initial state and goal");
+	std::vector<int> initialState;
 	for (size_t sas_g = 0; sas_g < sas_groups.size(); sas_g++){
 		if (pruned_sas_groups.count(sas_g)) continue; // has been cover pruned
 		
@@ -789,12 +863,12 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 			assert(!prunedFacts[f]);
 			assert(!cover_pruned.count(f));
 			assert(reachableFacts[f].outputNo >= 0);
-			pout << reachableFacts[f].outputNo << " ";
+			initialState.push_back(reachableFacts[f].outputNo);
 			didOutput = true;
 		}
 		if (!didOutput){
 			assert(none_of_them_per_sas_group[sas_g] != -1);
-			pout << none_of_them_per_sas_group[sas_g] << " ";
+			initialState.push_back(none_of_them_per_sas_group[sas_g]);
 		}
 	}
 	
@@ -805,16 +879,19 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 		
 		int outputNo = reachableFacts[fID].outputNo;
 		if (outputNo < number_of_sas_covered_facts) continue; // is a sas+ fact
-		pout << outputNo << " ";
+		initialState.push_back(outputNo);
 	}
-	pout << -1 << std::endl;
+	writer->initialState(initialState);
 	
-	pout << std::endl << ";; goal" << std::endl;
+	std::vector<int> goal;
 	for (const Fact & f : problem.goal){
 		auto it = reachableFactsSet.find(f);
 		if (it == reachableFactsSet.end()){
 			// TODO detect this earlier and do something intelligent
 			std::cerr << "Goal is unreachable [never reachable] ... " << std::endl;
+			// the binary writer keeps everything in memory until it is finished, then writes the sections so far like the text writer
+			writer->finish();
+			pout.flush();
 			_exit(0);
 		}
 		if (prunedFacts[it->groundedNo]){
@@ -830,13 +907,16 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 				}
 				std::cout << "]" << std::endl;
 
+				writer->finish();
+				pout.flush();
 				_exit(0);
 			}
 			continue;
 		}
-		pout << reachableFacts[it->groundedNo].outputNo << " ";
+		goal.push_back(reachableFacts[it->groundedNo].outputNo);
 	}
-	pout << -1 << std::endl;
+	writer->goal(goal);
+	benchmark.end();
 
 	int abstractTasks = 0;
 	for (GroundedTask & task : reachableTasks){
@@ -845,24 +925,26 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 		abstractTasks++;
 	}
 	
-	pout << std::endl << ";; tasks (primitive and abstract)" << std::endl;
-	pout << number_of_actions_in_output + abstractTasks + number_of_additional_abstracts + (contains_empty_method ? 1 : 0) << std::endl;
+	benchmark.begin("tasks");
+	writer->tasks(number_of_actions_in_output + abstractTasks + number_of_additional_abstracts + (contains_empty_method ? 1 : 0));
 	
 	// if necessary additional noop
 	if (contains_empty_method){
-		pout << 0 << " __noop" << std::endl;
+		writer->task(false, "", "__noop");
 	}
 	
 	// output names of primitives
-	for (const auto & [tID, _1, _2, _3, _4, instances] : output_actions){
-		GroundedTask & task = reachableTasks[tID];
-
-		for (const std::vector<int> & _cover_assignment : instances){
-			pout << 0 << " ";
-			write_task_name(pout,domain,task);
-			pout << std::endl;
+	writeParallel(*writer, pool.get(), output_actions.size(), [&](PlannerWriter & part, size_t i){
+		const auto & [tID, _1, _2, _3, _4, instances] = output_actions[i];
+		size_t number_of_copies = instances.size();
+		if (number_of_copies == 0) return;
+
+		thread_local std::string name;
+		NameTable::buildTask(name, domain, reachableTasks[tID]);
+		for (size_t copy = 0; copy < number_of_copies; copy++){
+			part.task(false, "", name);
 		}
-	}
+	});
 
 
 	int initialAbstract = -1;
@@ -871,38 +953,40 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 		if (task.taskNo < domain.nPrimitiveTasks) continue;
 		task.outputNo = ac++;
 		if (task.taskNo == problem.initialAbstractTask) initialAbstract = task.outputNo; 
-
-		pout << 1 << " ";
-		write_task_name(pout,domain,task);
-		pout << std::endl;
 	}
+	writeParallel(*writer, pool.get(), reachableTasks.size(), [&](PlannerWriter & part, size_t i){
+		const GroundedTask & task = reachableTasks[i];
+		if (prunedTasks[task.groundedNo]) return;
+		if (task.taskNo < domain.nPrimitiveTasks) return;
+
+		thread_local std::string name;
+		NameTable::buildTask(name, domain, task);
+		part.task(true, "", name);
+	});
 	int number_of_output_abstracts = ac - number_of_output_primitives - number_of_output_artificial_primitives;
 
 	
 	// artificial tasks
+	NameTable taskNames (domain, reachableTasks.size());
 	int number_of_additional_methods = 0;
 	for (GroundedTask & task : reachableTasks) if (task.outputNo == -2){
-		pout << 1 << " __sas";
+		writer->task(true, "__sas", taskNames.task(task));
 		task.outputNo = -(ac++) - 2;
-		write_task_name(pout,domain,task);
-		pout << std::endl;
 		number_of_additional_methods += task.outputNosForCover.size();
 	}
 
-	pout << std::endl << ";; initial abstract task" << std::endl;
-	pout << initialAbstract << std::endl;
+	writer->initialAbstractTask(initialAbstract);
+	benchmark.end();
 
 	int number_of_actual_methods = 0;
 	for (bool b : prunedMethods) if (!b) number_of_actual_methods++;
 	
-	pout << std::endl << ";; methods" << std::endl;
-	pout << number_of_actual_methods + number_of_additional_methods << std::endl;
-	int number_of_output_methods = 0;
-	for (auto & method : reachableMethods){
-		if (prunedMethods[method.groundedNo]) continue;
-		number_of_output_methods++;
-		// output their name
-		pout << domain.decompositionMethods[method.methodNo].name << std::endl;
+	benchmark.begin("methods");
+	writer->methods(number_of_actual_methods + number_of_additional_methods);
+	int number_of_output_methods = number_of_actual_methods;
+	writeParallel(*writer, pool.get(), reachableMethods.size(), [&](PlannerWriter & part, size_t i){
+		const GroundedMethod & method = reachableMethods[i];
+		if (prunedMethods[method.groundedNo]) return;
 		/* method names may not contained variables for verification
 		 * TODO maybe add a FLAG here (for debugging the planner)
 		<< "[";
@@ -915,10 +999,10 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 		// the abstract task
 		int atOutputNo = reachableTasks[method.groundedAddEffects[0]].outputNo;
 		assert(atOutputNo >= 0);
-		pout << atOutputNo << std::endl;
 
 		
 		std::map<int,int> subTaskIndexToOutputIndex;
+		std::vector<int> subtasks;
 		// output subtasks in their topological ordering
 		for (size_t outputIndex = 0; outputIndex < method.preconditionOrdering.size(); outputIndex++){
 			int subtaskIndex = method.preconditionOrdering[outputIndex];
@@ -932,14 +1016,12 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 			int outNo = reachableTasks[groundedSubtask].outputNo;
 			if (outNo < 0) outNo = -outNo - 2; // marker task, and keeps -1 invariant ...
 
-			pout << outNo << " ";
+			subtasks.push_back(outNo);
 			assert(outNo >= 0);
 		}
 		// no empty methods if desired. If this method would be empty, add a no-op.
 		if (contains_empty_method && method.preconditionOrdering.size() == 0)
-			pout << "0 ";
-
-		pout << "-1" << std::endl;
+			subtasks.push_back(0);
 
 		auto orderings = domain.decompositionMethods[method.methodNo].orderingConstraints;
 		std::sort(orderings.begin(), orderings.end());
@@ -947,24 +1029,25 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 		orderings.erase(last, orderings.end());
 
 
-		for (auto & order : orderings)
-			pout << subTaskIndexToOutputIndex[order.first] << " " << subTaskIndexToOutputIndex[order.second] << " ";
-		pout << "-1" << std::endl;
-	}
+		std::vector<int> outputOrderings;
+		for (auto & order : orderings){
+			outputOrderings.push_back(subTaskIndexToOutputIndex[order.first]);
+			outputOrderings.push_back(subTaskIndexToOutputIndex[order.second]);
+		}
+
+		// output their name
+		part.method("", domain.decompositionMethods[method.methodNo].name, atOutputNo, subtasks, outputOrderings);
+	});
 
 	for (GroundedTask & task : reachableTasks) if (task.outputNo <= -2){
 		int at = -task.outputNo -2;
 	
 		for (const int & prim : task.outputNosForCover){
 			number_of_output_methods++;
-			pout << "sas_method_";
-			write_task_name(pout,domain,task);
-			pout << std::endl;
-			pout << at << std::endl;
-			pout << prim << " " << -1 << std::endl;
-			pout << -1 << std::endl;
+			writer->method("sas_method_", taskNames.task(task), at, {prim}, {});
 		}
 	}
+	benchmark.end();
 	
 	if (!config.quietMode) std::cout << "Final Statistics: F " << fn << " S " << sas_groups.size() << 
 		" SC " << number_of_sas_covered_facts << 
@@ -972,9 +1055,16 @@ void write_grounded_HTN(std::ostream & pout, const Domain & domain, const Proble
 		" P " << number_of_output_primitives << " S " << number_of_output_artificial_primitives <<
 		" A " << number_of_output_abstracts << " M " << number_of_output_methods << std::endl;
 
+	print_memory_usage("output", config);
+
 	// exiting this way is faster as data structures will not be cleared ... who needs this anyway
 	if (!config.quietMode) std::cerr << "Exiting." << std::endl;
 	// exiting this way is faster ...
+	benchmark.begin("finish");
+	writer->finish();
+	pout.flush();
+	benchmark.end();
+	benchmark.print(std::cerr);
 	_exit (0);
 }
 
@@ -1002,7 +1092,7 @@ std::string toHDDLName(std::string name){
 }
 
 
-void write_grounded_HTN_to_HDDL(std::ostream & dout, std::ostream & pout, const Domain & domain, const Problem & problem,
+void write_grounded_HTN_to_HDDL(BufferedOutput & dout, BufferedOutput & pout, const Domain & domain, const Problem & problem,
 		std::vector<Fact> & reachableFacts,
 		std::vector<GroundedTask> & reachableTasks,
 		std::vector<GroundedMethod> & reachableMethods,
@@ -1317,6 +1407,8 @@ void write_grounded_HTN_to_HDDL(std::ostream & dout, std::ostream & pout, const
 		if (it == reachableFactsSet.end()){
 			// TODO detect this earlier and do something intelligent
 			std::cerr << "Goal is unreachable [never reachable] ... " << std::endl;
+			dout.flush();
+			pout.flush();
 			_exit(0);
 		}
 		if (prunedFacts[it->groundedNo]){
@@ -1332,6 +1424,8 @@ void write_grounded_HTN_to_HDDL(std::ostream & dout, std::ostream & pout, const
 				}
 				std::cout << "]" << std::endl;
 
+				dout.flush();
+				pout.flush();
 				_exit(0);
 			}
 			continue;
@@ -8,15 +8,16 @@
 #include "debug.h"
 #include "model.h"
 #include "parser.h"
+#include "tokenizer.h"
 
-template <typename T>
-using ReadFunction = void (const Domain & state, std::istream & input, T & output);
+template <typename Input, typename T>
+using ReadFunction = void (const Domain & state, Input & input, T & output);
 
 /**
  * @brief Read count elements from input into outputVector using readFunc.
  */
-template <typename T>
-void readN (const Domain & state, std::istream & input, std::vector<T> & outputVector, ReadFunction<T> & readFunc, size_t count)
+template <typename Input, typename T>
+void readN (const Domain & state, Input & input, std::vector<T> & outputVector, ReadFunction<Input, T> & readFunc, size_t count)
 {
 	outputVector.resize (count);
 	for (size_t i = 0; i < count; ++i)
@@ -26,8 +27,8 @@ void readN (const Domain & state, std::istream & input, std::vector<T> & outputV
 /**
  * @brief Read the number of elements, then read the elements from input into outputVector using readFunc.
  */
-template <typename T>
-void readMultiple (const Domain & state, std::istream & input, std::vector<T> & outputVector, ReadFunction<T> & readFunc)
+template <typename Input, typename T>
+void readMultiple (const Domain & state, Input & input, std::vector<T> & outputVector, ReadFunction<Input, T> & readFunc)
 {
 	size_t count;
 	input >> count;
@@ -37,8 +38,8 @@ void readMultiple (const Domain & state, std::istream & input, std::vector<T> &
 /**
  * @brief Read a primitive value from input into output.
  */
-template <typename T>
-void readPrimitive (const Domain & state, std::istream & input, T & output)
+template <typename Input, typename T>
+void readPrimitive (const Domain & state, Input & input, T & output)
 {
 	input >> output;
 }
@@ -49,7 +50,8 @@ void failIfNotSatisfied (bool condition, std::string message)
 		throw BadInputException (message);
 }
 
-void readSort (const Domain & state, std::istream & input, Sort & outputSort)
+template <typename Input>
+void readSort (const Domain & state, Input & input, Sort & outputSort)
 {
 	input >> outputSort.name;
 
@@ -63,19 +65,22 @@ void readSort (const Domain & state, std::istream & input, Sort & outputSort)
 	}
 }
 
-void readPredicate (const Domain & state, std::istream & input, Predicate & outputPredicate)
+template <typename Input>
+void readPredicate (const Domain & state, Input & input, Predicate & outputPredicate)
 {
 	input >> outputPredicate.name;
 	outputPredicate.guard_for_conditional_effect = false;
 	readMultiple (state, input, outputPredicate.argumentSorts, readPrimitive);
 }
 
-void readPredicateMutex (const Domain & state, std::istream & input, std::pair<int,int> & mutex)
+template <typename Input>
+void readPredicateMutex (const Domain & state, Input & input, std::pair<int,int> & mutex)
 {
 	input >> mutex.first >> mutex.second;
 }
 
-void readPredicateWithArguments (const Domain & state, std::istream & input, PredicateWithArguments & outputPredicate)
+template <typename Input>
+void readPredicateWithArguments (const Domain & state, Input & input, PredicateWithArguments & outputPredicate)
 {
 	input >> outputPredicate.predicateNo;
 
@@ -83,7 +88,8 @@ void readPredicateWithArguments (const Domain & state, std::istream & input, Pre
 	readN (state, input, outputPredicate.arguments, readPrimitive, nArguments);
 }
 
-void readConditionalEffect (const Domain & state, std::istream & input, std::pair<std::vector<PredicateWithArguments>, PredicateWithArguments> & outputPredicate){
+template <typename Input>
+void readConditionalEffect (const Domain & state, Input & input, std::pair<std::vector<PredicateWithArguments>, PredicateWithArguments> & outputPredicate){
 
 	// read conditions
 	readMultiple(state,input,outputPredicate.first,readPredicateWithArguments);
@@ -92,7 +98,8 @@ void readConditionalEffect (const Domain & state, std::istream & input, std::pai
 	readPredicateWithArguments(state,input,outputPredicate.second);
 }
 
-void readCostStatement (const Domain & state, std::istream & input, std::variant<PredicateWithArguments,int> & outputCosts)
+template <typename Input>
+void readCostStatement (const Domain & state, Input & input, std::variant<PredicateWithArguments,int> & outputCosts)
 {
 	std::string cost_type;
 	input >> cost_type;
@@ -112,7 +119,8 @@ void readCostStatement (const Domain & state, std::istream & input, std::variant
 	}
 }
 
-void readFact (const Domain & state, std::istream & input, Fact & fact)
+template <typename Input>
+void readFact (const Domain & state, Input & input, Fact & fact)
 {
 	input >> fact.predicateNo;
 
@@ -121,7 +129,8 @@ void readFact (const Domain & state, std::istream & input, Fact & fact)
 }
 
 
-void readFunctionFact (const Domain & state, std::istream & input, std::pair<Fact,int> & ffact)
+template <typename Input>
+void readFunctionFact (const Domain & state, Input & input, std::pair<Fact,int> & ffact)
 {
 	input >> ffact.first.predicateNo;
 
@@ -130,7 +139,8 @@ void readFunctionFact (const Domain & state, std::istream & input, std::pair<Fac
 	input >> ffact.second;
 }
 
-void readTaskWithArguments (const Domain & state, std::istream & input, TaskWithArguments & outputTaskWithArguments)
+template <typename Input>
+void readTaskWithArguments (const Domain & state, Input & input, TaskWithArguments & outputTaskWithArguments)
 {
 	input >> outputTaskWithArguments.taskNo;
 
@@ -138,7 +148,8 @@ void readTaskWithArguments (const Domain & state, std::istream & input, TaskWith
 	readN (state, input, outputTaskWithArguments.arguments, readPrimitive, nArguments);
 }
 
-void readVariableConstraint (const Domain & state, std::istream & input, VariableConstraint & outputConstraint)
+template <typename Input>
+void readVariableConstraint (const Domain & state, Input & input, VariableConstraint & outputConstraint)
 {
 	std::string constraintType;
 	input >> constraintType;
@@ -153,7 +164,8 @@ void readVariableConstraint (const Domain & state, std::istream & input, Variabl
 	input >> outputConstraint.var1 >> outputConstraint.var2;
 }
 
-void readPrimitiveTask (const Domain & state, std::istream & input, Task & outputTask)
+template <typename Input>
+void readPrimitiveTask (const Domain & state, Input & input, Task & outputTask)
 {
 	outputTask.type = Task::Type::PRIMITIVE;
 	outputTask.isCompiledConditionalEffect = false;
@@ -187,7 +199,8 @@ void readPrimitiveTask (const Domain & state, std::istream & input, Task & outpu
 	readMultiple (state, input, outputTask.variableConstraints, readVariableConstraint);
 }
 
-void readAbstractTask (const Domain & state, std::istream & input, Task & outputTask)
+template <typename Input>
+void readAbstractTask (const Domain & state, Input & input, Task & outputTask)
 {
 	outputTask.type = Task::Type::ABSTRACT;
 	outputTask.isCompiledConditionalEffect = false;
@@ -199,12 +212,14 @@ void readAbstractTask (const Domain & state, std::istream & input, Task & output
 	readMultiple (state, input, outputTask.variableSorts, readPrimitive);
 }
 
-void readOrderingConstraint (const Domain & state, std::istream & input, std::pair<int, int> & outputOrderingConstraint)
+template <typename Input>
+void readOrderingConstraint (const Domain & state, Input & input, std::pair<int, int> & outputOrderingConstraint)
 {
 	input >> outputOrderingConstraint.first >> outputOrderingConstraint.second;
 }
 
-void readDecompositionMethod (const Domain & state, std::istream & input, DecompositionMethod & outputMethod)
+template <typename Input>
+void readDecompositionMethod (const Domain & state, Input & input, DecompositionMethod & outputMethod)
 {
 	input >> outputMethod.name;
 	//std::cerr << "Name: " << outputMethod.name << std::endl;
@@ -229,15 +244,15 @@ void readDecompositionMethod (const Domain & state, std::istream & input, Decomp
 	readMultiple (state, input, outputMethod.variableConstraints, readVariableConstraint);
 }
 
-void parseInput (std::istream & input, Domain & output, Problem & outputProblem)
+/**
+ * @brief Reads the constants and sorts, which are the part of the domain that depends on the problem.
+ */
+template <typename Input>
+void parseProblemObjects (Input & input, Domain & output)
 {
 	// Helper alias that we can pass to other functions
 	const Domain & state = output;
 
-	// Enable exceptions so we don't have to explicitly check each time we read something
-	std::ios::iostate exceptionMask = input.exceptions ();
-	input.exceptions (std::ifstream::failbit);
-
 	// Number of constants and sorts
 	size_t nConstants;
 	size_t nSorts;
@@ -250,6 +265,16 @@ void parseInput (std::istream & input, Domain & output, Problem & outputProblem)
 	// Read sort names and members
 	DEBUG (std::cerr << "Reading [" << nSorts << "] sorts." << std::endl);
 	readN (state, input, output.sorts, readSort, nSorts);
+}
+
+/**
+ * @brief Reads the predicates, functions, tasks and methods, which do not refer to the constants.
+ */
+template <typename Input>
+void parseDomainSchemas (Input & input, Domain & output)
+{
+	// Helper alias that we can pass to other functions
+	const Domain & state = output;
 
 	// Read predicates
 	readMultiple (state, input, output.predicates, readPredicate);
@@ -290,6 +315,18 @@ void parseInput (std::istream & input, Domain & output, Problem & outputProblem)
 		output.tasks[method.taskNo].decompositionMethods.push_back (methodIdx);
 	}
 
+	output.computeStaticPredicates ();
+}
+
+/**
+ * @brief Reads the initial state, the goal and the initial task, and prepares the domain for them.
+ */
+template <typename Input>
+void parseProblemState (Input & input, Domain & output, Problem & outputProblem)
+{
+	// Helper alias that we can pass to other functions
+	const Domain & state = output;
+
 	// Read facts for initial and goal state
 	int nInitFacts;
 	int nGoalFacts;
@@ -304,8 +341,8 @@ void parseInput (std::istream & input, Domain & output, Problem & outputProblem)
 	// Read initial task
 	input >> outputProblem.initialAbstractTask;
 
-	// Reset exception mask
-	input.exceptions (exceptionMask);
+	// All sort checks use the member bitsets
+	output.buildSortMemberBits ();
 
 	// sort preconditions by descending number of ground instances in the initial state
 	std::map<int,int> init_preciate_count;
@@ -318,6 +355,14 @@ void parseInput (std::istream & input, Domain & output, Problem & outputProblem)
 	});
 }
 
+template <typename Input>
+void parseInput (Input & input, Domain & output, Problem & outputProblem)
+{
+	parseProblemObjects (input, output);
+	parseDomainSchemas (input, output);
+	parseProblemState (input, output, outputProblem);
+}
+
 bool readInput (std::istream & is, Domain & output, Problem & outputProblem)
 {
 	// Read the entire stream and remove comments
@@ -332,6 +377,9 @@ bool readInput (std::istream & is, Domain & output, Problem & outputProblem)
 		dataStream << line << "\n";
 	}
 
+	// Enable exceptions so we don't have to explicitly check each time we read something
+	dataStream.exceptions (std::ifstream::failbit);
+
 	try
 	{
 		parseInput (dataStream, output, outputProblem);
@@ -359,3 +407,47 @@ bool readInput (std::istream & is, Domain & output, Problem & outputProblem)
 
 	return true;
 }
+
+/**
+ * @brief Runs the given part of the parser on the tokenizer, and reports where it failed.
+ */
+template <typename Parse>
+bool readInputPart (InputTokenizer & input, Parse parse)
+{
+	try
+	{
+		parse ();
+	}
+	catch (std::ios_base::failure & e)
+	{
+		std::cerr << "Input parse error: " << e.what () << std::endl;
+
+		if (input.atEnd ())
+			std::cerr << "Reached EOF while reading input." << std::endl;
+		else
+			std::cerr << "The error is at line " << input.lineNumber () << ": " << input.currentLine () << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool readInput (InputTokenizer & input, Domain & output, Problem & outputProblem)
+{
+	return readInputPart (input, [&] () { parseInput (input, output, outputProblem); });
+}
+
+bool readProblemObjects (InputTokenizer & input, Domain & output)
+{
+	return readInputPart (input, [&] () { parseProblemObjects (input, output); });
+}
+
+bool readDomainSchemas (InputTokenizer & input, Domain & output)
+{
+	return readInputPart (input, [&] () { parseDomainSchemas (input, output); });
+}
+
+bool readProblemState (InputTokenizer & input, Domain & output, Problem & outputProblem)
+{
+	return readInputPart (input, [&] () { parseProblemState (input, output, outputProblem); });
+}
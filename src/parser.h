@@ -11,6 +11,7 @@
 #include <fstream>
 
 #include "model.h"
+#include "tokenizer.h"
 
 /**
  * @brief Parse input from an input stream.
@@ -21,6 +22,55 @@
  */
 bool readInput (std::istream & is, Domain & output, Problem & outputProblem);
 
+/**
+ * @brief Parse input from an InputTokenizer.
+ *
+ * Gives the same result as readInput() for a std::istream, but the input is tokenized in place instead of being copied into a
+ * std::stringstream first.
+ *
+ * @param[in] input The tokenizer, which has already opened the input.
+ * @param[out] output The Domain object to write to.
+ * @return Returns true if successful, or false if there was an error while reading.
+ */
+bool readInput (InputTokenizer & input, Domain & output, Problem & outputProblem);
+
+/**
+ * @brief Parses the first part of the input from an InputTokenizer: the constants and sorts.
+ *
+ * readProblemObjects(), readDomainSchemas() and readProblemState() read the three consecutive parts of the input one after the
+ * other, with the same result as readInput(). The domain schemas in between do not refer to the constants, so they can be read once
+ * and be reused for other problems of the same domain, skipping their part of the input (see InputTokenizer::seek()).
+ *
+ * @param[in] input The tokenizer, which has already opened the input.
+ * @param[out] output The Domain object to write the constants and sorts to.
+ * @return Returns true if successful, or false if there was an error while reading.
+ */
+bool readProblemObjects (InputTokenizer & input, Domain & output);
+
+/**
+ * @brief Parses the second part of the input from an InputTokenizer: the predicates, functions, tasks and decomposition methods.
+ *
+ * Also determines the static predicates (see Domain::computeStaticPredicates()).
+ *
+ * @param[in] input The tokenizer, positioned after the sorts.
+ * @param[out] output The Domain object to write to. Its constants and sorts are neither needed nor changed.
+ * @return Returns true if successful, or false if there was an error while reading.
+ */
+bool readDomainSchemas (InputTokenizer & input, Domain & output);
+
+/**
+ * @brief Parses the last part of the input from an InputTokenizer: the initial state, the goal and the initial task.
+ *
+ * Completes the domain for the problem: builds the member bitsets of the sorts and orders the preconditions of the tasks by the
+ * number of their instances in the initial state.
+ *
+ * @param[in] input The tokenizer, positioned after the decomposition methods.
+ * @param[in,out] output The Domain object containing both other parts of the input.
+ * @param[out] outputProblem The Problem object to write to.
+ * @return Returns true if successful, or false if there was an error while reading.
+ */
+bool readProblemState (InputTokenizer & input, Domain & output, Problem & outputProblem);
+
 /**
  * @}
  */
@@ -0,0 +1,136 @@
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <time.h>
+
+#include "phasegraph.h"
+
+static double wallClockMs (void)
+{
+	return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+}
+
+static double threadCpuMs (void)
+{
+	timespec time;
+	clock_gettime (CLOCK_THREAD_CPUTIME_ID, &time);
+	return time.tv_sec * 1000.0 + time.tv_nsec / 1e6;
+}
+
+int PhaseGraph::add (std::string name, std::vector<int> dependencies, Phase phase)
+{
+	for ([[maybe_unused]] int dependency : dependencies)
+		assert (dependency >= 0 && size_t (dependency) < phases.size ());
+
+	PhaseInfo info;
+	info.name = std::move (name);
+	info.dependencies = std::move (dependencies);
+	info.phase = std::move (phase);
+	phases.push_back (std::move (info));
+	return phases.size () - 1;
+}
+
+void PhaseGraph::runPhase (PhaseInfo & info, double startOfRun)
+{
+	double wallStart = wallClockMs ();
+	double cpuStart = threadCpuMs ();
+	info.startMs = wallStart - startOfRun;
+
+	info.phase ();
+
+	info.wallMs = wallClockMs () - wallStart;
+	info.cpuMs = threadCpuMs () - cpuStart;
+}
+
+void PhaseGraph::run (bool concurrent)
+{
+	double startOfRun = wallClockMs ();
+
+	if (!concurrent)
+	{
+		for (PhaseInfo & info : phases)
+			runPhase (info, startOfRun);
+		totalWallMs = wallClockMs () - startOfRun;
+		return;
+	}
+
+	// Per phase, the number of dependencies that have not finished yet
+	std::vector<int> missingDependencies (phases.size ());
+	std::vector<std::vector<int>> dependents (phases.size ());
+	std::vector<int> ready;
+	for (size_t phase = 0; phase < phases.size (); ++phase)
+	{
+		missingDependencies[phase] = phases[phase].dependencies.size ();
+		for (int dependency : phases[phase].dependencies)
+			dependents[dependency].push_back (phase);
+		if (missingDependencies[phase] == 0)
+			ready.push_back (phase);
+	}
+
+	std::mutex mutex;
+	std::condition_variable phaseFinished;
+	std::vector<std::thread> threads;
+	size_t started = 0;
+	size_t finished = 0;
+	std::exception_ptr error;
+
+	std::unique_lock<std::mutex> lock (mutex);
+	while (true)
+	{
+		while (!ready.empty () && !error)
+		{
+			int phase = ready.back ();
+			ready.pop_back ();
+			++started;
+			threads.emplace_back ([&, phase] {
+				std::exception_ptr phaseError;
+				try
+				{
+					runPhase (phases[phase], startOfRun);
+				}
+				catch (...)
+				{
+					phaseError = std::current_exception ();
+				}
+
+				std::lock_guard<std::mutex> finishedLock (mutex);
+				++finished;
+				if (phaseError && !error)
+					error = phaseError;
+				for (int dependent : dependents[phase])
+					if (--missingDependencies[dependent] == 0)
+						ready.push_back (dependent);
+				phaseFinished.notify_one ();
+			});
+		}
+
+		if (finished == started && (ready.empty () || error))
+			break;
+		phaseFinished.wait (lock);
+	}
+	lock.unlock ();
+
+	for (std::thread & thread : threads)
+		thread.join ();
+	totalWallMs = wallClockMs () - startOfRun;
+
+	if (error)
+		std::rethrow_exception (error);
+}
+
+void PhaseGraph::printTimings (std::ostream & out) const
+{
+	double sumOfPhasesMs = 0;
+	for (const PhaseInfo & info : phases)
+	{
+		out << "Phase " << info.name << ": start " << std::fixed << std::setprecision (1) << info.startMs << " ms, wall " << info.wallMs
+			<< " ms, CPU " << info.cpuMs << " ms" << std::defaultfloat << std::endl;
+		sumOfPhasesMs += info.wallMs;
+	}
+	out << "Phases: " << std::fixed << std::setprecision (1) << totalWallMs << " ms wall, " << sumOfPhasesMs << " ms in sequence" << std::defaultfloat
+		<< std::endl;
+}
@@ -0,0 +1,75 @@
+#ifndef PHASEGRAPH_H_INCLUDED
+#define PHASEGRAPH_H_INCLUDED
+
+/**
+ * @defgroup phasegraph Phase Graph
+ * @brief Runs the phases of the grounding pipeline along their dependencies.
+ *
+ * @{
+ */
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A dependency graph of the phases of the grounding, e.g. the FAM inference, the lifted and the grounded GPG and the output.
+ *
+ * A phase may only depend on phases that were added before it, so the order of the phases is a topological order.
+ * Sequentially, the phases run in this order on the calling thread. Concurrently, every phase is started on its own thread as soon
+ * as all of its dependencies have finished. The phases themselves have to make sure that phases running at the same time do not
+ * touch the same data.
+ */
+class PhaseGraph
+{
+public:
+	/// Signature of a phase
+	using Phase = std::function<void (void)>;
+
+	/**
+	 * @brief Adds a phase that runs after all of the given phases and returns its number.
+	 */
+	int add (std::string name, std::vector<int> dependencies, Phase phase);
+
+	/**
+	 * @brief Runs all phases and returns after the last one has finished.
+	 *
+	 * If a phase throws an exception, no further phases are started and the first exception is rethrown once the running phases
+	 * have finished.
+	 */
+	void run (bool concurrent);
+
+	/**
+	 * @brief Prints the wall clock time of every phase, its start relative to the first phase and the CPU time of the thread running it.
+	 *
+	 * The CPU time does not include worker threads started by the phase, e.g. those of --threads.
+	 */
+	void printTimings (std::ostream & out) const;
+
+private:
+	struct PhaseInfo
+	{
+		std::string name;
+		std::vector<int> dependencies;
+		Phase phase;
+
+		double startMs = 0;
+		double wallMs = 0;
+		double cpuMs = 0;
+	};
+
+	std::vector<PhaseInfo> phases;
+	double totalWallMs = 0;
+
+	/**
+	 * @brief Runs the given phase on the calling thread and records its times.
+	 */
+	void runPhase (PhaseInfo & info, double startOfRun);
+};
+
+/**
+ * @}
+ */
+
+#endif
@@ -0,0 +1,813 @@
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "plannerformat.h"
+
+void TextPlannerWriter::list (const std::vector<int> & values)
+{
+	for (int value : values)
+		out << value << " ";
+	out << -1 << std::endl;
+}
+
+void TextPlannerWriter::effects (const std::vector<int> & blocks)
+{
+	for (size_t i = 0; i < blocks.size (); i += blocks[i] + 2)
+	{
+		out << blocks[i] << " ";
+		for (int j = 1; j <= blocks[i]; j++)
+			out << blocks[i + j] << " ";
+		out << blocks[i + blocks[i] + 1] << "  ";
+	}
+	out << -1 << std::endl;
+}
+
+void TextPlannerWriter::stateFeatures (size_t count)
+{
+	out << ";; #state features" << std::endl;
+	out << count << std::endl;
+}
+
+void TextPlannerWriter::stateFeature (std::string_view name)
+{
+	out << name << std::endl;
+}
+
+void TextPlannerWriter::mutexGroups (size_t count)
+{
+	out << std::endl << ";; Mutex Groups" << std::endl;
+	out << count << std::endl;
+}
+
+void TextPlannerWriter::mutexGroup (int first, int last, std::string_view name)
+{
+	out << first << " " << last << " " << name << std::endl;
+}
+
+void TextPlannerWriter::furtherMutexes (bool strict, size_t count)
+{
+	out << std::endl;
+	if (strict)
+		out << ";; further strict Mutex Groups" << std::endl;
+	else
+		out << ";; further non strict Mutex Groups" << std::endl;
+	out << count << std::endl;
+}
+
+void TextPlannerWriter::furtherMutex (const std::vector<int> & stateFeatures)
+{
+	list (stateFeatures);
+}
+
+void TextPlannerWriter::invariants (size_t count)
+{
+	out << std::endl << ";; known invariants" << std::endl;
+	out << count << std::endl;
+}
+
+void TextPlannerWriter::invariant (const std::vector<int> & literals)
+{
+	list (literals);
+}
+
+void TextPlannerWriter::actions (size_t count)
+{
+	out << std::endl << ";; Actions" << std::endl;
+	out << count << std::endl;
+}
+
+void TextPlannerWriter::action (int cost, const std::vector<int> & preconditions, const std::vector<int> & addEffects, const std::vector<int> & deleteEffects)
+{
+	out << cost << std::endl;
+	list (preconditions);
+	effects (addEffects);
+	effects (deleteEffects);
+}
+
+void TextPlannerWriter::initialState (const std::vector<int> & stateFeatures)
+{
+	out << std::endl << ";; initial state" << std::endl;
+	list (stateFeatures);
+}
+
+void TextPlannerWriter::goal (const std::vector<int> & stateFeatures)
+{
+	out << std::endl << ";; goal" << std::endl;
+	list (stateFeatures);
+}
+
+void TextPlannerWriter::tasks (size_t count)
+{
+	out << std::endl << ";; tasks (primitive and abstract)" << std::endl;
+	out << count << std::endl;
+}
+
+void TextPlannerWriter::task (bool abstract, std::string_view prefix, std::string_view name)
+{
+	out << (abstract ? 1 : 0) << " " << prefix << name << std::endl;
+}
+
+void TextPlannerWriter::initialAbstractTask (int task)
+{
+	out << std::endl << ";; initial abstract task" << std::endl;
+	out << task << std::endl;
+}
+
+void TextPlannerWriter::methods (size_t count)
+{
+	out << std::endl << ";; methods" << std::endl;
+	out << count << std::endl;
+}
+
+void TextPlannerWriter::method (std::string_view prefix, std::string_view name, int abstractTask, const std::vector<int> & subtasks, const std::vector<int> & orderings)
+{
+	out << prefix << name << std::endl;
+	out << abstractTask << std::endl;
+	list (subtasks);
+	list (orderings);
+}
+
+std::unique_ptr<PlannerWriter> TextPlannerWriter::part (void) const
+{
+	return std::unique_ptr<PlannerWriter> (new TextPlannerWriter (std::make_unique<BufferedOutput> ()));
+}
+
+void TextPlannerWriter::join (PlannerWriter & part)
+{
+	out << static_cast<TextPlannerWriter &> (part).out.contents ();
+}
+
+
+namespace
+{
+	const char binaryMagic[8] = {'P', 'A', 'N', 'D', 'A', 'H', 'T', 'N'};
+	/// Increase whenever the layout changes
+	const uint32_t binaryVersion = 1;
+	/// Magic number, version, number of sections and their offsets
+	const size_t binaryHeaderSize = 8 + 4 + 4 + 8 * BINARY_SECTIONS;
+
+	template <typename T>
+	T littleEndian (T value)
+	{
+		if constexpr (std::endian::native == std::endian::little)
+			return value;
+		else
+		{
+			T result;
+			const unsigned char * in = reinterpret_cast<const unsigned char *> (&value);
+			unsigned char * out = reinterpret_cast<unsigned char *> (&result);
+			for (size_t i = 0; i < sizeof (T); i++)
+				out[i] = in[sizeof (T) - 1 - i];
+			return result;
+		}
+	}
+
+	/**
+	 * @brief Writes the parts of a section in little-endian byte order, or only counts their size if there is no output.
+	 */
+	struct BinarySink
+	{
+		BufferedOutput * out;
+		uint64_t size = 0;
+
+		template <typename T>
+		void words (const T * data, size_t count)
+		{
+			size += count * sizeof (T);
+			if (out == nullptr)
+				return;
+			if constexpr (std::endian::native == std::endian::little)
+				out->write (reinterpret_cast<const char *> (data), count * sizeof (T));
+			else
+				for (size_t i = 0; i < count; i++)
+				{
+					T value = littleEndian (data[i]);
+					out->write (reinterpret_cast<const char *> (&value), sizeof (T));
+				}
+		}
+
+		void number (uint64_t value)
+		{
+			words (&value, 1);
+		}
+
+		/// Every part starts at a multiple of eight bytes
+		void pad (void)
+		{
+			static const char zeros[8] = {};
+			size_t padding = (8 - size % 8) % 8;
+			size += padding;
+			if (out != nullptr)
+				out->write (zeros, padding);
+		}
+
+		void array (const std::vector<int32_t> & values)
+		{
+			number (values.size ());
+			words (values.data (), values.size ());
+			pad ();
+		}
+
+		void table (const BinaryPlannerWriter::Table & table)
+		{
+			number (table.offsets.size () - 1);
+			words (table.offsets.data (), table.offsets.size ());
+			words (table.values.data (), table.values.size ());
+			pad ();
+		}
+	};
+
+	/**
+	 * @brief Reads the parts of a section in place and checks that they stay within it.
+	 */
+	struct BinaryCursor
+	{
+		const char * position;
+		const char * end;
+		bool valid = true;
+
+		template <typename T>
+		std::span<const T> words (uint64_t count)
+		{
+			if (!valid || uint64_t (end - position) / sizeof (T) < count)
+			{
+				valid = false;
+				return {};
+			}
+			std::span<const T> result (reinterpret_cast<const T *> (position), count);
+			position += count * sizeof (T);
+			return result;
+		}
+
+		uint64_t number (void)
+		{
+			std::span<const uint64_t> value = words<uint64_t> (1);
+			return valid ? value[0] : 0;
+		}
+
+		void pad (void)
+		{
+			// the mapping is page aligned, so the offsets in the file and the addresses agree
+			size_t padding = (8 - reinterpret_cast<uintptr_t> (position) % 8) % 8;
+			if (size_t (end - position) < padding)
+				valid = false;
+			else
+				position += padding;
+		}
+
+		std::span<const int32_t> array (void)
+		{
+			uint64_t count = number ();
+			std::span<const int32_t> values = words<int32_t> (count);
+			pad ();
+			return values;
+		}
+
+		BinaryPlannerFile::Table table (void)
+		{
+			BinaryPlannerFile::Table table;
+			uint64_t rows = number ();
+			if (rows == uint64_t (-1))
+				valid = false;
+			table.offsets = words<uint64_t> (rows + 1);
+			if (!valid)
+				return {};
+			for (uint64_t row = 0; row < rows; row++)
+				if (table.offsets[row] > table.offsets[row + 1])
+					valid = false;
+			if (table.offsets[0] != 0)
+				valid = false;
+			table.values = words<int32_t> (table.offsets[rows]);
+			pad ();
+			return valid ? table : BinaryPlannerFile::Table ();
+		}
+	};
+}
+
+int32_t BinaryPlannerWriter::addString (std::string_view prefix, std::string_view name)
+{
+	characters += prefix;
+	characters += name;
+	stringEnds.push_back (characters.size ());
+	return stringEnds.size () - 1;
+}
+
+void BinaryPlannerWriter::stateFeatures (size_t count)
+{
+	stateFeatureNames.reserve (count);
+}
+
+void BinaryPlannerWriter::stateFeature (std::string_view name)
+{
+	stateFeatureNames.push_back (addString ("", name));
+}
+
+void BinaryPlannerWriter::mutexGroups (size_t count)
+{
+	mutexGroupFirst.reserve (count);
+	mutexGroupLast.reserve (count);
+	mutexGroupNames.reserve (count);
+}
+
+void BinaryPlannerWriter::mutexGroup (int first, int last, std::string_view name)
+{
+	mutexGroupFirst.push_back (first);
+	mutexGroupLast.push_back (last);
+	mutexGroupNames.push_back (addString ("", name));
+}
+
+void BinaryPlannerWriter::furtherMutexes (bool strict, size_t count)
+{
+	currentMutexes = strict ? &strictMutexes : &nonStrictMutexes;
+	currentMutexes->offsets.reserve (count + 1);
+}
+
+void BinaryPlannerWriter::furtherMutex (const std::vector<int> & stateFeatures)
+{
+	currentMutexes->add (stateFeatures);
+}
+
+void BinaryPlannerWriter::invariants (size_t count)
+{
+	invariantTable.offsets.reserve (count + 1);
+}
+
+void BinaryPlannerWriter::invariant (const std::vector<int> & literals)
+{
+	invariantTable.add (literals);
+}
+
+void BinaryPlannerWriter::actions (size_t count)
+{
+	actionCosts.reserve (count);
+	actionPreconditions.offsets.reserve (count + 1);
+	actionAddEffects.offsets.reserve (count + 1);
+	actionDeleteEffects.offsets.reserve (count + 1);
+}
+
+void BinaryPlannerWriter::action (int cost, const std::vector<int> & preconditions, const std::vector<int> & addEffects, const std::vector<int> & deleteEffects)
+{
+	actionCosts.push_back (cost);
+	actionPreconditions.add (preconditions);
+	actionAddEffects.add (addEffects);
+	actionDeleteEffects.add (deleteEffects);
+}
+
+void BinaryPlannerWriter::initialState (const std::vector<int> & stateFeatures)
+{
+	initialStateFeatures.assign (stateFeatures.begin (), stateFeatures.end ());
+}
+
+void BinaryPlannerWriter::goal (const std::vector<int> & stateFeatures)
+{
+	goalFeatures.assign (stateFeatures.begin (), stateFeatures.end ());
+}
+
+void BinaryPlannerWriter::tasks (size_t count)
+{
+	taskAbstract.reserve (count);
+	taskNames.reserve (count);
+}
+
+void BinaryPlannerWriter::task (bool abstract, std::string_view prefix, std::string_view name)
+{
+	taskAbstract.push_back (abstract ? 1 : 0);
+	taskNames.push_back (addString (prefix, name));
+}
+
+void BinaryPlannerWriter::initialAbstractTask (int task)
+{
+	initialTask = task;
+}
+
+void BinaryPlannerWriter::methods (size_t count)
+{
+	methodNames.reserve (count);
+	methodTasks.reserve (count);
+	methodSubtasks.offsets.reserve (count + 1);
+	methodOrderings.offsets.reserve (count + 1);
+}
+
+void BinaryPlannerWriter::method (std::string_view prefix, std::string_view name, int abstractTask, const std::vector<int> & subtasks, const std::vector<int> & orderings)
+{
+	methodNames.push_back (addString (prefix, name));
+	methodTasks.push_back (abstractTask);
+	methodSubtasks.add (subtasks);
+	methodOrderings.add (orderings);
+}
+
+std::unique_ptr<PlannerWriter> BinaryPlannerWriter::part (void) const
+{
+	std::unique_ptr<BinaryPlannerWriter> result (new BinaryPlannerWriter ());
+	if (currentMutexes == &strictMutexes)
+		result->currentMutexes = &result->strictMutexes;
+	else if (currentMutexes == &nonStrictMutexes)
+		result->currentMutexes = &result->nonStrictMutexes;
+	return result;
+}
+
+void BinaryPlannerWriter::join (PlannerWriter & part)
+{
+	const BinaryPlannerWriter & other = static_cast<const BinaryPlannerWriter &> (part);
+
+	// the strings of the part are numbered from 0
+	int32_t firstString = stringEnds.size ();
+	for (uint64_t end : other.stringEnds)
+		stringEnds.push_back (characters.size () + end);
+	characters += other.characters;
+	auto names = [&] (std::vector<int32_t> & to, const std::vector<int32_t> & from)
+	{
+		for (int32_t name : from)
+			to.push_back (firstString + name);
+	};
+	auto values = [] (std::vector<int32_t> & to, const std::vector<int32_t> & from)
+	{
+		to.insert (to.end (), from.begin (), from.end ());
+	};
+
+	names (stateFeatureNames, other.stateFeatureNames);
+	values (mutexGroupFirst, other.mutexGroupFirst);
+	values (mutexGroupLast, other.mutexGroupLast);
+	names (mutexGroupNames, other.mutexGroupNames);
+	strictMutexes.append (other.strictMutexes);
+	nonStrictMutexes.append (other.nonStrictMutexes);
+	invariantTable.append (other.invariantTable);
+	values (actionCosts, other.actionCosts);
+	actionPreconditions.append (other.actionPreconditions);
+	actionAddEffects.append (other.actionAddEffects);
+	actionDeleteEffects.append (other.actionDeleteEffects);
+	values (taskAbstract, other.taskAbstract);
+	names (taskNames, other.taskNames);
+	names (methodNames, other.methodNames);
+	values (methodTasks, other.methodTasks);
+	methodSubtasks.append (other.methodSubtasks);
+	methodOrderings.append (other.methodOrderings);
+}
+
+void BinaryPlannerWriter::finish (void)
+{
+	auto section = [&] (BinarySink & sink, int number)
+	{
+		switch (number)
+		{
+			case BINARY_STATE_FEATURES:
+				sink.array (stateFeatureNames);
+				break;
+			case BINARY_MUTEX_GROUPS:
+				sink.array (mutexGroupFirst);
+				sink.array (mutexGroupLast);
+				sink.array (mutexGroupNames);
+				break;
+			case BINARY_STRICT_MUTEXES:
+				sink.table (strictMutexes);
+				break;
+			case BINARY_NON_STRICT_MUTEXES:
+				sink.table (nonStrictMutexes);
+				break;
+			case BINARY_INVARIANTS:
+				sink.table (invariantTable);
+				break;
+			case BINARY_ACTIONS:
+				sink.array (actionCosts);
+				sink.table (actionPreconditions);
+				sink.table (actionAddEffects);
+				sink.table (actionDeleteEffects);
+				break;
+			case BINARY_INITIAL_STATE:
+				sink.array (initialStateFeatures);
+				break;
+			case BINARY_GOAL:
+				sink.array (goalFeatures);
+				break;
+			case BINARY_TASKS:
+				sink.array (taskAbstract);
+				sink.array (taskNames);
+				break;
+			case BINARY_INITIAL_ABSTRACT_TASK:
+				sink.array ({initialTask});
+				break;
+			case BINARY_METHODS:
+				sink.array (methodNames);
+				sink.array (methodTasks);
+				sink.table (methodSubtasks);
+				sink.table (methodOrderings);
+				break;
+			case BINARY_STRINGS:
+				sink.number (stringEnds.size ());
+				sink.words (stringEnds.data (), stringEnds.size ());
+				sink.words (characters.data (), characters.size ());
+				sink.pad ();
+				break;
+		}
+	};
+
+	// every section is preceded by the size of its contents
+	uint64_t sizes[BINARY_SECTIONS];
+	uint64_t offsets[BINARY_SECTIONS];
+	uint64_t offset = binaryHeaderSize;
+	for (int number = 0; number < BINARY_SECTIONS; number++)
+	{
+		BinarySink counter {nullptr};
+		section (counter, number);
+		sizes[number] = counter.size;
+		offsets[number] = offset;
+		offset += 8 + sizes[number];
+	}
+
+	BinarySink sink {out};
+	sink.words (binaryMagic, 8);
+	uint32_t header[2] = {binaryVersion, BINARY_SECTIONS};
+	sink.words (header, 2);
+	sink.words (offsets, BINARY_SECTIONS);
+	for (int number = 0; number < BINARY_SECTIONS; number++)
+	{
+		sink.number (sizes[number]);
+		section (sink, number);
+	}
+}
+
+void writeParallel (PlannerWriter & writer, ThreadPool * pool, size_t count, const std::function<void (PlannerWriter & writer, size_t index)> & entry)
+{
+	if (pool == nullptr || pool->size () == 1)
+	{
+		for (size_t index = 0; index < count; index++)
+			entry (writer, index);
+		return;
+	}
+
+	// the chunks are written in rounds, such that only the parts of one round are held in memory at a time
+	const size_t chunkSize = 256;
+	const size_t chunksPerRound = 16 * pool->size ();
+	std::vector<std::unique_ptr<PlannerWriter>> parts (chunksPerRound);
+	for (size_t roundBegin = 0; roundBegin < count; roundBegin += chunkSize * chunksPerRound)
+	{
+		size_t chunks = std::min (chunksPerRound, (count - roundBegin + chunkSize - 1) / chunkSize);
+		pool->run (chunks, [&] (size_t chunk, size_t)
+		{
+			parts[chunk] = writer.part ();
+			size_t begin = roundBegin + chunk * chunkSize;
+			size_t end = std::min (count, begin + chunkSize);
+			for (size_t index = begin; index < end; index++)
+				entry (*parts[chunk], index);
+		});
+
+		for (size_t chunk = 0; chunk < chunks; chunk++)
+		{
+			writer.join (*parts[chunk]);
+			parts[chunk].reset ();
+		}
+	}
+}
+
+void OutputBenchmark::begin (const char * section)
+{
+	if (!enabled)
+		return;
+	measurements.push_back ({section, 0, 0});
+	beginBytes = out.size ();
+	beginTime = std::chrono::steady_clock::now ();
+}
+
+void OutputBenchmark::end (void)
+{
+	if (!enabled)
+		return;
+	Measurement & measurement = measurements.back ();
+	measurement.bytes = out.size () - beginBytes;
+	measurement.ms = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - beginTime).count ();
+}
+
+void OutputBenchmark::print (std::ostream & stream) const
+{
+	if (!enabled)
+		return;
+
+	auto line = [&] (uint64_t bytes, double ms)
+	{
+		stream << std::fixed << std::setprecision (1) << bytes / 1e6 << " MB in " << ms << " ms, ";
+		if (ms > 0)
+			stream << bytes / 1e3 / ms << " MB/s";
+		else
+			stream << "- MB/s";
+		stream << std::defaultfloat << std::endl;
+	};
+
+	uint64_t totalBytes = 0;
+	double totalMs = 0;
+	for (const Measurement & measurement : measurements)
+	{
+		stream << "Output section " << measurement.section << ": ";
+		line (measurement.bytes, measurement.ms);
+		totalBytes += measurement.bytes;
+		totalMs += measurement.ms;
+	}
+	stream << "Output: ";
+	line (totalBytes, totalMs);
+}
+
+
+BinaryPlannerFile::~BinaryPlannerFile ()
+{
+	if (mapping != nullptr)
+		munmap (mapping, mappingSize);
+}
+
+bool BinaryPlannerFile::open (const std::string & filename, std::string & error)
+{
+	if constexpr (std::endian::native != std::endian::little)
+	{
+		error = "the binary format can only be read on little-endian machines";
+		return false;
+	}
+
+	int fd = ::open (filename.c_str (), O_RDONLY);
+	if (fd < 0)
+	{
+		error = strerror (errno);
+		return false;
+	}
+	struct stat status;
+	if (fstat (fd, &status) != 0 || !S_ISREG (status.st_mode))
+	{
+		error = "not a regular file";
+		close (fd);
+		return false;
+	}
+	if (size_t (status.st_size) < binaryHeaderSize)
+	{
+		error = "the file is too short";
+		close (fd);
+		return false;
+	}
+	mappingSize = status.st_size;
+	mapping = mmap (nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (mapping == MAP_FAILED)
+	{
+		mapping = nullptr;
+		error = strerror (errno);
+		return false;
+	}
+
+	const char * file = static_cast<const char *> (mapping);
+	uint32_t header[2];
+	memcpy (header, file + 8, sizeof (header));
+	if (memcmp (file, binaryMagic, 8) != 0)
+	{
+		error = "the file is not in the binary format";
+		return false;
+	}
+	if (header[0] != binaryVersion || header[1] != BINARY_SECTIONS)
+	{
+		error = "the file was written in another version of the binary format";
+		return false;
+	}
+
+	const uint64_t * offsets = reinterpret_cast<const uint64_t *> (file + 16);
+	BinaryCursor cursors[BINARY_SECTIONS];
+	for (int number = 0; number < BINARY_SECTIONS; number++)
+	{
+		uint64_t offset = offsets[number];
+		if (offset % 8 != 0 || offset < binaryHeaderSize || offset > mappingSize - 8)
+		{
+			error = "section " + std::to_string (number) + " is out of bounds";
+			return false;
+		}
+		uint64_t size;
+		memcpy (&size, file + offset, 8);
+		if (size > mappingSize - offset - 8)
+		{
+			error = "section " + std::to_string (number) + " is out of bounds";
+			return false;
+		}
+		cursors[number] = BinaryCursor {file + offset + 8, file + offset + 8 + size};
+	}
+
+	stateFeatureNames = cursors[BINARY_STATE_FEATURES].array ();
+	mutexGroupFirst = cursors[BINARY_MUTEX_GROUPS].array ();
+	mutexGroupLast = cursors[BINARY_MUTEX_GROUPS].array ();
+	mutexGroupNames = cursors[BINARY_MUTEX_GROUPS].array ();
+	strictMutexes = cursors[BINARY_STRICT_MUTEXES].table ();
+	nonStrictMutexes = cursors[BINARY_NON_STRICT_MUTEXES].table ();
+	invariants = cursors[BINARY_INVARIANTS].table ();
+	actionCosts = cursors[BINARY_ACTIONS].array ();
+	actionPreconditions = cursors[BINARY_ACTIONS].table ();
+	actionAddEffects = cursors[BINARY_ACTIONS].table ();
+	actionDeleteEffects = cursors[BINARY_ACTIONS].table ();
+	initialState = cursors[BINARY_INITIAL_STATE].array ();
+	goal = cursors[BINARY_GOAL].array ();
+	taskAbstract = cursors[BINARY_TASKS].array ();
+	taskNames = cursors[BINARY_TASKS].array ();
+	std::span<const int32_t> initialTask = cursors[BINARY_INITIAL_ABSTRACT_TASK].array ();
+	methodNames = cursors[BINARY_METHODS].array ();
+	methodTasks = cursors[BINARY_METHODS].array ();
+	methodSubtasks = cursors[BINARY_METHODS].table ();
+	methodOrderings = cursors[BINARY_METHODS].table ();
+	BinaryCursor & strings = cursors[BINARY_STRINGS];
+	stringEnds = strings.words<uint64_t> (strings.number ());
+	characters = strings.position;
+
+	for (int number = 0; number < BINARY_SECTIONS; number++)
+		if (!cursors[number].valid)
+		{
+			error = "section " + std::to_string (number) + " is damaged";
+			return false;
+		}
+
+	// the parts of a section describe the same entries
+	bool consistent = mutexGroupLast.size () == mutexGroupFirst.size () && mutexGroupNames.size () == mutexGroupFirst.size ()
+		&& actionPreconditions.size () == actionCosts.size () && actionAddEffects.size () == actionCosts.size ()
+		&& actionDeleteEffects.size () == actionCosts.size () && taskNames.size () == taskAbstract.size () && initialTask.size () == 1
+		&& methodTasks.size () == methodNames.size () && methodSubtasks.size () == methodNames.size ()
+		&& methodOrderings.size () == methodNames.size ();
+	if (!consistent)
+	{
+		error = "the parts of a section do not match";
+		return false;
+	}
+	initialAbstractTask = initialTask[0];
+
+	uint64_t numberOfCharacters = strings.end - strings.position;
+	for (size_t i = 0; i < stringEnds.size (); i++)
+		if (stringEnds[i] > numberOfCharacters || (i > 0 && stringEnds[i] < stringEnds[i - 1]))
+		{
+			error = "the string table is damaged";
+			return false;
+		}
+	for (std::span<const int32_t> names : {stateFeatureNames, mutexGroupNames, taskNames, methodNames})
+		for (int32_t name : names)
+			if (name < 0 || size_t (name) >= stringEnds.size ())
+			{
+				error = "a name is not in the string table";
+				return false;
+			}
+
+	// every effect consists of the number of its conditions, the conditions and the effect itself
+	for (const Table * effects : {&actionAddEffects, &actionDeleteEffects})
+		for (size_t action = 0; action < effects->size (); action++)
+		{
+			std::span<const int32_t> blocks = (*effects)[action];
+			for (size_t i = 0; i < blocks.size (); i += blocks[i] + 2)
+				if (blocks[i] < 0 || blocks.size () - i < size_t (blocks[i]) + 2)
+				{
+					error = "the effects of action " + std::to_string (action) + " are damaged";
+					return false;
+				}
+		}
+
+	return true;
+}
+
+void BinaryPlannerFile::replay (PlannerWriter & writer) const
+{
+	auto vector = [] (std::span<const int32_t> values)
+	{
+		return std::vector<int> (values.begin (), values.end ());
+	};
+
+	writer.stateFeatures (stateFeatureNames.size ());
+	for (int32_t name : stateFeatureNames)
+		writer.stateFeature (string (name));
+
+	writer.mutexGroups (mutexGroupFirst.size ());
+	for (size_t i = 0; i < mutexGroupFirst.size (); i++)
+		writer.mutexGroup (mutexGroupFirst[i], mutexGroupLast[i], string (mutexGroupNames[i]));
+
+	for (bool strict : {true, false})
+	{
+		const Table & mutexes = strict ? strictMutexes : nonStrictMutexes;
+		writer.furtherMutexes (strict, mutexes.size ());
+		for (size_t i = 0; i < mutexes.size (); i++)
+			writer.furtherMutex (vector (mutexes[i]));
+	}
+
+	writer.invariants (invariants.size ());
+	for (size_t i = 0; i < invariants.size (); i++)
+		writer.invariant (vector (invariants[i]));
+
+	writer.actions (actionCosts.size ());
+	for (size_t i = 0; i < actionCosts.size (); i++)
+		writer.action (actionCosts[i], vector (actionPreconditions[i]), vector (actionAddEffects[i]), vector (actionDeleteEffects[i]));
+
+	writer.initialState (vector (initialState));
+	writer.goal (vector (goal));
+
+	writer.tasks (taskAbstract.size ());
+	for (size_t i = 0; i < taskAbstract.size (); i++)
+		writer.task (taskAbstract[i], "", string (taskNames[i]));
+
+	writer.initialAbstractTask (initialAbstractTask);
+
+	writer.methods (methodNames.size ());
+	for (size_t i = 0; i < methodNames.size (); i++)
+		writer.method ("", string (methodNames[i]), methodTasks[i], vector (methodSubtasks[i]), vector (methodOrderings[i]));
+
+	writer.finish ();
+}
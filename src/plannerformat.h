@@ -0,0 +1,349 @@
+#ifndef PLANNERFORMAT_H_INCLUDED
+#define PLANNERFORMAT_H_INCLUDED
+
+/**
+ * @defgroup plannerformat Planner Format
+ * @brief Writers for the grounded HTN format read by the planner, as text or as binary, and a reader for the binary format.
+ *
+ * The text format is described in doc/panda-grounded-format-documentation.md, the binary format in
+ * doc/panda-grounded-binary-format-documentation.md.
+ *
+ * @{
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bufferedoutput.h"
+#include "threadpool.h"
+
+/**
+ * @brief Receives the eleven sections of the grounded HTN format in their order.
+ *
+ * Every section is started with the number of its entries, followed by exactly that many entries. Lists of integers are passed
+ * without the terminating -1 of the text format. The add and delete effects of an action are the concatenation of their blocks, each
+ * consisting of the number of conditions, the conditions and the effect.
+ */
+class PlannerWriter
+{
+public:
+	virtual ~PlannerWriter () = default;
+
+	virtual void stateFeatures (size_t count) = 0;
+	virtual void stateFeature (std::string_view name) = 0;
+
+	virtual void mutexGroups (size_t count) = 0;
+	virtual void mutexGroup (int first, int last, std::string_view name) = 0;
+
+	virtual void furtherMutexes (bool strict, size_t count) = 0;
+	virtual void furtherMutex (const std::vector<int> & stateFeatures) = 0;
+
+	virtual void invariants (size_t count) = 0;
+	virtual void invariant (const std::vector<int> & literals) = 0;
+
+	virtual void actions (size_t count) = 0;
+	virtual void action (int cost, const std::vector<int> & preconditions, const std::vector<int> & addEffects, const std::vector<int> & deleteEffects) = 0;
+
+	virtual void initialState (const std::vector<int> & stateFeatures) = 0;
+	virtual void goal (const std::vector<int> & stateFeatures) = 0;
+
+	virtual void tasks (size_t count) = 0;
+	/// The name of the task is the concatenation of prefix and name
+	virtual void task (bool abstract, std::string_view prefix, std::string_view name) = 0;
+
+	virtual void initialAbstractTask (int task) = 0;
+
+	virtual void methods (size_t count) = 0;
+	/// The name of the method is the concatenation of prefix and name, orderings contains the pairs of ordered subtasks one after another
+	virtual void method (std::string_view prefix, std::string_view name, int abstractTask, const std::vector<int> & subtasks, const std::vector<int> & orderings) = 0;
+
+	/**
+	 * @brief Completes the output after the last section.
+	 */
+	virtual void finish (void) = 0;
+
+	/**
+	 * @brief Returns an empty writer of the same kind, which takes entries of the current section, e.g. from another thread.
+	 *
+	 * The part must neither start a section nor be finished. Creating a part does not change this writer.
+	 */
+	virtual std::unique_ptr<PlannerWriter> part (void) const = 0;
+
+	/**
+	 * @brief Adds the entries written to a part of this writer, as if they had been written to this writer instead.
+	 */
+	virtual void join (PlannerWriter & part) = 0;
+};
+
+/**
+ * @brief Writes the text format, line by line as the sections arrive.
+ */
+class TextPlannerWriter : public PlannerWriter
+{
+public:
+	explicit TextPlannerWriter (BufferedOutput & out) : out (out) {}
+
+	void stateFeatures (size_t count) override;
+	void stateFeature (std::string_view name) override;
+	void mutexGroups (size_t count) override;
+	void mutexGroup (int first, int last, std::string_view name) override;
+	void furtherMutexes (bool strict, size_t count) override;
+	void furtherMutex (const std::vector<int> & stateFeatures) override;
+	void invariants (size_t count) override;
+	void invariant (const std::vector<int> & literals) override;
+	void actions (size_t count) override;
+	void action (int cost, const std::vector<int> & preconditions, const std::vector<int> & addEffects, const std::vector<int> & deleteEffects) override;
+	void initialState (const std::vector<int> & stateFeatures) override;
+	void goal (const std::vector<int> & stateFeatures) override;
+	void tasks (size_t count) override;
+	void task (bool abstract, std::string_view prefix, std::string_view name) override;
+	void initialAbstractTask (int task) override;
+	void methods (size_t count) override;
+	void method (std::string_view prefix, std::string_view name, int abstractTask, const std::vector<int> & subtasks, const std::vector<int> & orderings) override;
+	void finish (void) override {}
+	std::unique_ptr<PlannerWriter> part (void) const override;
+	void join (PlannerWriter & part) override;
+
+private:
+	/// The output of a part, which formats its entries in memory
+	std::unique_ptr<BufferedOutput> partOutput;
+	BufferedOutput & out;
+
+	explicit TextPlannerWriter (std::unique_ptr<BufferedOutput> partOutput) : partOutput (std::move (partOutput)), out (*this->partOutput) {}
+
+	void list (const std::vector<int> & values);
+	void effects (const std::vector<int> & blocks);
+};
+
+/// The sections of the binary format, in the order of the file. The string table follows the eleven sections of the text format.
+enum BinaryPlannerSection
+{
+	BINARY_STATE_FEATURES,
+	BINARY_MUTEX_GROUPS,
+	BINARY_STRICT_MUTEXES,
+	BINARY_NON_STRICT_MUTEXES,
+	BINARY_INVARIANTS,
+	BINARY_ACTIONS,
+	BINARY_INITIAL_STATE,
+	BINARY_GOAL,
+	BINARY_TASKS,
+	BINARY_INITIAL_ABSTRACT_TASK,
+	BINARY_METHODS,
+	BINARY_STRINGS,
+	BINARY_SECTIONS
+};
+
+/**
+ * @brief Writes the binary format.
+ *
+ * The sections are collected in memory and written by finish(), since the header at the start of the file holds their offsets.
+ */
+class BinaryPlannerWriter : public PlannerWriter
+{
+public:
+	explicit BinaryPlannerWriter (BufferedOutput & out) : out (&out) {}
+
+	void stateFeatures (size_t count) override;
+	void stateFeature (std::string_view name) override;
+	void mutexGroups (size_t count) override;
+	void mutexGroup (int first, int last, std::string_view name) override;
+	void furtherMutexes (bool strict, size_t count) override;
+	void furtherMutex (const std::vector<int> & stateFeatures) override;
+	void invariants (size_t count) override;
+	void invariant (const std::vector<int> & literals) override;
+	void actions (size_t count) override;
+	void action (int cost, const std::vector<int> & preconditions, const std::vector<int> & addEffects, const std::vector<int> & deleteEffects) override;
+	void initialState (const std::vector<int> & stateFeatures) override;
+	void goal (const std::vector<int> & stateFeatures) override;
+	void tasks (size_t count) override;
+	void task (bool abstract, std::string_view prefix, std::string_view name) override;
+	void initialAbstractTask (int task) override;
+	void methods (size_t count) override;
+	void method (std::string_view prefix, std::string_view name, int abstractTask, const std::vector<int> & subtasks, const std::vector<int> & orderings) override;
+	void finish (void) override;
+	std::unique_ptr<PlannerWriter> part (void) const override;
+	void join (PlannerWriter & part) override;
+
+	/**
+	 * @brief A list of rows in compressed sparse row form: row i consists of values[offsets[i]] to values[offsets[i + 1] - 1].
+	 */
+	struct Table
+	{
+		std::vector<uint64_t> offsets = {0};
+		std::vector<int32_t> values;
+
+		void add (const std::vector<int> & row)
+		{
+			values.insert (values.end (), row.begin (), row.end ());
+			offsets.push_back (values.size ());
+		}
+
+		/// Adds all rows of the other table
+		void append (const Table & other)
+		{
+			uint64_t shift = values.size ();
+			for (size_t row = 1; row < other.offsets.size (); row++)
+				offsets.push_back (shift + other.offsets[row]);
+			values.insert (values.end (), other.values.begin (), other.values.end ());
+		}
+	};
+
+private:
+	/// The output, or nullptr for a part
+	BufferedOutput * out = nullptr;
+
+	BinaryPlannerWriter (void) = default;
+
+	std::vector<int32_t> stateFeatureNames;
+	std::vector<int32_t> mutexGroupFirst, mutexGroupLast, mutexGroupNames;
+	Table strictMutexes, nonStrictMutexes;
+	/// The table furtherMutex() adds to
+	Table * currentMutexes = nullptr;
+	Table invariantTable;
+	std::vector<int32_t> actionCosts;
+	Table actionPreconditions, actionAddEffects, actionDeleteEffects;
+	std::vector<int32_t> initialStateFeatures, goalFeatures;
+	std::vector<int32_t> taskAbstract, taskNames;
+	int32_t initialTask = -1;
+	std::vector<int32_t> methodNames, methodTasks;
+	Table methodSubtasks, methodOrderings;
+
+	/// The string table: string i consists of characters[stringEnds[i - 1]] to characters[stringEnds[i] - 1]
+	std::string characters;
+	std::vector<uint64_t> stringEnds;
+
+	int32_t addString (std::string_view prefix, std::string_view name);
+};
+
+/**
+ * @brief Writes the entries of the current section by calling entry (writer, i) for every i in [0; count), on all threads of the pool.
+ *
+ * Consecutive indices are grouped into chunks, and every chunk is written into its own part of the writer (see PlannerWriter::part()).
+ * The parts are joined in the order of their indices, so the result is the same as calling entry for every index in order, which
+ * is what happens without a pool. entry may write any number of entries, but must not change anything shared between the threads.
+ */
+void writeParallel (PlannerWriter & writer, ThreadPool * pool, size_t count, const std::function<void (PlannerWriter & writer, size_t index)> & entry);
+
+/**
+ * @brief Measures the time spent on the sections of the planner output and the number of bytes they take, for --output-benchmark.
+ *
+ * In the binary format, all sections are written when the writer is finished, so the other sections only take time, but no bytes.
+ */
+class OutputBenchmark
+{
+public:
+	/**
+	 * @brief Measures the bytes written to out. Does nothing unless enabled.
+	 */
+	OutputBenchmark (const BufferedOutput & out, bool enabled) : out (out), enabled (enabled) {}
+
+	/// Starts measuring the given section
+	void begin (const char * section);
+	/// Stops measuring the current section
+	void end (void);
+
+	/**
+	 * @brief Prints the size, time and throughput of every measured section and of all of them together.
+	 */
+	void print (std::ostream & stream) const;
+
+private:
+	struct Measurement
+	{
+		const char * section;
+		uint64_t bytes;
+		double ms;
+	};
+
+	const BufferedOutput & out;
+	bool enabled;
+	std::vector<Measurement> measurements;
+
+	uint64_t beginBytes = 0;
+	std::chrono::steady_clock::time_point beginTime;
+};
+
+/**
+ * @brief Maps a file in the binary format and gives access to its sections without copying or parsing them.
+ *
+ * All sections are checked when the file is opened, so the accessors do not check anything. Since the integers in the file are
+ * little-endian and used in place, the reader only works on little-endian machines.
+ */
+class BinaryPlannerFile
+{
+public:
+	/**
+	 * @brief A list of rows in compressed sparse row form, as in the file.
+	 */
+	struct Table
+	{
+		std::span<const uint64_t> offsets;
+		std::span<const int32_t> values;
+
+		size_t size (void) const
+		{
+			return offsets.size () - 1;
+		}
+
+		std::span<const int32_t> operator[] (size_t row) const
+		{
+			return values.subspan (offsets[row], offsets[row + 1] - offsets[row]);
+		}
+	};
+
+	BinaryPlannerFile (void) = default;
+	~BinaryPlannerFile ();
+
+	BinaryPlannerFile (const BinaryPlannerFile &) = delete;
+	BinaryPlannerFile & operator= (const BinaryPlannerFile &) = delete;
+
+	/**
+	 * @brief Maps the given file and checks it. Returns false and sets error to the reason if it is not a valid file in the binary format.
+	 */
+	bool open (const std::string & filename, std::string & error);
+
+	/**
+	 * @brief Returns the string with the given index in the string table.
+	 */
+	std::string_view string (int32_t index) const
+	{
+		uint64_t begin = index == 0 ? 0 : stringEnds[index - 1];
+		return std::string_view (characters + begin, stringEnds[index] - begin);
+	}
+
+	/**
+	 * @brief Passes all sections to the given writer, e.g. a TextPlannerWriter to convert the file back into the text format.
+	 */
+	void replay (PlannerWriter & writer) const;
+
+	std::span<const int32_t> stateFeatureNames;
+	std::span<const int32_t> mutexGroupFirst, mutexGroupLast, mutexGroupNames;
+	Table strictMutexes, nonStrictMutexes;
+	Table invariants;
+	std::span<const int32_t> actionCosts;
+	Table actionPreconditions, actionAddEffects, actionDeleteEffects;
+	std::span<const int32_t> initialState, goal;
+	std::span<const int32_t> taskAbstract, taskNames;
+	int32_t initialAbstractTask = -1;
+	std::span<const int32_t> methodNames, methodTasks;
+	Table methodSubtasks, methodOrderings;
+
+private:
+	void * mapping = nullptr;
+	size_t mappingSize = 0;
+
+	const char * characters = nullptr;
+	std::span<const uint64_t> stringEnds;
+};
+
+/**
+ * @}
+ */
+
+#endif
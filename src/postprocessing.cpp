@@ -4,6 +4,7 @@
 #include <algorithm>
 
 
+#include "groundedmodel.h"
 #include "util.h"
 #include "postprocessing.h"
 #include "debug.h"
@@ -559,12 +560,9 @@ void removeEmptyMethodPreconditions(const Domain & domain,
 		std::vector<GroundedTask> & inputTasksGroundedPg,
 		std::vector<GroundedMethod> & inputMethodsGroundedTdg){
 
-	std::vector<std::set<int>> taskToMethodsTheyAreContainedIn (inputTasksGroundedPg.size());
-	for (auto & method : inputMethodsGroundedTdg){
-		if (prunedMethods[method.groundedNo]) continue;
-		for (size_t subTaskIdx = 0; subTaskIdx < method.groundedPreconditions.size(); subTaskIdx++)
-			taskToMethodsTheyAreContainedIn[method.groundedPreconditions[subTaskIdx]].insert(method.groundedNo);
-	}
+	// pruned methods are skipped below
+	CsrAdjacency taskToMethodsTheyAreContainedIn = CsrAdjacency::fromLists (inputMethodsGroundedTdg,
+			[] (const GroundedMethod & method) -> const std::vector<int> & { return method.groundedPreconditions; }).reversed (inputTasksGroundedPg.size(), true);
 
 
 	// find method precondition actions that have no unpruned preconditions
@@ -1059,6 +1057,11 @@ void change_to_methods_with_at_most_two_tasks(const Domain & domain,
 
 
 
+bool postprocessingChangesLists(const grounding_configuration & config){
+	// sorting the subtasks only changes the ordering of the subtasks and removing useless facts only prunes them
+	return config.pruneEmptyMethodPreconditions || config.expandChoicelessAbstractTasks || config.compactConsecutivePrimitives || config.atMostTwoTasksPerMethod;
+}
+
 void postprocess_grounding(const Domain & domain, const Problem & problem,
 		std::vector<Fact> & reachableFacts,
 		std::vector<GroundedTask> & reachableTasks,
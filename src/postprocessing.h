@@ -22,4 +22,7 @@ void applyEffectPriority(const Domain & domain,
 		bool & reachabilityNecessary,
 		grounding_configuration & config);
 
+	// whether postprocess_grounding changes the lists of the grounded tasks and methods, and not only the pruning masks
+	bool postprocessingChangesLists(const grounding_configuration & config);
+
 #endif
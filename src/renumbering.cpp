@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include <cassert>
+
+#include "renumbering.h"
+
+void renumberConstants (Domain & domain, Problem & problem, const grounding_configuration & config)
+{
+	const size_t numberOfConstants = domain.constants.size ();
+
+	// Sorts by descending size, so that every sort comes after all sorts containing it
+	std::vector<int> sortsBySize (domain.sorts.size ());
+	std::iota (sortsBySize.begin (), sortsBySize.end (), 0);
+	std::stable_sort (sortsBySize.begin (), sortsBySize.end (), [&] (int sort1, int sort2) { return domain.sorts[sort1].members.size () > domain.sorts[sort2].members.size (); });
+
+	// The parent of a sort is the smallest sort before it that contains it, equal sorts hang below the first of them
+	std::vector<std::vector<int>> children (domain.sorts.size ());
+	std::vector<int> roots;
+	for (size_t position = 0; position < sortsBySize.size (); position++)
+	{
+		const std::set<int> & members = domain.sorts[sortsBySize[position]].members;
+		int parent = -1;
+		for (size_t parentPosition = position; parentPosition-- > 0; )
+		{
+			const std::set<int> & parentMembers = domain.sorts[sortsBySize[parentPosition]].members;
+			if (std::includes (parentMembers.begin (), parentMembers.end (), members.begin (), members.end ()))
+			{
+				parent = sortsBySize[parentPosition];
+				break;
+			}
+		}
+
+		if (parent == -1)
+			roots.push_back (sortsBySize[position]);
+		else
+			children[parent].push_back (sortsBySize[position]);
+	}
+
+	// Visit siblings in the order of their first member, so that constants stay close to their original order
+	auto byFirstMember = [&] (int sort1, int sort2)
+	{
+		const std::set<int> & members1 = domain.sorts[sort1].members;
+		const std::set<int> & members2 = domain.sorts[sort2].members;
+		int first1 = members1.empty () ? numberOfConstants : *members1.begin ();
+		int first2 = members2.empty () ? numberOfConstants : *members2.begin ();
+		return first1 < first2;
+	};
+	std::stable_sort (roots.begin (), roots.end (), byFirstMember);
+	for (std::vector<int> & sortChildren : children)
+		std::stable_sort (sortChildren.begin (), sortChildren.end (), byFirstMember);
+
+	// Number the members of all children of a sort before its remaining members
+	std::vector<int> newNumber (numberOfConstants, -1);
+	int nextNumber = 0;
+	std::vector<std::pair<int, bool>> stack;
+	for (auto rootIt = roots.rbegin (); rootIt != roots.rend (); ++rootIt)
+		stack.emplace_back (*rootIt, false);
+	while (!stack.empty ())
+	{
+		auto [sort, childrenDone] = stack.back ();
+		stack.pop_back ();
+		if (!childrenDone)
+		{
+			stack.emplace_back (sort, true);
+			for (auto childIt = children[sort].rbegin (); childIt != children[sort].rend (); ++childIt)
+				stack.emplace_back (*childIt, false);
+			continue;
+		}
+
+		for (int member : domain.sorts[sort].members)
+			if (newNumber[member] == -1)
+				newNumber[member] = nextNumber++;
+	}
+
+	// Constants of no sort go last
+	for (size_t constant = 0; constant < numberOfConstants; constant++)
+		if (newNumber[constant] == -1)
+			newNumber[constant] = nextNumber++;
+	assert (size_t (nextNumber) == numberOfConstants);
+
+	std::vector<std::string> constants (numberOfConstants);
+	for (size_t constant = 0; constant < numberOfConstants; constant++)
+		constants[newNumber[constant]] = std::move (domain.constants[constant]);
+	domain.constants = std::move (constants);
+
+	for (Sort & sort : domain.sorts)
+	{
+		std::set<int> members;
+		for (int member : sort.members)
+			members.insert (newNumber[member]);
+		sort.members = std::move (members);
+	}
+	domain.buildSortMemberBits ();
+
+	auto renumberFact = [&] (Fact & fact)
+	{
+		for (int & argument : fact.arguments)
+			argument = newNumber[argument];
+	};
+	std::for_each (problem.init.begin (), problem.init.end (), renumberFact);
+	std::for_each (problem.goal.begin (), problem.goal.end (), renumberFact);
+	for (auto & [fact, value] : problem.init_functions)
+		renumberFact (fact);
+
+	if (!config.quietMode)
+	{
+		size_t contiguousSorts = std::count_if (domain.sorts.begin (), domain.sorts.end (), [] (const Sort & sort) { return sort.contiguousMembers; });
+		std::cerr << "Renumbered " << numberOfConstants << " constants, " << contiguousSorts << " of " << domain.sorts.size () << " sorts are contiguous ranges." << std::endl;
+	}
+}
@@ -0,0 +1,31 @@
+#ifndef RENUMBERING_H_INCLUDED
+#define RENUMBERING_H_INCLUDED
+
+/**
+ * @defgroup renumbering Constant Renumbering
+ * @brief Renumbers the constants so that sorts become contiguous ranges of constants.
+ *
+ * @{
+ */
+
+#include "model.h"
+#include "grounding.h"
+
+/**
+ * @brief Renumbers the constants of the domain along the sort hierarchy and rewrites all references to them.
+ *
+ * The sorts form a forest in which the parent of a sort is the smallest sort containing it. The constants are numbered in a
+ * depth-first traversal of this forest, so every sort whose members are not shared with a sort outside its subtree becomes a
+ * contiguous range, which Sort::contains() tests with two comparisons. In particular, this holds for all sorts if the sort
+ * hierarchy is a tree. Constants keep their relative order within a sort wherever possible.
+ *
+ * The names in Domain::constants are permuted as well, so everything printed by name stays the same. Must be called right after
+ * reading the input.
+ */
+void renumberConstants (Domain & domain, Problem & problem, const grounding_configuration & config);
+
+/**
+ * @}
+ */
+
+#endif
@@ -55,8 +55,8 @@ std::pair<std::vector<std::unordered_set<int>>, std::vector<std::unordered_set<i
 		std::vector<bool> & prunedTasks,
 		std::vector<bool> & prunedFacts,
 		std::vector<bool> & prunedMethods,
-		std::unordered_set<int> initFacts,
-		std::unordered_set<Fact> reachableFactsSet,
+		const std::unordered_set<int> & initFacts,
+		const std::unordered_set<Fact> & reachableFactsSet,
 		grounding_configuration & config){
 
 	DEBUG(std::cout << "Computing SAS+ groups" << std::endl);
@@ -98,7 +98,7 @@ std::pair<std::vector<std::unordered_set<int>>, std::vector<std::unordered_set<i
 						// else ok!
 					} else {
 						const FAMVariable & v = g.vars[l.args[argID]];
-						if (!domain.sorts[v.sort].members.count(factArg))
+						if (!domain.sorts[v.sort].contains(factArg))
 							notMatching = true;
 						else if (!v.isCounted){ // a free var, must be assigned consistently
 							int assignment_index = g.vars_to_pos_in_separated_lists[l.args[argID]];
@@ -36,8 +36,8 @@ std::pair<std::vector<std::unordered_set<int>>, std::vector<std::unordered_set<i
 		std::vector<bool> & prunedTasks,
 		std::vector<bool> & prunedFacts,
 		std::vector<bool> & prunedMethods,
-		std::unordered_set<int> initFacts,
-		std::unordered_set<Fact> reachableFactsSet,
+		const std::unordered_set<int> & initFacts,
+		const std::unordered_set<Fact> & reachableFactsSet,
 		grounding_configuration & config);
 
 std::pair<std::vector<bool>,std::vector<bool>> ground_invariant_analysis(const Domain & domain, const Problem & problem,
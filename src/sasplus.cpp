@@ -1,7 +1,7 @@
 #include "sasplus.h"
 #include <unordered_set>
 
-void write_sasplus(std::ostream & sout, const Domain & domain, const Problem & problem,
+void write_sasplus(BufferedOutput & sout, const Domain & domain, const Problem & problem,
 		std::vector<Fact> & reachableFacts,
 		std::vector<GroundedTask> & reachableTasks,
 		std::vector<bool> & prunedFacts,
@@ -21,6 +21,7 @@ void write_sasplus(std::ostream & sout, const Domain & domain, const Problem & p
 	std::vector<int> factOutput;
 	std::vector<int> factIDtoOutputOutput;
 	std::set<Fact> outputFactsSet;
+	NameTable factNames (domain, reachableFacts.size());
 	for(size_t factID = 0; factID < reachableFacts.size(); factID++){
 		if (prunedFacts[factID]) {
 			factIDtoOutputOutput.push_back(-1);
@@ -34,13 +35,7 @@ void write_sasplus(std::ostream & sout, const Domain & domain, const Problem & p
 		outputFactsSet.insert(fact);
 
 		sout << "begin_variable" << std::endl << "var" << factOut << std::endl << "-1" << std::endl << "2" << std::endl;
-		std::string factName = domain.predicates[fact.predicateNo].name + "[";
-		for (unsigned int i = 0; i < fact.arguments.size(); i++){
-			if (i) factName += ",";
-			factName += domain.constants[fact.arguments[i]];
-		}
-		factName += "]";
-
+		std::string_view factName = factNames.fact(fact);
 		sout << "Atom " << factName << std::endl;
 		sout << "NotAtom " << factName << std::endl;
 		sout << "end_variable" << std::endl;
@@ -97,17 +92,13 @@ void write_sasplus(std::ostream & sout, const Domain & domain, const Problem & p
 		init_functions_map[init_function_literal.first] = init_function_literal.second;
 	}
 	
+	NameTable taskNames (domain, reachableTasks.size());
 	for(size_t taskID = 0; taskID < reachableTasks.size(); taskID++) if (! prunedTasks[taskID] && reachableTasks[taskID].taskNo < domain.nPrimitiveTasks){
 		sout << "begin_operator" << std::endl;
 		GroundedTask & task = reachableTasks[taskID];
 
-		sout << domain.tasks[task.taskNo].name << "[";
 		// only output the original variables
-		for (unsigned int i = 0; i < domain.tasks[task.taskNo].number_of_original_variables; i++){
-			if (i) sout << ",";
-			sout << domain.constants[task.arguments[i]];
-		}
-		sout << "]" << std::endl;
+		sout << taskNames.task(task) << std::endl;
 
 		// determine the prevail  
 
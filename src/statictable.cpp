@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <cassert>
+
+#include "statictable.h"
+
+StaticTable::StaticTable (size_t width, int maximalValue) : rowWidth (width), maximalValue (maximalValue)
+{
+}
+
+void StaticTable::addRow (const int * row)
+{
+	rows.insert (rows.end (), row, row + rowWidth);
+}
+
+size_t StaticTable::width (void) const
+{
+	return rowWidth;
+}
+
+size_t StaticTable::size (void) const
+{
+	return rowWidth == 0 ? 0 : rows.size () / rowWidth;
+}
+
+const int * StaticTable::row (size_t rowIdx) const
+{
+	assert (rowIdx < size ());
+	return rows.data () + rowIdx * rowWidth;
+}
+
+int StaticTable::getOrAddIndex (const std::vector<int> & columns)
+{
+	auto columnsIt = std::find (indexColumns.begin (), indexColumns.end (), columns);
+	if (columnsIt != indexColumns.end ())
+		return columnsIt - indexColumns.begin ();
+
+	int indexNumber = indexColumns.size ();
+	indexColumns.push_back (columns);
+	indexes.emplace_back (columns.size (), maximalValue);
+
+	std::vector<int> key (columns.size ());
+	for (size_t rowIdx = 0; rowIdx < size (); rowIdx++)
+	{
+		for (size_t keyIdx = 0; keyIdx < columns.size (); keyIdx++)
+			key[keyIdx] = row (rowIdx)[columns[keyIdx]];
+		indexes[indexNumber].insert (key.data (), rowIdx);
+	}
+
+	return indexNumber;
+}
+
+std::span<const int> StaticTable::find (int indexNumber, const int * key) const
+{
+	return indexes[indexNumber].find (key);
+}
+
+size_t StaticTable::memoryUsage (void) const
+{
+	size_t bytes = sizeof (StaticTable) + rows.capacity () * sizeof (int);
+	for (const FlatFactIndex & index : indexes)
+		bytes += index.memoryUsage ();
+	return bytes;
+}
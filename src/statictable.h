@@ -0,0 +1,83 @@
+#ifndef STATICTABLE_H_INCLUDED
+#define STATICTABLE_H_INCLUDED
+
+/**
+ * @defgroup statictable Static Table
+ * @brief Rows of fixed width that can be looked up by the values of some of their columns.
+ *
+ * @{
+ */
+
+#include <span>
+#include <vector>
+
+#include "factindex.h"
+
+/**
+ * @brief A table of rows of width integers, with hash indexes on subsets of its leading columns.
+ *
+ * The GPG stores the joined static preconditions of an action in it. Every index maps the values of its key columns to the
+ * numbers of the rows having these values, in the order in which the rows were added. The key columns must contain constants,
+ * the other columns may contain arbitrary integers.
+ *
+ * find() does not modify the table and can be called concurrently.
+ */
+class StaticTable
+{
+public:
+	/**
+	 * @brief Creates an empty table with rows of width integers. All constants in key columns must be in [0; maximalValue].
+	 */
+	StaticTable (size_t width, int maximalValue);
+
+	/**
+	 * @brief Appends a row consisting of width values.
+	 */
+	void addRow (const int * row);
+
+	/**
+	 * @brief Returns the number of integers per row.
+	 */
+	size_t width (void) const;
+
+	/**
+	 * @brief Returns the number of rows.
+	 */
+	size_t size (void) const;
+
+	/**
+	 * @brief Returns the given row.
+	 */
+	const int * row (size_t rowIdx) const;
+
+	/**
+	 * @brief Returns the number of the index keyed by the given columns. If there is none, it is created from all rows added so far.
+	 *
+	 * Rows added later are not inserted into existing indexes, so all rows must be added first.
+	 */
+	int getOrAddIndex (const std::vector<int> & columns);
+
+	/**
+	 * @brief Returns the numbers of all rows whose key columns of the given index have the given values.
+	 */
+	std::span<const int> find (int indexNumber, const int * key) const;
+
+	/**
+	 * @brief Returns the number of bytes allocated by the table and its indexes.
+	 */
+	size_t memoryUsage (void) const;
+
+private:
+	size_t rowWidth;
+	int maximalValue;
+	std::vector<int> rows;
+	/// For every index, the columns whose values form its key
+	std::vector<std::vector<int>> indexColumns;
+	std::vector<FlatFactIndex> indexes;
+};
+
+/**
+ * @}
+ */
+
+#endif
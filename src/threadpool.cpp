@@ -0,0 +1,157 @@
+#include <cassert>
+
+#include "threadpool.h"
+
+ThreadPool::ThreadPool (size_t numberOfThreads) : slices (numberOfThreads > 0 ? numberOfThreads : 1)
+{
+	for (size_t workerIdx = 1; workerIdx < slices.size (); ++workerIdx)
+		threads.emplace_back (&ThreadPool::workerLoop, this, workerIdx);
+}
+
+ThreadPool::~ThreadPool ()
+{
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		shutdown = true;
+	}
+	wakeUp.notify_all ();
+
+	for (std::thread & thread : threads)
+		thread.join ();
+}
+
+size_t ThreadPool::size (void) const
+{
+	return slices.size ();
+}
+
+size_t ThreadPool::getNumberOfSteals (void) const
+{
+	return steals;
+}
+
+void ThreadPool::run (size_t numberOfJobs, const Job & job)
+{
+	if (numberOfJobs == 0)
+		return;
+
+	// without additional threads, we don't need any synchronisation
+	if (threads.empty ())
+	{
+		for (size_t jobIdx = 0; jobIdx < numberOfJobs; ++jobIdx)
+			job (jobIdx, 0);
+		return;
+	}
+
+	// initially, every worker gets an equally sized slice of the jobs. All workers are idle, so we don't need to lock.
+	for (size_t workerIdx = 0; workerIdx < slices.size (); ++workerIdx)
+	{
+		slices[workerIdx].begin = numberOfJobs * workerIdx / slices.size ();
+		slices[workerIdx].end = numberOfJobs * (workerIdx + 1) / slices.size ();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		currentJob = &job;
+		runningWorkers = threads.size ();
+		++generation;
+	}
+	wakeUp.notify_all ();
+
+	work (0);
+
+	std::unique_lock<std::mutex> lock (mutex);
+	finished.wait (lock, [&] { return runningWorkers == 0; });
+	currentJob = nullptr;
+}
+
+void ThreadPool::workerLoop (size_t workerIdx)
+{
+	size_t seenGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock (mutex);
+			wakeUp.wait (lock, [&] { return shutdown || generation != seenGeneration; });
+			if (shutdown)
+				return;
+			seenGeneration = generation;
+		}
+
+		work (workerIdx);
+
+		std::lock_guard<std::mutex> lock (mutex);
+		if (--runningWorkers == 0)
+			finished.notify_one ();
+	}
+}
+
+void ThreadPool::work (size_t workerIdx)
+{
+	size_t jobIdx;
+	while (true)
+	{
+		if (takeJob (workerIdx, jobIdx))
+			(*currentJob) (jobIdx, workerIdx);
+		else if (!steal (workerIdx))
+			return;
+	}
+}
+
+bool ThreadPool::takeJob (size_t workerIdx, size_t & jobIdx)
+{
+	Slice & slice = slices[workerIdx];
+	std::lock_guard<std::mutex> lock (slice.mutex);
+	if (slice.begin == slice.end)
+		return false;
+
+	jobIdx = slice.begin++;
+	return true;
+}
+
+bool ThreadPool::steal (size_t workerIdx)
+{
+	// the victim is the worker with the most remaining jobs
+	size_t victimIdx = workerIdx;
+	size_t victimRemaining = 0;
+	for (size_t otherIdx = 0; otherIdx < slices.size (); ++otherIdx)
+	{
+		if (otherIdx == workerIdx)
+			continue;
+
+		std::lock_guard<std::mutex> lock (slices[otherIdx].mutex);
+		size_t remaining = slices[otherIdx].end - slices[otherIdx].begin;
+		if (remaining > victimRemaining)
+		{
+			victimIdx = otherIdx;
+			victimRemaining = remaining;
+		}
+	}
+
+	if (victimIdx == workerIdx)
+		return false;
+
+	size_t stolenBegin;
+	size_t stolenEnd;
+	{
+		Slice & victim = slices[victimIdx];
+		std::lock_guard<std::mutex> lock (victim.mutex);
+		// the victim might have progressed in the meantime
+		if (victim.begin == victim.end)
+			return true;
+
+		stolenEnd = victim.end;
+		stolenBegin = victim.begin + (victim.end - victim.begin) / 2;
+		victim.end = stolenBegin;
+	}
+
+	// never hold two slice locks at once; the stolen jobs are owned by no one in between
+	Slice & own = slices[workerIdx];
+	std::lock_guard<std::mutex> lock (own.mutex);
+	assert (own.begin == own.end);
+	own.begin = stolenBegin;
+	own.end = stolenEnd;
+	++steals;
+
+	return true;
+}
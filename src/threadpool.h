@@ -0,0 +1,90 @@
+#ifndef THREADPOOL_H_INCLUDED
+#define THREADPOOL_H_INCLUDED
+
+/**
+ * @defgroup threadpool Thread Pool
+ * @brief A small work-stealing thread pool for batches of independent jobs.
+ *
+ * @{
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed set of worker threads that executes batches of independent jobs.
+ *
+ * Jobs are identified by their index in [0; numberOfJobs). Every worker starts with its own contiguous slice of the
+ * index range. Once its slice is exhausted, a worker steals the upper half of the largest remaining slice of another worker.
+ * The thread calling run() participates as worker 0, so a pool of size 1 does not start any threads at all.
+ */
+class ThreadPool
+{
+public:
+	/// Signature of a job. The second argument is the index of the executing worker in [0; size()).
+	using Job = std::function<void (size_t jobIdx, size_t workerIdx)>;
+
+	/**
+	 * @brief Starts numberOfThreads - 1 additional threads.
+	 */
+	explicit ThreadPool (size_t numberOfThreads);
+
+	~ThreadPool ();
+
+	ThreadPool (const ThreadPool &) = delete;
+	ThreadPool & operator= (const ThreadPool &) = delete;
+
+	/// Returns the number of workers, including the calling thread.
+	size_t size (void) const;
+
+	/**
+	 * @brief Executes job for every index in [0; numberOfJobs) and returns after all of them have finished.
+	 *
+	 * The order in which the jobs are executed is unspecified. Jobs must not call run() themselves.
+	 */
+	void run (size_t numberOfJobs, const Job & job);
+
+	/// Returns the number of successful steals since the pool was created.
+	size_t getNumberOfSteals (void) const;
+
+private:
+	/// The jobs [begin; end) that are still to be executed by one worker.
+	struct Slice
+	{
+		std::mutex mutex;
+		size_t begin = 0;
+		size_t end = 0;
+	};
+
+	void workerLoop (size_t workerIdx);
+
+	void work (size_t workerIdx);
+
+	bool takeJob (size_t workerIdx, size_t & jobIdx);
+
+	bool steal (size_t workerIdx);
+
+	std::vector<Slice> slices;
+	std::vector<std::thread> threads;
+
+	const Job * currentJob = nullptr;
+
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::condition_variable finished;
+	size_t generation = 0;
+	size_t runningWorkers = 0;
+	bool shutdown = false;
+
+	std::atomic<size_t> steals {0};
+};
+
+/**
+ * @}
+ */
+
+#endif
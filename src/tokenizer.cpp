@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tokenizer.h"
+
+InputTokenizer::~InputTokenizer ()
+{
+	if (mapping != nullptr)
+		munmap (mapping, mappingSize);
+}
+
+bool InputTokenizer::open (const std::string & filename)
+{
+	int fd = filename == "-" ? STDIN_FILENO : ::open (filename.c_str (), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat status;
+	if (fstat (fd, &status) == 0 && S_ISREG (status.st_mode) && status.st_size > 0)
+	{
+		mappingSize = status.st_size;
+		mapping = mmap (nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED)
+			mapping = nullptr;
+		else
+		{
+			madvise (mapping, mappingSize, MADV_SEQUENTIAL);
+			first = static_cast<const char *> (mapping);
+			last = first + mappingSize;
+		}
+	}
+
+	if (mapping == nullptr)
+	{
+		// pipes, empty files and anything else that cannot be mapped
+		const size_t blockSize = 1 << 20;
+		size_t size = 0;
+		while (true)
+		{
+			buffer.resize (size + blockSize);
+			ssize_t bytes = read (fd, buffer.data () + size, blockSize);
+			if (bytes < 0)
+			{
+				if (fd != STDIN_FILENO)
+					close (fd);
+				return false;
+			}
+			if (bytes == 0)
+				break;
+			size += bytes;
+		}
+		buffer.resize (size);
+		first = buffer.data ();
+		last = first + size;
+	}
+
+	if (fd != STDIN_FILENO)
+		close (fd);
+
+	position = first;
+	// a comment in the first line is not preceded by a line break
+	if (position != last && *position == '#')
+		skipLine ();
+	return true;
+}
+
+void InputTokenizer::skipLine (void)
+{
+	position = std::find (position, last, '\n');
+}
+
+void InputTokenizer::skipWhitespace (void)
+{
+	while (position != last && isWhitespace (*position))
+	{
+		if (*position++ == '\n' && position != last && *position == '#')
+			skipLine ();
+	}
+}
+
+std::string_view InputTokenizer::nextToken (void)
+{
+	skipWhitespace ();
+	if (position == last)
+		throw std::ios_base::failure ("expected a token");
+
+	const char * begin = position;
+	while (position != last && !isWhitespace (*position))
+		++position;
+	return std::string_view (begin, position - begin);
+}
+
+bool InputTokenizer::atEnd (void)
+{
+	skipWhitespace ();
+	return position == last;
+}
+
+size_t InputTokenizer::lineNumber (void) const
+{
+	return std::count (first, position, '\n') + 1;
+}
+
+std::string_view InputTokenizer::currentLine (void) const
+{
+	const char * begin = position;
+	while (begin != first && begin[-1] != '\n')
+		--begin;
+	const char * end = std::find (position, last, '\n');
+	return std::string_view (begin, end - begin);
+}
@@ -0,0 +1,131 @@
+#ifndef TOKENIZER_H_INCLUDED
+#define TOKENIZER_H_INCLUDED
+
+/**
+ * @defgroup tokenizer Input Tokenizer
+ * @brief Splits the input file into whitespace separated tokens without copying it.
+ *
+ * @{
+ */
+
+#include <charconv>
+#include <ios>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Reads the whitespace separated tokens of the input in place, as an alternative to a std::istream.
+ *
+ * Regular files are memory-mapped, everything else (e.g. standard input from a pipe) is read into a single buffer in large blocks.
+ * Lines starting with # are comments and skipped while reading. Integers are parsed with std::from_chars and strings are assigned
+ * directly from the buffer, so reading a token does not allocate anything by itself.
+ *
+ * The operators mirror those of a std::istream with failbit exceptions: if a token is missing or is not a number, a
+ * std::ios_base::failure is thrown and the position stays at the offending token.
+ */
+class InputTokenizer
+{
+public:
+	InputTokenizer (void) = default;
+
+	~InputTokenizer ();
+
+	InputTokenizer (const InputTokenizer &) = delete;
+	InputTokenizer & operator= (const InputTokenizer &) = delete;
+
+	/**
+	 * @brief Opens the given file, or standard input for "-". Returns false and leaves errno set if it cannot be read.
+	 */
+	bool open (const std::string & filename);
+
+	/**
+	 * @brief Returns the whole input, including comments.
+	 */
+	std::string_view contents (void) const
+	{
+		return std::string_view (first, last - first);
+	}
+
+	/**
+	 * @brief Returns the offset of the current position in the input, i.e. right after the last token read.
+	 */
+	size_t offset (void) const
+	{
+		return position - first;
+	}
+
+	/**
+	 * @brief Continues reading at the given offset, which must be at most the size of the input.
+	 */
+	void seek (size_t offset)
+	{
+		position = first + offset;
+	}
+
+	/**
+	 * @brief Returns the next token, or throws if there is none.
+	 */
+	std::string_view nextToken (void);
+
+	template <typename T>
+	std::enable_if_t<std::is_integral_v<T>, InputTokenizer &> operator>> (T & output)
+	{
+		skipWhitespace ();
+		auto [end, error] = std::from_chars (position, last, output);
+		if (error != std::errc () || (end != last && !isWhitespace (*end)))
+			throw std::ios_base::failure ("expected an integer");
+		position = end;
+		return *this;
+	}
+
+	InputTokenizer & operator>> (std::string & output)
+	{
+		output.assign (nextToken ());
+		return *this;
+	}
+
+	/**
+	 * @brief Returns whether only whitespace and comments are left.
+	 */
+	bool atEnd (void);
+
+	/**
+	 * @brief Returns the number of the line, starting from 1, at the current position.
+	 */
+	size_t lineNumber (void) const;
+
+	/**
+	 * @brief Returns the line at the current position.
+	 */
+	std::string_view currentLine (void) const;
+
+private:
+	const char * first = nullptr;
+	const char * last = nullptr;
+	const char * position = nullptr;
+
+	void * mapping = nullptr;
+	size_t mappingSize = 0;
+	/// The input if it is not memory-mapped
+	std::vector<char> buffer;
+
+	static bool isWhitespace (char c)
+	{
+		return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	/**
+	 * @brief Skips whitespace and comment lines.
+	 */
+	void skipWhitespace (void);
+
+	void skipLine (void);
+};
+
+/**
+ * @}
+ */
+
+#endif
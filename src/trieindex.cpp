@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+#include "trieindex.h"
+
+void TrieIndex::insert (const std::vector<int> & tuple)
+{
+	assert (tuples.empty () || tuples.begin ()->size () == tuple.size ());
+	tuples.insert (tuple);
+}
+
+size_t TrieIndex::size (void) const
+{
+	return tuples.size ();
+}
+
+size_t TrieIndex::memoryUsage (void) const
+{
+	// assume three pointers and a colour per tree node
+	const size_t nodeOverhead = 4 * sizeof (void *);
+	size_t bytes = sizeof (TrieIndex);
+	if (!tuples.empty ())
+		bytes += tuples.size () * (nodeOverhead + sizeof (std::vector<int>) + tuples.begin ()->size () * sizeof (int));
+	return bytes;
+}
+
+TrieIterator::TrieIterator (const TrieIndex & index) : tuples (index.tuples), current (index.tuples.begin ()), end (index.tuples.empty ())
+{
+}
+
+int TrieIterator::depth (void) const
+{
+	return int (stack.size ()) - 1;
+}
+
+bool TrieIterator::atEnd (void) const
+{
+	return end;
+}
+
+int TrieIterator::key (void) const
+{
+	assert (depth () >= 0 && !end);
+	return (*current)[prefix.size ()];
+}
+
+const std::vector<int> & TrieIterator::tuple (void) const
+{
+	assert (!end);
+	return *current;
+}
+
+void TrieIterator::findFirst (int value)
+{
+	probe.assign (prefix.begin (), prefix.end ());
+	probe.push_back (value);
+	current = tuples.lower_bound (probe);
+	end = current == tuples.end () || !std::equal (prefix.begin (), prefix.end (), current->begin ());
+}
+
+void TrieIterator::next (void)
+{
+	if (key () == INT_MAX)
+		end = true;
+	else
+		findFirst (key () + 1);
+}
+
+void TrieIterator::seek (int value)
+{
+	if (!end && key () < value)
+		findFirst (value);
+}
+
+void TrieIterator::open (void)
+{
+	assert (!end);
+	if (depth () >= 0)
+		prefix.push_back (key ());
+	// the current tuple is the first one with the new prefix
+	stack.push_back (current);
+}
+
+void TrieIterator::up (void)
+{
+	assert (depth () >= 0);
+	current = stack.back ();
+	stack.pop_back ();
+	if (depth () >= 0)
+		prefix.pop_back ();
+	end = false;
+}
@@ -0,0 +1,117 @@
+#ifndef TRIEINDEX_H_INCLUDED
+#define TRIEINDEX_H_INCLUDED
+
+/**
+ * @defgroup trieindex Trie Index
+ * @brief Sorted tuples of constants that can be traversed as a trie, as needed by leapfrog triejoin.
+ *
+ * @{
+ */
+
+#include <set>
+#include <vector>
+
+/**
+ * @brief A set of tuples of the same width, sorted lexicographically.
+ *
+ * Level d of the trie consists of the d-th values of all tuples that share the values of the levels above. Tuples can be inserted
+ * at any time, but not while a TrieIterator is used.
+ */
+class TrieIndex
+{
+public:
+	/**
+	 * @brief Inserts the given tuple. Inserting a tuple that is already contained does nothing.
+	 */
+	void insert (const std::vector<int> & tuple);
+
+	/**
+	 * @brief Returns the number of tuples in the index.
+	 */
+	size_t size (void) const;
+
+	/**
+	 * @brief Returns an estimate of the number of bytes allocated by the index.
+	 */
+	size_t memoryUsage (void) const;
+
+private:
+	friend class TrieIterator;
+
+	std::set<std::vector<int>> tuples;
+};
+
+/**
+ * @brief Traverses a TrieIndex level by level.
+ *
+ * The iterator starts at the root, above level 0. open() descends to the first key of the next level below the current key,
+ * up() returns to the key it was opened from. Within a level, next() and seek() only move forward. All operations take
+ * logarithmic time in the size of the index.
+ *
+ * Several iterators may traverse the same index concurrently.
+ */
+class TrieIterator
+{
+public:
+	explicit TrieIterator (const TrieIndex & index);
+
+	/**
+	 * @brief Returns the current level, -1 at the root.
+	 */
+	int depth (void) const;
+
+	/**
+	 * @brief Returns whether there is no further key in the current level.
+	 */
+	bool atEnd (void) const;
+
+	/**
+	 * @brief Returns the current key. Must not be called at the root or at the end.
+	 */
+	int key (void) const;
+
+	/**
+	 * @brief Returns the first tuple that starts with the keys of all levels down to the current one. Must not be called at the end.
+	 */
+	const std::vector<int> & tuple (void) const;
+
+	/**
+	 * @brief Moves to the next key in the current level.
+	 */
+	void next (void);
+
+	/**
+	 * @brief Moves to the first key in the current level that is not smaller than value. Does nothing if the current key is not smaller already.
+	 */
+	void seek (int value);
+
+	/**
+	 * @brief Descends to the first key below the current one. Must not be called at the end.
+	 */
+	void open (void);
+
+	/**
+	 * @brief Returns to the key of the level above from which the current level was opened.
+	 */
+	void up (void);
+
+private:
+	void findFirst (int value);
+
+	const std::set<std::vector<int>> & tuples;
+
+	/// The keys of all levels above the current one
+	std::vector<int> prefix;
+	/// The positions of the levels above the current one, restored by up()
+	std::vector<std::set<std::vector<int>>::const_iterator> stack;
+	std::set<std::vector<int>>::const_iterator current;
+	bool end;
+	/// Reused as the argument of lower_bound
+	std::vector<int> probe;
+};
+
+/**
+ * @}
+ */
+
+#endif